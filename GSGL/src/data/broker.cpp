@@ -51,6 +51,12 @@ namespace gsgl
     namespace data
     {
 
+        /// Virtual, so that an object the broker created can be deleted when it turns out not to be of the type wanted.
+        brokered_object::~brokered_object()
+        {
+        } // brokered_object::~brokered_object()
+
+
         const gsgl::string & brokered_object::get_type_name() const
         {
             if (type_name.is_empty())
@@ -50,6 +50,8 @@ namespace gsgl
             mutable gsgl::string type_name;
             friend class broker;
         public:
+            virtual ~brokered_object();
+
             virtual const gsgl::string & get_type_name() const;
         }; // class brokered_object
 
@@ -59,8 +59,8 @@ namespace gsgl
         /// A dictionary or map.
         /// Type T can be any type; type I must implement '<', '>' and '=='.
         ///
-        /// Currently implemented by means of a simple unbalanced binary tree.
-        /// \todo Improve implementation.
+        /// Implemented by means of an AVL tree, so lookups, insertions and removals are O(log n)
+        /// regardless of the order in which indices are inserted.  Iteration is in index order.
         template <typename T, typename I>
         class dictionary
             : public data_object, 
@@ -77,9 +77,10 @@ namespace gsgl
                 
                 dict_node *left;
                 dict_node *right;
-                
+                int height;
+
 				dict_node();
-                dict_node(const T & item, const I & index, dict_node *left = 0, dict_node *right = 0);
+                dict_node(const T & item, const I & index, dict_node *left = 0, dict_node *right = 0, int height = 1);
 				dict_node(const dict_node &);
 				dict_node & operator= (const dict_node &);
                 virtual ~dict_node();
@@ -134,10 +135,16 @@ namespace gsgl
         private:
             T & get_item(const I & index, bool create_new = true);
 
-            dict_node *find_node(const I & index, dict_node ***link);
-            void remove_node(dict_node *cur, dict_node **link);            
+            dict_node *find_node(const I & index) const;
+            dict_node *insert_node(dict_node *cur, const I & index, dict_node **result);
+            dict_node *remove_node(dict_node *cur, const I & index, bool & removed);
+            dict_node *detach_max(dict_node *cur, dict_node **max_node);
 
-			void deallocate_nodes(dict_node *cur);
+            static int height_of(const dict_node *cur) { return cur ? cur->height : 0; }
+            static void update_height(dict_node *cur);
+            static dict_node *rotate_left(dict_node *cur);
+            static dict_node *rotate_right(dict_node *cur);
+            static dict_node *rebalance(dict_node *cur);
         }; // class dict
         
 
@@ -145,22 +152,22 @@ namespace gsgl
         
 		template <typename T, typename I>
 		dictionary<T,I>::dict_node::dict_node()
-			: left(0), right(0)
+			: left(0), right(0), height(0)
 		{
 			throw internal_exception(__FILE__, __LINE__, L"Internal dictionary nodes should never use the default constructor.");
 		} // dictionary<T,I>::dict_node::dict_node()
 
 
         template <typename T, typename I>
-        dictionary<T,I>::dict_node::dict_node(const T & item, const I & index, dict_node *left, dict_node *right)
-            : item(item), index(index), left(left), right(right)
+        dictionary<T,I>::dict_node::dict_node(const T & item, const I & index, dict_node *left, dict_node *right, int height)
+            : item(item), index(index), left(left), right(right), height(height)
         {
         } // dictionary<T,I>::dict_node::dict_node()
 
 
 		template <typename T, typename I>
 		dictionary<T,I>::dict_node::dict_node(const dict_node & dn)
-			: item(dn.item), index(dn.index), left(dn.left), right(dn.right)
+			: item(dn.item), index(dn.index), left(dn.left), right(dn.right), height(dn.height)
 		{
 			throw internal_exception(__FILE__, __LINE__, L"Internal dictionary nodes should never be copy constructed.");
 		} // dictionary<T,I>::dict_node::dict_node()
@@ -190,7 +197,7 @@ namespace gsgl
         template <typename T, typename I>
         typename dictionary<T,I>::dict_node *dictionary<T,I>::dict_node::copy(pool<dict_node> & p) const
         {
-            return new (p.allocate_inplace()) dict_node(item, index, left ? left->copy(p) : 0, right ? right->copy(p) : 0);
+            return new (p.allocate_inplace()) dict_node(item, index, left ? left->copy(p) : 0, right ? right->copy(p) : 0, height);
         } // dictionary<T,I>::dict_node::copy()
         
 
@@ -253,8 +260,7 @@ namespace gsgl
         template <typename T, typename I> 
         void dictionary<T,I>::clear()
         {
-			if (root)
-				deallocate_nodes(root);
+            node_pool.reset();
             root = 0;
             count = 0;
         } // dictionary<T,I>::clear()
@@ -286,21 +292,12 @@ namespace gsgl
         template <typename T, typename I>
         void dictionary<T,I>::remove(const I & index)
         {
-            if (root)
-            {
-                dict_node *cur, **link = &root;
-                cur = find_node(index, &link);
-
-                // delete node
-                if (cur)
-                {
-                    remove_node(cur, link);
-                    return;
-                }
-            }
+            bool removed = false;
+            root = remove_node(root, index, removed);
 
             // we never found a node to remove
-            throw runtime_exception(L"Attempted to remove an invalid item from a dictionary.");
+            if (!removed)
+                throw runtime_exception(L"Attempted to remove an invalid item from a dictionary.");
         } // dictionary<T,I>::remove()
                 
 
@@ -309,10 +306,7 @@ namespace gsgl
         template <typename T, typename I>
         bool dictionary<T,I>::contains_index(const I & index) const
         {
-            dict_node *cur, **link = &root;
-            cur = const_cast<dictionary<T,I> *>(this)->find_node(index, &link);
-
-            return cur != 0;
+            return find_node(index) != 0;
         } // dictionary<T,I>::contains_index()
 
 
@@ -335,14 +329,13 @@ namespace gsgl
         template <typename T, typename I>
         T & dictionary<T,I>::get_item(const I & index, bool create_new)
         {
-            dict_node *cur, **link = &root;
-            cur = find_node(index, &link);
+            dict_node *cur = find_node(index);
             
             if (!cur)
             {
                 if (create_new)
                 {
-                    *link = cur = new (node_pool.allocate_inplace()) dict_node(T(), index);
+                    root = insert_node(root, index, &cur);
                     ++count;
                 }
                 else
@@ -357,91 +350,163 @@ namespace gsgl
         
 
         template <typename T, typename I>
-        typename dictionary<T,I>::dict_node *dictionary<T,I>::find_node(const I & index, dict_node ***link)
+        typename dictionary<T,I>::dict_node *dictionary<T,I>::find_node(const I & index) const
         {
-            dict_node *cur = **link;
+            dict_node *cur = root;
 
             while (cur)
             {
                 if (index < cur->index)
-                {
-                    *link = &cur->left;
                     cur = cur->left;
-                }
                 else if (index == cur->index)
-                {
                     break;
-                }
                 else
-                {
-                    *link = &cur->right;
                     cur = cur->right;
-                }
             }
 
             return cur;
         } // dictionary<T,I>::find_node()
 
 
+        /// Inserts a new node for the index into the subtree rooted at cur, which must not already contain it.
+        /// \return The new root of the subtree.
         template <typename T, typename I>
-        void dictionary<T,I>::remove_node(dict_node *cur, dict_node **link)
+        typename dictionary<T,I>::dict_node *dictionary<T,I>::insert_node(dict_node *cur, const I & index, dict_node **result)
         {
-            assert(cur);
-            assert(link);
+            if (!cur)
+                return *result = new (node_pool.allocate_inplace()) dict_node(T(), index);
 
-            if (cur->left && cur->right)
-            {
-                // get predecessor
-                dict_node **pred_link = &cur->left, *pred = cur->left;
-                while (pred->right)
-                {
-                    pred_link = &pred;
-                    pred = pred->right;
-                }
+            if (index < cur->index)
+                cur->left = insert_node(cur->left, index, result);
+            else
+                cur->right = insert_node(cur->right, index, result);
+
+            return rebalance(cur);
+        } // dictionary<T,I>::insert_node()
 
-                // copy data from predecessor to cur
-                cur->index = pred->index;
-                cur->item = pred->item;
 
-                // delete pred
-                remove_node(pred, pred_link);
+        /// Removes the node with the given index from the subtree rooted at cur.
+        /// \return The new root of the subtree.
+        template <typename T, typename I>
+        typename dictionary<T,I>::dict_node *dictionary<T,I>::remove_node(dict_node *cur, const I & index, bool & removed)
+        {
+            if (!cur)
+                return 0;
+
+            if (index < cur->index)
+            {
+                cur->left = remove_node(cur->left, index, removed);
             }
-            else 
+            else if (index == cur->index)
             {
-                if (cur->left)
-                {
-                    *link = cur->left;
-                }
-                else if (cur->right)
+                dict_node *replacement;
+
+                if (cur->left && cur->right)
                 {
-                    *link = cur->right;
+                    // splice the predecessor into this node's place, so we don't have to copy items around
+                    dict_node *pred;
+                    dict_node *left = detach_max(cur->left, &pred);
+
+                    pred->left = left;
+                    pred->right = cur->right;
+                    replacement = rebalance(pred);
                 }
                 else
                 {
-                    *link = 0;
+                    replacement = cur->left ? cur->left : cur->right;
                 }
 
                 cur->left = cur->right = 0;
-				node_pool.deallocate(cur);
-                //delete cur;
-
+                node_pool.deallocate(cur);
                 --count;
+
+                removed = true;
+                return replacement;
             }
+            else
+            {
+                cur->right = remove_node(cur->right, index, removed);
+            }
+
+            return removed ? rebalance(cur) : cur;
         } // dictionary<T,I>::remove_node()
 
 
-		template <typename T, typename I>
-		void dictionary<T,I>::deallocate_nodes(dict_node *cur)
-		{
-			assert(cur);
+        /// Unlinks the node with the largest index from the subtree rooted at cur.
+        /// \return The new root of the subtree.
+        template <typename T, typename I>
+        typename dictionary<T,I>::dict_node *dictionary<T,I>::detach_max(dict_node *cur, dict_node **max_node)
+        {
+            assert(cur);
+
+            if (!cur->right)
+            {
+                *max_node = cur;
+                return cur->left;
+            }
+
+            cur->right = detach_max(cur->right, max_node);
+            return rebalance(cur);
+        } // dictionary<T,I>::detach_max()
+
+
+        template <typename T, typename I>
+        void dictionary<T,I>::update_height(dict_node *cur)
+        {
+            cur->height = gsgl::max_val(height_of(cur->left), height_of(cur->right)) + 1;
+        } // dictionary<T,I>::update_height()
+
 
-			if (cur->left)
-				deallocate_nodes(cur->left);
-			if (cur->right)
-				deallocate_nodes(cur->right);
+        template <typename T, typename I>
+        typename dictionary<T,I>::dict_node *dictionary<T,I>::rotate_left(dict_node *cur)
+        {
+            dict_node *pivot = cur->right;
+            cur->right = pivot->left;
+            pivot->left = cur;
 
-			node_pool.deallocate(cur);
-		} // dictionary<T,I>::deallocate_nodes()
+            update_height(cur);
+            update_height(pivot);
+            return pivot;
+        } // dictionary<T,I>::rotate_left()
+
+
+        template <typename T, typename I>
+        typename dictionary<T,I>::dict_node *dictionary<T,I>::rotate_right(dict_node *cur)
+        {
+            dict_node *pivot = cur->left;
+            cur->left = pivot->right;
+            pivot->right = cur;
+
+            update_height(cur);
+            update_height(pivot);
+            return pivot;
+        } // dictionary<T,I>::rotate_right()
+
+
+        /// Restores the AVL property at cur, assuming its subtrees are balanced and differ in height by at most two.
+        /// \return The new root of the subtree.
+        template <typename T, typename I>
+        typename dictionary<T,I>::dict_node *dictionary<T,I>::rebalance(dict_node *cur)
+        {
+            update_height(cur);
+
+            int balance = height_of(cur->left) - height_of(cur->right);
+
+            if (balance > 1)
+            {
+                if (height_of(cur->left->left) < height_of(cur->left->right))
+                    cur->left = rotate_left(cur->left);
+                return rotate_right(cur);
+            }
+            else if (balance < -1)
+            {
+                if (height_of(cur->right->right) < height_of(cur->right->left))
+                    cur->right = rotate_right(cur->right);
+                return rotate_left(cur);
+            }
+
+            return cur;
+        } // dictionary<T,I>::rebalance()
 
 
 		//////////////////////////////////////////
@@ -452,26 +517,25 @@ namespace gsgl
         {
 			const dictionary<T,I> & parent;
 
-			typename dictionary<T,I>::dict_node *cur, *prev;
+			typename dictionary<T,I>::dict_node *cur;
 			data::simple_stack<typename dictionary<T,I>::dict_node *> nodes_seen;
 
 		protected:
 			dictionary_iterator(const iterable<T, dictionary_iterator> & parent_iterable)
 				: parent(dynamic_cast<const dictionary<T,I> &>(parent_iterable)),
-				  cur(0), prev(0)
+				  cur(0)
 			{
 				for (cur = const_cast<typename dictionary<T,I>::dict_node *>(parent.root); cur && cur->left; cur = cur->left)
 					nodes_seen.push(cur);
 			}
 
             dictionary_iterator(const dictionary_iterator & di)
-				: parent(di.parent), cur(di.cur), prev(di.prev), nodes_seen(di.nodes_seen) {}
+				: parent(di.parent), cur(di.cur), nodes_seen(di.nodes_seen) {}
 
             dictionary_iterator & operator= (const dictionary_iterator & di)
 			{
 				parent = di.parent;
 				cur = di.cur;
-				prev = di.prev;
 				nodes_seen = di.nodes_seen;
 				return *this;
 			}
@@ -504,33 +568,16 @@ namespace gsgl
 		{
 			if (cur)
 			{
-				if (cur->right && cur->right != prev)
+				// nodes_seen holds the ancestors whose left subtrees we are in, i.e. the nodes still to be visited
+				if (cur->right)
 				{
-					prev = cur;
-					nodes_seen.push(cur);
-					cur = cur->right;
-
-					while (cur->left)
-					{
+					for (cur = cur->right; cur->left; cur = cur->left)
 						nodes_seen.push(cur);
-						cur = cur->left;
-					}
 				}
 				else if (nodes_seen.size())
 				{
-					prev = cur;
 					cur = nodes_seen.top();
 					nodes_seen.pop();
-
-					while (nodes_seen.size() && prev == cur->right)
-					{
-						prev = cur;
-						cur = nodes_seen.top();
-						nodes_seen.pop();
-					}
-
-					if (prev == cur->right)
-						cur = 0;
 				}
 				else
 				{
@@ -51,16 +51,18 @@ namespace gsgl
     namespace io
     {
 
+        static const gsgl::index_t READ_BUFFER_SIZE = 64 * 1024;
+
         //
 
         file_stream::file_stream(void *fp, gsgl::flags_t mode)
-            : data_object(), fname(L"???"), fp(fp), mode(mode)
+            : data_object(), fname(L"???"), fp(fp), mode(mode), read_buf(0), read_pos(0), read_len(0), read_eof(false)
         {
         } // file_stream::file_stream()
 
 
         file_stream::file_stream(const string & fname, gsgl::flags_t mode)
-            : data_object(), fname(fname), fp(0), mode(mode)
+            : data_object(), fname(fname), fp(0), mode(mode), read_buf(0), read_pos(0), read_len(0), read_eof(false)
         {
             string mode_string;
 
@@ -113,16 +115,89 @@ namespace gsgl
 
         file_stream::~file_stream()
         {
+            delete [] read_buf;
+
             if (fp)
                 ::fclose(static_cast<FILE *>(fp));
         } // file_stream::~file_stream()
 
 
+        /// Like feof(), this only becomes true after a read has failed for lack of data.
         bool file_stream::at_end() const
         {
-            return ::feof(static_cast<FILE *>(fp)) != 0;
+            return read_eof;
         } // file_stream::at_end()
 
+
+        /// Tries to make sure there are at least num unread bytes in the buffer (num must be much smaller than the buffer).
+        /// \return True if there are enough bytes in the buffer.
+        bool file_stream::ensure_buffered(const gsgl::index_t num)
+        {
+            gsgl::index_t remaining = read_len - read_pos;
+
+            if (remaining < num)
+            {
+                if (!read_buf)
+                    read_buf = new unsigned char[READ_BUFFER_SIZE];
+
+                if (remaining && read_pos)
+                    ::memmove(read_buf, read_buf + read_pos, remaining);
+
+                read_pos = 0;
+                read_len = remaining + static_cast<gsgl::index_t>(::fread(read_buf + remaining, 1, READ_BUFFER_SIZE - remaining, static_cast<FILE *>(fp)));
+                remaining = read_len;
+            }
+
+            return remaining >= num;
+        } // file_stream::ensure_buffered()
+
+
+        gsgl::index_t file_stream::read_bytes(unsigned char *ptr, const gsgl::index_t num)
+        {
+            gsgl::index_t total = gsgl::min_val(read_len - read_pos, num);
+
+            if (total)
+            {
+                ::memcpy(ptr, read_buf + read_pos, total);
+                read_pos += total;
+            }
+
+            if (total < num)
+            {
+                gsgl::index_t wanted = num - total;
+
+                if (wanted >= READ_BUFFER_SIZE / 2)
+                {
+                    // big reads go straight into the caller's memory
+                    total += static_cast<gsgl::index_t>(::fread(ptr + total, 1, wanted, static_cast<FILE *>(fp)));
+                }
+                else
+                {
+                    ensure_buffered(wanted);
+
+                    gsgl::index_t available = gsgl::min_val(read_len - read_pos, wanted);
+                    ::memcpy(ptr + total, read_buf + read_pos, available);
+                    read_pos += available;
+                    total += available;
+                }
+
+                if (total < num)
+                    read_eof = true;
+            }
+
+            return total;
+        } // file_stream::read_bytes()
+
+
+        /// Gives back any read-ahead data to the file, so that the file position is where the reader thinks it is.  Must be called before writing.
+        void file_stream::discard_buffer()
+        {
+            if (read_pos < read_len)
+                ::fseek(static_cast<FILE *>(fp), static_cast<long>(read_pos - read_len), SEEK_CUR);
+
+            read_pos = read_len = 0;
+        } // file_stream::discard_buffer()
+
         //
 
         ft_stream ft_stream::out(stdout, FILE_OPEN_WRITE | FILE_OPEN_APPEND | FILE_OPEN_TEXT);
@@ -133,13 +208,13 @@ namespace gsgl
         //
 
         ft_stream::ft_stream(void *fp, gsgl::flags_t mode) 
-            : file_stream(fp, mode | FILE_OPEN_TEXT), text_stream()
+            : file_stream(fp, mode | FILE_OPEN_TEXT), text_stream(), num_pushback(0)
         {
         } // ft_stream::ft_stream()
 
 
         ft_stream::ft_stream(const string & fname, gsgl::flags_t mode) 
-            : file_stream(fname, mode | FILE_OPEN_TEXT), text_stream()
+            : file_stream(fname, mode | FILE_OPEN_TEXT), text_stream(), num_pushback(0)
         {
         } // ft_stream::ft_stream()
 
@@ -151,9 +226,10 @@ namespace gsgl
         {
             if (mode & FILE_OPEN_READ)
             {
-                wchar_t ch = ::fgetwc(static_cast<FILE *>(fp));
-                ::ungetwc(ch, static_cast<FILE *>(fp));
-                return ch;
+                if (num_pushback)
+                    return pushback[num_pushback-1];
+                else
+                    return decode_char(false);
             }
             else
             {
@@ -165,8 +241,10 @@ namespace gsgl
         {
             if (mode & FILE_OPEN_READ)
             {
-                wchar_t ch = ::fgetwc(static_cast<FILE *>(fp));
-                return ch;
+                if (num_pushback)
+                    return pushback[--num_pushback];
+                else
+                    return decode_char(true);
             }
             else
             {
@@ -178,7 +256,14 @@ namespace gsgl
         {
             if (mode & FILE_OPEN_READ)
             {
-                ::ungetwc(ch, static_cast<FILE *>(fp));
+                if (ch == WEOF)
+                    return;
+
+                if (num_pushback == MAX_PUSHBACK)
+                    throw io_exception(L"too many characters pushed back onto %ls", fname.w_string());
+
+                pushback[num_pushback++] = ch;
+                read_eof = false;
             }
             else
             {
@@ -195,12 +280,19 @@ namespace gsgl
         {
             if (mode & FILE_OPEN_READ)
             {
-                /// \todo Implement UTF-8 for file streams.
-                data::smart_pointer<char, true> cbuf(new char[num+1]);
-                int num_read = (gsgl::index_t) ::fread(cbuf, 1, num, static_cast<FILE *>(fp));
-                for (int i = 0; i < num_read; ++i)
-                    buf[i] = cbuf[i];
-                return num_read;
+                gsgl::index_t i;
+
+                for (i = 0; i < num; ++i)
+                {
+                    wchar_t ch = num_pushback ? pushback[--num_pushback] : decode_char(true);
+
+                    if (ch == WEOF)
+                        break;
+
+                    buf[i] = ch;
+                }
+
+                return i;
             }
             else
             {
@@ -208,16 +300,110 @@ namespace gsgl
             }
         } // ft_stream::read()
 
+        gsgl::index_t ft_stream::read_line(wchar_t *buf, const gsgl::index_t num, bool & eol)
+        {
+            if (!(mode & FILE_OPEN_READ))
+                throw io_exception(L"cannot read from a write-only file");
+
+            gsgl::index_t pos = 0;
+            eol = false;
+
+            while (pos < num)
+            {
+                // copy runs of plain ASCII straight out of the buffer
+                if (!num_pushback && read_pos < read_len)
+                {
+                    const unsigned char *src = read_buf + read_pos;
+                    const unsigned char *end = src + gsgl::min_val(read_len - read_pos, num - pos);
+
+                    while (src < end && *src < 0x80 && *src != '\n' && *src != '\r')
+                        buf[pos++] = *src++;
+
+                    read_pos = static_cast<gsgl::index_t>(src - read_buf);
+
+                    if (pos == num)
+                        break;
+                    else if (src == end)
+                        continue; // ran off the end of the buffer
+                }
+
+                // line endings, multi-byte characters, pushed-back characters and buffer refills
+                wchar_t ch = num_pushback ? pushback[--num_pushback] : decode_char(true);
+
+                if (ch == WEOF)
+                    break;
+
+                if (ch == L'\r')
+                {
+                    if (peek() == L'\n')
+                        get();
+                    eol = true;
+                    break;
+                }
+                else if (ch == L'\n')
+                {
+                    eol = true;
+                    break;
+                }
+
+                buf[pos++] = ch;
+            }
+
+            return pos;
+        } // ft_stream::read_line()
+
         gsgl::index_t ft_stream::write(const wchar_t *buf, const gsgl::index_t num)
         {
             if (mode & FILE_OPEN_WRITE)
             {
-                /// \todo Implement UTF-8 for file streams.
-                data::smart_pointer<char, true> cbuf (new char[num+1]);
-                for (int i = 0; i < num; ++i)
-                    cbuf[i] = (char) buf[i];
+                if (read_buf)
+                    discard_buffer();
+                num_pushback = 0;
+
+                // encode as UTF-8 in chunks, so we don't need to allocate anything
+                unsigned char cbuf[1024];
+                gsgl::index_t clen = 0, num_written = 0;
+
+                for (gsgl::index_t i = 0; i < num; ++i)
+                {
+                    unsigned long ch = static_cast<unsigned long>(buf[i]);
+
+                    if (clen > static_cast<gsgl::index_t>(sizeof(cbuf)) - 4)
+                    {
+                        ::fwrite(cbuf, 1, clen, static_cast<FILE *>(fp));
+                        clen = 0;
+                    }
+
+                    if (ch < 0x80)
+                    {
+                        cbuf[clen++] = static_cast<unsigned char>(ch);
+                    }
+                    else if (ch < 0x800)
+                    {
+                        cbuf[clen++] = static_cast<unsigned char>(0xc0 | (ch >> 6));
+                        cbuf[clen++] = static_cast<unsigned char>(0x80 | (ch & 0x3f));
+                    }
+                    else if (ch < 0x10000)
+                    {
+                        cbuf[clen++] = static_cast<unsigned char>(0xe0 | (ch >> 12));
+                        cbuf[clen++] = static_cast<unsigned char>(0x80 | ((ch >> 6) & 0x3f));
+                        cbuf[clen++] = static_cast<unsigned char>(0x80 | (ch & 0x3f));
+                    }
+                    else
+                    {
+                        cbuf[clen++] = static_cast<unsigned char>(0xf0 | ((ch >> 18) & 0x07));
+                        cbuf[clen++] = static_cast<unsigned char>(0x80 | ((ch >> 12) & 0x3f));
+                        cbuf[clen++] = static_cast<unsigned char>(0x80 | ((ch >> 6) & 0x3f));
+                        cbuf[clen++] = static_cast<unsigned char>(0x80 | (ch & 0x3f));
+                    }
+
+                    ++num_written;
+                }
+
+                if (clen)
+                    ::fwrite(cbuf, 1, clen, static_cast<FILE *>(fp));
 
-                return (gsgl::index_t) ::fwrite(cbuf, 1, num, static_cast<FILE *>(fp));
+                return num_written;
             }
             else
             {
@@ -226,6 +412,61 @@ namespace gsgl
         } // ft_stream::write()
 
 
+        /// Decodes the next character from the read buffer, refilling it as necessary.
+        /// \return The character, or WEOF at the end of the file.
+        wchar_t ft_stream::decode_char(bool consume)
+        {
+            if (!ensure_buffered(1))
+            {
+                read_eof = true;
+                return WEOF;
+            }
+
+            unsigned char lead = read_buf[read_pos];
+
+            if (lead < 0x80)
+            {
+                if (consume)
+                    ++read_pos;
+                return static_cast<wchar_t>(lead);
+            }
+
+            gsgl::index_t len = lead >= 0xf0 ? 4 : lead >= 0xe0 ? 3 : lead >= 0xc0 ? 2 : 1;
+            unsigned long ch = lead;
+
+            if (len > 1 && ensure_buffered(len))
+            {
+                const unsigned char *src = read_buf + read_pos;
+
+                ch = lead & (0x3f >> (len - 1));
+                for (gsgl::index_t i = 1; i < len; ++i)
+                {
+                    if ((src[i] & 0xc0) != 0x80)
+                    {
+                        // not UTF-8 after all
+                        ch = lead;
+                        len = 1;
+                        break;
+                    }
+
+                    ch = (ch << 6) | (src[i] & 0x3f);
+                }
+
+                if (sizeof(wchar_t) < 4 && ch > 0xffff)
+                    ch = 0xfffd;
+            }
+            else
+            {
+                len = 1;
+            }
+
+            if (consume)
+                read_pos += len;
+
+            return static_cast<wchar_t>(ch);
+        } // ft_stream::decode_char()
+
+
         //
 
 
@@ -247,12 +488,15 @@ namespace gsgl
 
         gsgl::index_t fd_stream::read(unsigned char *ptr, gsgl::index_t num)
         {
-            return static_cast<gsgl::index_t>(::fread(ptr, 1, num, static_cast<FILE *>(fp)));
+            return read_bytes(ptr, num);
         } // fd_stream::read()
 
 
         gsgl::index_t fd_stream::write(const unsigned char * ptr, gsgl::index_t num)
         {
+            if (read_buf)
+                discard_buffer();
+
             return static_cast<gsgl::index_t>(::fwrite(ptr, 1, num, static_cast<FILE *>(fp)));
         } // fd_stream::write()
 
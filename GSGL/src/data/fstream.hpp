@@ -58,6 +58,7 @@ namespace gsgl
 
 
         /// Base class for streams on a file.
+        /// Reads go through a large buffer owned by the stream, so that reading a few bytes or characters at a time doesn't cost a library call each time.
         class DATA_API file_stream
             : public data_object
         {
@@ -67,10 +68,19 @@ namespace gsgl
             void *fp;
             int mode;
 
+            unsigned char *read_buf; ///< Allocated on the first read.
+            gsgl::index_t read_pos;  ///< The position of the next unread byte in the buffer.
+            gsgl::index_t read_len;  ///< The number of valid bytes in the buffer.
+            bool read_eof;           ///< Set when a read has tried to go past the end of the file.
+
             file_stream(void *fp, gsgl::flags_t mode);
 
             bool at_end() const;
 
+            bool ensure_buffered(const gsgl::index_t num);
+            gsgl::index_t read_bytes(unsigned char *, const gsgl::index_t num);
+            void discard_buffer();
+
         public:
             file_stream(const gsgl::string & fname, gsgl::flags_t mode = FILE_OPEN_READ);
             virtual ~file_stream();
@@ -80,9 +90,15 @@ namespace gsgl
 
             
         /// A text stream on a file.
+        /// Text is read and written as UTF-8; bytes that are not valid UTF-8 are read as Latin-1.
         class DATA_API ft_stream
             : public file_stream, public text_stream
         {
+            enum { MAX_PUSHBACK = 4 };
+
+            wchar_t pushback[MAX_PUSHBACK];
+            gsgl::index_t num_pushback;
+
             ft_stream(void *fp, gsgl::flags_t mode);
         public:
             ft_stream(const gsgl::string & fname, gsgl::flags_t mode = FILE_OPEN_READ);
@@ -94,11 +110,15 @@ namespace gsgl
             bool at_end() const;
 
             gsgl::index_t read(wchar_t *, const gsgl::index_t);
+            gsgl::index_t read_line(wchar_t *, const gsgl::index_t, bool & eol);
             gsgl::index_t write(const wchar_t *, const gsgl::index_t);
             
             static ft_stream out;
             static ft_stream err;
             static ft_stream in;
+
+        private:
+            wchar_t decode_char(bool consume);
         }; // class fstream
         
 
@@ -36,7 +36,8 @@
 
 #include "data/data.hpp"
 #include "data/array.hpp"
-#include "data/stack.hpp"
+
+#include <new>
 
 namespace gsgl
 {
@@ -45,12 +46,32 @@ namespace gsgl
     {
     
 		/// A pool of objects.
+		///
+		/// Objects are allocated in slabs of bucket_size slots that are never moved, so pointers to them remain valid.
+		/// Freed slots are kept in an intrusive free list threaded through the slots themselves, so allocate() and
+		/// deallocate() are O(1).  A bitmap records which slots are live, so that reset() and the destructor can
+		/// destroy the remaining objects in a single pass.
 		template <typename T>
 		class pool
-			: public data_object
+			: public array_base
 		{
-			object_array<T> data;
-			simple_stack<T *> deleted;
+			/// \internal Precedes each slot; records the slot's index so that deallocate() can find its liveness bit.
+			union slot_header
+			{
+				gsgl::index_t index;
+				double align_double;
+				void *align_ptr;
+			}; // union slot_header
+
+			enum { BITS_PER_WORD = sizeof(gsgl::flags_t) * 8 };
+
+			simple_array<unsigned char *> slabs;
+			simple_array<gsgl::flags_t> live;
+
+			void *free_list;             ///< The most recently freed object slot, which holds a pointer to the next one.
+			const gsgl::index_t slab_size;
+			const gsgl::index_t stride;  ///< The size of a slot, including its header.
+			gsgl::index_t num_slots;     ///< The number of slots that have ever been handed out since the last reset.
 			gsgl::index_t count;
 
 		public:
@@ -63,20 +84,41 @@ namespace gsgl
 			void *allocate_inplace();
 			void deallocate(T *);
 
+			/// Destroys all the objects in the pool at once, keeping the memory for reuse.
+			void reset();
+
 			gsgl::index_t size() const { return count; }
+
+		private:
+			void add_slab();
+			void destroy_live_objects();
+
+			inline unsigned char *slot_ptr(const gsgl::index_t & index) const
+			{
+				return slabs[index / slab_size] + (index % slab_size) * stride;
+			}
+
+			inline static gsgl::index_t index_of(const void *obj)
+			{
+				return reinterpret_cast<const slot_header *>(static_cast<const unsigned char *>(obj) - sizeof(slot_header))->index;
+			}
 		}; // class pool
 
 
 		template <typename T>
 		pool<T>::pool(const gsgl::index_t & initial_capacity, const gsgl::index_t & bucket_size)
-			: data_object(), data(initial_capacity, bucket_size, true), count(0)
+			: array_base(), free_list(0), slab_size(bucket_size > 0 ? bucket_size : 32),
+			  stride(static_cast<gsgl::index_t>(sizeof(slot_header) + ((gsgl::max_val(sizeof(T), sizeof(void *)) + sizeof(slot_header) - 1) / sizeof(slot_header)) * sizeof(slot_header))),
+			  num_slots(0), count(0)
 		{
+			while (slabs.size() * slab_size < initial_capacity)
+				add_slab();
 		} // pool<T>::pool()
 
 
 		template <typename T>
 		pool<T>::pool(const pool &)
-			: data_object(), data(0, 32), count(0)
+			: array_base(), free_list(0), slab_size(32), stride(0), num_slots(0), count(0)
 		{
 			throw internal_exception(__FILE__, __LINE__, L"Copying a pool object is illegal.");
 		} // pool<T>::pool()
@@ -92,14 +134,10 @@ namespace gsgl
 		template <typename T>
 		pool<T>::~pool()
 		{
-			// since the array's no_init flag is set, we have to delete the objects ourselves
-			for (int i = 0; i < data.size(); ++i)
-			{
-				T *ptr = &data[i];
+			destroy_live_objects();
 
-				if (!deleted.find_value(ptr).is_valid())
-					ptr->~T();
-			}
+			for (gsgl::index_t i = 0; i < slabs.size(); ++i)
+				array_base::deallocate(slabs[i]);
 		} // pool<T>::~pool()
 
 
@@ -107,27 +145,37 @@ namespace gsgl
 		template <typename T>
 		T *pool<T>::allocate()
 		{
-			T *result = allocate_inplace();
-			new (result) T();
-			return result;
+			return new (allocate_inplace()) T();
 		} // pool<T>::allocate()
 
 
+		/// Returns a pointer to uninitialized storage for an object of type T; use placement new to construct it.
 		template <typename T>
 		void *pool<T>::allocate_inplace()
 		{
-			T *result = 0;
+			void *result;
+			gsgl::index_t index;
 
-			if (deleted.size())
+			if (free_list)
 			{
-				result = deleted.top();
-				deleted.pop();
+				result = free_list;
+				free_list = *static_cast<void **>(result);
+				index = index_of(result);
 			}
 			else
 			{
-				result = &data[data.size()];
+				if (num_slots == slabs.size() * slab_size)
+					add_slab();
+
+				index = num_slots++;
+
+				unsigned char *slot = slot_ptr(index);
+				reinterpret_cast<slot_header *>(slot)->index = index;
+				result = slot + sizeof(slot_header);
 			}
 
+			live[index / BITS_PER_WORD] |= 1u << (index % BITS_PER_WORD);
+
 			++count;
 			return result;
 		} // pool<T>::allocate_inplace()
@@ -136,12 +184,64 @@ namespace gsgl
 		template <typename T>
 		void pool<T>::deallocate(T *ptr)
 		{
-			deleted.push(ptr);
+			gsgl::index_t index = index_of(ptr);
+			assert(flag_is_set(live[index / BITS_PER_WORD], 1u << (index % BITS_PER_WORD)));
+
 			ptr->~T();
+
+			unset_flags(live[index / BITS_PER_WORD], 1u << (index % BITS_PER_WORD));
+			*reinterpret_cast<void **>(ptr) = free_list;
+			free_list = ptr;
+
 			--count;
 		} // pool<T>::deallocate()
 
 
+		template <typename T>
+		void pool<T>::reset()
+		{
+			destroy_live_objects();
+
+			free_list = 0;
+			num_slots = 0;
+			count = 0;
+		} // pool<T>::reset()
+
+
+		//
+
+		template <typename T>
+		void pool<T>::add_slab()
+		{
+			slabs.append(static_cast<unsigned char *>(array_base::allocate(slab_size * stride)));
+
+			// make sure the liveness bitmap covers the new slots
+			gsgl::index_t words_needed = (slabs.size() * slab_size + BITS_PER_WORD - 1) / BITS_PER_WORD;
+			for (gsgl::index_t i = live.size(); i < words_needed; ++i)
+				live[i] = 0;
+		} // pool<T>::add_slab()
+
+
+		template <typename T>
+		void pool<T>::destroy_live_objects()
+		{
+			gsgl::index_t num_words = (num_slots + BITS_PER_WORD - 1) / BITS_PER_WORD;
+
+			for (gsgl::index_t i = 0; i < num_words; ++i)
+			{
+				gsgl::flags_t bits = live[i];
+
+				for (gsgl::index_t j = 0; bits; ++j, bits >>= 1)
+				{
+					if (bits & 1)
+						reinterpret_cast<T *>(slot_ptr(i * BITS_PER_WORD + j) + sizeof(slot_header))->~T();
+				}
+
+				live[i] = 0;
+			}
+		} // pool<T>::destroy_live_objects()
+
+
     } // namespace data
     
 } // namespace gsgl
@@ -49,14 +49,22 @@ namespace gsgl
 
     
         /// A priority queue.  Should only be used with simple types, as it copies around chunks of memory.
+        ///
+        /// The queue is kept as a 4-ary max-heap on the priority, so push() and pop() are O(log n) and front() is O(1).
+        /// Indexed access and iteration visit the items in order of decreasing priority; the first such access after
+        /// a push() or pop() sorts the heap in place (a sorted array is still a valid heap), which is O(n log n).
+        /// The relative order of items with equal priorities is unspecified.
         template <typename T, typename I>
         class pqueue
             : public data_object, public indexable<T, gsgl::index_t>, public iterable<T, pqueue_iterator<T,I> >
         {
             friend class pqueue_iterator<T,I>;
 
-            data::simple_array<T> values;
-            data::simple_array<I> priorities;
+            enum { ARITY = 4 };
+
+            mutable data::simple_array<T> values;
+            mutable data::simple_array<I> priorities;
+            mutable bool sorted;
 
         public:
             pqueue();
@@ -91,6 +99,11 @@ namespace gsgl
             void push(const T &, const I &);
             void pop();
             /// \}
+
+        private:
+            void sort_on_demand() const;
+            void sift_up(gsgl::index_t pos) const;
+            void sift_down(gsgl::index_t pos, const gsgl::index_t & len) const;
         }; // class pqueue
         
 
@@ -98,14 +111,14 @@ namespace gsgl
 
         template <typename T, typename I>
         pqueue<T,I>::pqueue()
-            : data_object(), iterable<T, pqueue_iterator<T,I> >()
+            : data_object(), iterable<T, pqueue_iterator<T,I> >(), sorted(true)
         {
         } // pqueue<T,I>::pqueue()
 
 
         template <typename T, typename I>
         pqueue<T,I>::pqueue(const pqueue & pq)
-            : data_object(), iterable<T, pqueue_iterator<T,I> >(), values(pq.values), priorities(pq.priorities)
+            : data_object(), iterable<T, pqueue_iterator<T,I> >(), values(pq.values), priorities(pq.priorities), sorted(pq.sorted)
         {
         } // pqueue<T,I>::pqueue()
 
@@ -115,6 +128,7 @@ namespace gsgl
         {
             values = pq.values;
             priorities = pq.priorities;
+            sorted = pq.sorted;
             return *this;
         } // pqueue<T,I>::pqueue()
 
@@ -140,6 +154,7 @@ namespace gsgl
         {
             values.clear();
             priorities.clear();
+            sorted = true;
         } // pqueue<T,I>::clear()
 
 
@@ -148,6 +163,7 @@ namespace gsgl
         template <typename T, typename I>
         const T & pqueue<T,I>::item(const gsgl::index_t & index) const
         {
+            sort_on_demand();
             return values.item(index);
         } // pqueue<T,I>::item()
 
@@ -155,6 +171,7 @@ namespace gsgl
         template <typename T, typename I>
         T & pqueue<T,I>::item(const gsgl::index_t & index)
         {
+            sort_on_demand();
             return values.item(index);
         } // pqueue<T,I>::item()
 
@@ -178,6 +195,7 @@ namespace gsgl
         template <typename T, typename I>
         void pqueue<T,I>::insert(const iterator & i, const T & item)
         {
+            sort_on_demand();
             push(item, priorities[i.position]);
         } // pqueue<T,I>::insert()
 
@@ -185,6 +203,8 @@ namespace gsgl
         template <typename T, typename I>
         void pqueue<T,I>::remove(const iterator & i)
         {
+            // removing an item from a sorted array leaves it sorted
+            sort_on_demand();
             values.remove(i.position);
             priorities.remove(i.position);
         } // pqueue<T,I>::remove()
@@ -207,24 +227,38 @@ namespace gsgl
         template <typename T, typename I>
         void pqueue<T,I>::push(const T & item, const I & priority)
         {
-            gsgl::index_t i, sz = values.size();
-            for (i = 0; i < sz; ++i)
-            {
-                if (priority >= priorities[i])
-                    break;
-            }
-            values.insert(i, item);
-            priorities.insert(i, priority);
+            // appending an item with the lowest priority so far keeps a sorted queue sorted
+            gsgl::index_t len = values.size();
+            if (sorted && len && priorities.ptr()[len - 1] < priority)
+                sorted = false;
+
+            values.append(item);
+            priorities.append(priority);
+            sift_up(len);
         } // pqueue<T,I>::push()
 
 
         template <typename T, typename I>
         void pqueue<T,I>::pop()
         {
-            if (values.size())
+            gsgl::index_t last = values.size() - 1;
+
+            if (last >= 0)
             {
-                values.remove(0);
-                priorities.remove(0);
+                T *v = values.ptr();
+                I *p = priorities.ptr();
+
+                v[0] = v[last];
+                p[0] = p[last];
+
+                values.remove(last);
+                priorities.remove(last);
+
+                if (last > 1)
+                {
+                    sift_down(0, last);
+                    sorted = false;
+                }
             }
             else
             {
@@ -233,6 +267,101 @@ namespace gsgl
         } // pqueue<T,I>::pop()
 
 
+        //
+
+        /// Heap-sorts the items into order of decreasing priority, if they are not already.
+        template <typename T, typename I>
+        void pqueue<T,I>::sort_on_demand() const
+        {
+            if (sorted)
+                return;
+
+            T *v = values.ptr();
+            I *p = priorities.ptr();
+            gsgl::index_t len = values.size();
+
+            // repeatedly move the top of the heap to the end, which yields increasing order
+            for (gsgl::index_t end = len - 1; end > 0; --end)
+            {
+                T tv = v[0]; v[0] = v[end]; v[end] = tv;
+                I tp = p[0]; p[0] = p[end]; p[end] = tp;
+
+                sift_down(0, end);
+            }
+
+            for (gsgl::index_t i = 0, j = len - 1; i < j; ++i, --j)
+            {
+                T tv = v[i]; v[i] = v[j]; v[j] = tv;
+                I tp = p[i]; p[i] = p[j]; p[j] = tp;
+            }
+
+            sorted = true;
+        } // pqueue<T,I>::sort_on_demand()
+
+
+        template <typename T, typename I>
+        void pqueue<T,I>::sift_up(gsgl::index_t pos) const
+        {
+            T *v = values.ptr();
+            I *p = priorities.ptr();
+
+            T val = v[pos];
+            I pri = p[pos];
+
+            while (pos > 0)
+            {
+                gsgl::index_t parent = (pos - 1) / ARITY;
+
+                if (!(p[parent] < pri))
+                    break;
+
+                v[pos] = v[parent];
+                p[pos] = p[parent];
+                pos = parent;
+            }
+
+            v[pos] = val;
+            p[pos] = pri;
+        } // pqueue<T,I>::sift_up()
+
+
+        template <typename T, typename I>
+        void pqueue<T,I>::sift_down(gsgl::index_t pos, const gsgl::index_t & len) const
+        {
+            T *v = values.ptr();
+            I *p = priorities.ptr();
+
+            T val = v[pos];
+            I pri = p[pos];
+
+            for (;;)
+            {
+                gsgl::index_t first = pos * ARITY + 1;
+                if (first >= len)
+                    break;
+
+                gsgl::index_t last = gsgl::min_val<gsgl::index_t>(first + ARITY, len);
+                gsgl::index_t best = first;
+
+                for (gsgl::index_t child = first + 1; child < last; ++child)
+                {
+                    if (p[best] < p[child])
+                        best = child;
+                }
+
+                if (!(pri < p[best]))
+                    break;
+
+                v[pos] = v[best];
+                p[pos] = p[best];
+                pos = best;
+            }
+
+            v[pos] = val;
+            p[pos] = pri;
+        } // pqueue<T,I>::sift_down()
+
+
         //////////////////////////////////////////
 
         template <typename T, typename I>
@@ -244,7 +373,10 @@ namespace gsgl
         
         protected:
             pqueue_iterator(const iterable<T, pqueue_iterator<T,I> > & parent_iterable)
-                : parent(dynamic_cast<const pqueue<T,I> &>(parent_iterable)), position(0) {}
+                : parent(dynamic_cast<const pqueue<T,I> &>(parent_iterable)), position(0)
+            {
+                parent.sort_on_demand();
+            }
 
             pqueue_iterator(const pqueue_iterator & i)
                 : parent(i.parent), position(i.position) {}
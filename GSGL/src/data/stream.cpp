@@ -37,7 +37,8 @@
 
 #include <cstdio>
 #include <cwchar>
-#include <cctype>
+#include <cwctype>
+#include <cstdlib>
 
 #ifdef WIN32
 #pragma warning (disable : 4996)
@@ -121,37 +122,67 @@ namespace gsgl
             return *this;
         } // text_stream::operator>> ()
         
+        /// Skips leading whitespace and reads an optionally signed decimal integer.  The character after the number is left in the stream.
         text_stream & text_stream::operator>> (int & n)
         {
-            wchar_t buf[BUF_LEN];
-            int pos = 0;
-            buf[pos] = 0;
-            
-            do
+            wchar_t ch = this->get();
+            while (ch != WEOF && ::iswspace(ch))
+                ch = this->get();
+
+            bool negative = ch == L'-';
+            if (ch == L'-' || ch == L'+')
+                ch = this->get();
+
+            int result = 0;
+            bool found = false;
+
+            while (ch >= L'0' && ch <= L'9')
             {
-                this->read(&buf[pos++], 1);
+                result = result * 10 + (ch - L'0');
+                found = true;
+                ch = this->get();
             }
-            while (pos < BUF_LEN && !this->at_end() && isdigit(buf[pos-1]));
-            buf[pos] = 0;
-            
-            swscanf(buf, L"%d", &n);
+
+            if (ch != WEOF)
+                this->unget(ch);
+
+            if (found)
+                n = negative ? -result : result;
+
             return *this;
         } // text_stream::operator>> ()
         
+
+        /// Skips leading whitespace and reads a floating-point number.  The character after the number is left in the stream.
         text_stream & text_stream::operator>> (double & n)
         {
             wchar_t buf[BUF_LEN];
             int pos = 0;
-            buf[pos] = 0;
-            
-            do
+
+            wchar_t ch = this->get();
+            while (ch != WEOF && ::iswspace(ch))
+                ch = this->get();
+
+            // collect the characters that could be part of a number; wcstod() will decide how many of them it wants
+            while (pos < BUF_LEN-1 && ((ch >= L'0' && ch <= L'9') || ch == L'.' || ch == L'-' || ch == L'+' || ch == L'e' || ch == L'E'))
             {
-                this->read(&buf[pos++], 1);
+                buf[pos++] = ch;
+                ch = this->get();
             }
-            while (pos < BUF_LEN && !this->at_end() && !isspace(buf[pos-1]));
             buf[pos] = 0;
-            
-            swscanf(buf, L"%f", &n);
+
+            if (ch != WEOF)
+                this->unget(ch);
+
+            if (pos)
+            {
+                wchar_t *end = 0;
+                double result = ::wcstod(buf, &end);
+
+                if (end != buf)
+                    n = result;
+            }
+
             return *this;
         } // text_stream::operator>> ()
 
@@ -164,6 +195,38 @@ namespace gsgl
         } // text_stream::oeprator>> ()
         
 
+        gsgl::index_t text_stream::read_line(wchar_t *buf, const gsgl::index_t num, bool & eol)
+        {
+            gsgl::index_t pos = 0;
+            eol = false;
+
+            while (pos < num)
+            {
+                wchar_t ch = this->get();
+
+                if (ch == WEOF)
+                    break;
+
+                if (ch == L'\r')
+                {
+                    if (this->peek() == L'\n')
+                        this->get();
+                    eol = true;
+                    break;
+                }
+                else if (ch == L'\n')
+                {
+                    eol = true;
+                    break;
+                }
+
+                buf[pos++] = ch;
+            }
+
+            return pos;
+        } // text_stream::read_line()
+
+
         text_stream & operator>> (text_stream & s, printable & p)
         {
             p.from_stream(s);
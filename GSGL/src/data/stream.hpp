@@ -59,6 +59,11 @@ namespace gsgl
             
             virtual gsgl::index_t read(wchar_t *, const gsgl::index_t num) = 0;
             virtual gsgl::index_t write(const wchar_t *, const gsgl::index_t num) = 0;
+
+            /// Reads characters up to the next line ending ("\n", "\r\n" or "\r"), which is consumed but not stored, or until num characters have been stored.
+            /// Sets eol if a line ending was consumed.  The default implementation uses get(); streams that can scan their own buffers should override it.
+            /// \return The number of characters stored in the buffer.
+            virtual gsgl::index_t read_line(wchar_t *, const gsgl::index_t num, bool & eol);
             
             text_stream & operator<< (const wchar_t *);
             text_stream & operator<< (const wchar_t &);
@@ -543,20 +543,19 @@ namespace gsgl
     {
         clear();
 
-        for (wchar_t ch = s.get(); ch != WEOF; ch = s.get())
-        {
-            if (ch == L'\r')
-            {
-                ch = L'\n';
-                if (s.peek() == L'\n')
-                    s.get();
-            }
+        static const gsgl::index_t LINE_BUF_LEN = 256;
+        wchar_t buf[LINE_BUF_LEN + 1];
+        gsgl::index_t len;
+        bool eol;
 
-            if (ch == L'\n')
-                break;
-            else
-                append(ch);
+        // long lines come back in pieces
+        do
+        {
+            len = s.read_line(buf, LINE_BUF_LEN, eol);
+            buf[len] = 0;
+            append(buf);
         }
+        while (!eol && len == LINE_BUF_LEN);
 
         ASSIGN_DEBUG_PTR();
     } // string::from_stream()
@@ -839,7 +838,7 @@ namespace gsgl
     {
         int res = 0;
         if (size())
-            ::swscanf(w_string(), L"%d", &res);
+            res = static_cast<int>(::wcstol(w_string(), 0, 10));
         return res;
     } // string::to_int()
 
@@ -848,7 +847,7 @@ namespace gsgl
     {
         double res = 0.0f;
         if (size())
-            ::swscanf(w_string(), L"%lf", &res);
+            res = ::wcstod(w_string(), 0);
         return res;
     } // string::to_double()
 
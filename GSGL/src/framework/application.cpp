@@ -42,7 +42,8 @@
 #include "data/broker.hpp"
 
 #include "platform/thread.hpp"
-#include "platform/budget.hpp"
+#include "platform/job_scheduler.hpp"
+#include "platform/profiler.hpp"
 #include "platform/display.hpp"
 #include "platform/texture.hpp"
 
@@ -91,6 +92,8 @@ namespace gsgl
         config_variable<string> application::EVENT_MAP_PATH(L"paths/event_map", L"EventMap.cfg");
         config_variable<string> application::USER_CONFIG_PATH(L"paths/user_config", L"UserConfig.cfg");
 
+        static config_variable<string> PROFILE_TRACE_FILE(L"platform/profiler/trace_file", L"profile_trace.json"); ///< Written to the user data directory when a profile capture stops.
+
         
         /// Creates the global application object.
         /// This will also create the global application broker, event map and console objects.
@@ -102,13 +105,16 @@ namespace gsgl
               global_sim_context(0), global_draw_context(0),
               global_scenery(0), global_simulation(0),
               global_console(0), global_mapper(0),
-              global_budget(0), budget_font(0)
+              global_profiler(0), profile_font(0), global_jobs(0)
         {
             // override global config
             get_config_overrides(argc, argv);
 
-            // global budget
-            global_budget = new budget();
+            // global profiler
+            global_profiler = new profiler();
+
+            // worker threads for the engine's parallel work
+            global_jobs = new job_scheduler();
 
             // init event mapper
             global_mapper = new event_map(EVENT_MAP_PATH);
@@ -282,8 +288,9 @@ namespace gsgl
             delete global_console;    global_console = 0;
             delete global_mapper;     global_mapper = 0;
 
-            delete budget_font;       budget_font = 0;
-            delete global_budget;     global_budget = 0;
+            delete profile_font;      profile_font = 0;
+            delete global_jobs;       global_jobs = 0;
+            delete global_profiler;   global_profiler = 0;
 
             // this stuff is here rather than in the destructor because these might throw
             model::clear_cache(L"__ALL__");
@@ -304,10 +311,7 @@ namespace gsgl
 
             // main loop
             state = APP_UI_RUNNING;
-            bool should_draw_budget = false;
-            unsigned int start_tick, end_tick;
-            global_budget->reset();
-            start_tick = SDL_GetTicks();
+            bool should_draw_profile = false;
 
             while (state != APP_QUITTING)
             {
@@ -328,7 +332,7 @@ namespace gsgl
                         }
                         else if (splash_screen)
                         {
-                            BUDGET_SCOPE(L"application: splash screen");
+                            PROFILE_SCOPE("application: splash screen");
 
                             draw_splash_screen();
                         }
@@ -343,7 +347,7 @@ namespace gsgl
                 // draw global UI elements
                 if ((state == APP_UI_RUNNING || state == APP_SIM_RUNNING))
                 {
-                    BUDGET_SCOPE(L"application: user interface");
+                    PROFILE_SCOPE("application: user interface");
 
                     // draw from bottom up
                     int i, num = widgets.size();
@@ -362,18 +366,15 @@ namespace gsgl
                     }
                 }
 
-                // draw budget
-                if (should_draw_budget)
-                {
-                    end_tick = SDL_GetTicks();
-                    draw_budget(end_tick - start_tick);
-                    global_budget->reset();
-                    start_tick = SDL_GetTicks();
-                }
+                // collect the last frame's profile
+                global_profiler->end_frame();
+
+                if (should_draw_profile)
+                    draw_profile();
 
                 // swap buffers
                 {
-                    BUDGET_SCOPE(L"application: buffer swap");
+                    PROFILE_SCOPE("application: buffer swap");
                     SDL_GL_SwapBuffers();
                 }
 
@@ -396,7 +397,7 @@ namespace gsgl
 
                 // get events
                 {
-                    BUDGET_SCOPE(L"application: event handling");
+                    PROFILE_SCOPE("application: event handling");
 
                     SDL_Event e;
                     while (SDL_PollEvent(&e))
@@ -409,7 +410,22 @@ namespace gsgl
                         case SDL_KEYDOWN:
                             if (e.key.keysym.sym == SDLK_b && (e.key.keysym.mod & (KMOD_CTRL | KMOD_ALT)))
                             {
-                                should_draw_budget = !should_draw_budget;
+                                should_draw_profile = !should_draw_profile;
+                                break;
+                            }
+                            else if (e.key.keysym.sym == SDLK_p && (e.key.keysym.mod & (KMOD_CTRL | KMOD_ALT)))
+                            {
+                                if (global_profiler->is_capturing())
+                                {
+                                    string fname = static_cast<string>(USER_DATA_PATH) + directory::SEPARATOR + PROFILE_TRACE_FILE;
+                                    global_profiler->stop_capture(fname);
+                                    gsgl::log(string(L"application: wrote profile trace to ") + fname);
+                                }
+                                else
+                                {
+                                    global_profiler->start_capture();
+                                    gsgl::log(L"application: capturing profile trace");
+                                }
                                 break;
                             }
                             else if (e.key.keysym.sym == SDLK_w && (e.key.keysym.mod & (KMOD_CTRL | KMOD_ALT)))
@@ -483,62 +499,68 @@ namespace gsgl
         } // application::draw_splash_screen()
 
 
-        static const int BUDGET_FONT_SIZE = 12;
-        static const color BUDGET_COLOR(1.0f, 0, 0, 1.0f);
-        static const int BUDGET_BAR_WIDTH = 256;
-        static const wchar_t *BUDGET_FORMAT = L"%6u";
+        static const int PROFILE_FONT_SIZE = 12;
+        static const color PROFILE_COLOR(1.0f, 0, 0, 1.0f);
+        static const int PROFILE_BAR_WIDTH = 256;
+        static const wchar_t *PROFILE_FORMAT = L"%7.2f ms %6u";
 
-        void application::draw_budget(unsigned int ticks)
+        /// Draws the time spent in each profiler scope during the last frame, not counting the time spent in nested scopes.
+        void application::draw_profile()
         {
-            if (!budget_font)
-                budget_font = new font(L"Sans", BUDGET_FONT_SIZE, BUDGET_COLOR);
+            if (!profile_font)
+                profile_font = new font(L"Sans", PROFILE_FONT_SIZE, PROFILE_COLOR);
 
             // get width & highest value
-            int step = BUDGET_FONT_SIZE * 4 / 3;
-            int num = global_budget->get_data().size();
+            int step = PROFILE_FONT_SIZE * 4 / 3;
+            int num_scopes = profiler::get_num_scopes();
+            int num = 0;
             int widest = 0;
-            unsigned int highest = 0;
-            int sum = 0;
+            unsigned long long highest = 1;
 
-            for (dictionary<unsigned int, string>::iterator i = global_budget->get_data().iter(); i.is_valid(); ++i)
+            for (int i = 0; i < num_scopes; ++i)
             {
-                int width = static_cast<int>(budget_font->calc_width(i.get_index()));
+                const profiler::scope_totals & totals = global_profiler->get_frame_totals(i);
+                if (!totals.count)
+                    continue;
+
+                int width = static_cast<int>(profile_font->calc_width(string(profiler::get_scope_name(i))));
                 if (width > widest)
                     widest = width;
 
-                if (*i > highest)
-                    highest = *i;
+                if (totals.exclusive_ns > highest)
+                    highest = totals.exclusive_ns;
 
-                sum += *i;
+                ++num;
             }
 
+            widest += step;
+
             // draw text
             {
                 display::scoped_text td(*global_console);
-                display::scoped_color sc(*global_console, BUDGET_COLOR);
+                display::scoped_color sc(*global_console, PROFILE_COLOR);
 
-                td.draw_2d(0, static_cast<float>((num+1)*step), budget_font, L"TOTAL");
-                td.draw_2d(static_cast<float>(widest), static_cast<float>((num+1)*step), budget_font, string::format(BUDGET_FORMAT, ticks));
+                td.draw_2d(0, static_cast<float>(num*step), profile_font, L"FRAME");
+                td.draw_2d(static_cast<float>(widest), static_cast<float>(num*step), profile_font, string::format(PROFILE_FORMAT, static_cast<double>(global_profiler->get_frame_time()) / 1.0e6, 1));
 
                 int n = 0;
-                for (dictionary<unsigned int, string>::iterator i = global_budget->get_data().iter(); i.is_valid(); ++i, ++n)
+                for (int i = 0; i < num_scopes; ++i)
                 {
-                    int y = (num-n)*step;
-
-                    td.draw_2d(0, static_cast<float>(y), budget_font, i.get_index());
-                    td.draw_2d(static_cast<float>(widest), static_cast<float>(y), budget_font, string::format(BUDGET_FORMAT, *i));
+                    const profiler::scope_totals & totals = global_profiler->get_frame_totals(i);
+                    if (!totals.count)
+                        continue;
 
-                    int w = static_cast<int>(BUDGET_BAR_WIDTH * static_cast<double>(*i)/static_cast<double>(highest));
-                    global_console->draw_rect_2d(static_cast<float>(widest+64), static_cast<float>(y+2), static_cast<float>(widest+64+w), static_cast<float>(y+8));
-                }
+                    int y = (num-1-n)*step;
+                    ++n;
 
-                td.draw_2d(0, 0, budget_font, L"other");
-                td.draw_2d(static_cast<float>(widest), 0, budget_font, string::format(BUDGET_FORMAT, ticks - sum));
+                    td.draw_2d(0, static_cast<float>(y), profile_font, string(profiler::get_scope_name(i)));
+                    td.draw_2d(static_cast<float>(widest), static_cast<float>(y), profile_font, string::format(PROFILE_FORMAT, static_cast<double>(totals.exclusive_ns) / 1.0e6, totals.count));
 
-                int w = static_cast<int>(BUDGET_BAR_WIDTH * static_cast<double>(ticks - sum)/static_cast<double>(highest));
-                global_console->draw_rect_2d(static_cast<float>(widest+64), 2, static_cast<float>(widest+64+w), 10);
+                    int w = static_cast<int>(PROFILE_BAR_WIDTH * static_cast<double>(totals.exclusive_ns)/static_cast<double>(highest));
+                    global_console->draw_rect_2d(static_cast<float>(widest+128), static_cast<float>(y+2), static_cast<float>(widest+128+w), static_cast<float>(y+8));
+                }
             }
-        } // application::draw_budget()
+        } // application::draw_profile()
 
 
         void application::draw_ui(widget *w)
@@ -59,8 +59,9 @@ namespace gsgl
     
     namespace platform
     {
-        class budget;
         class display;
+        class job_scheduler;
+        class profiler;
         class texture;
 
         template <typename T>
@@ -122,8 +123,10 @@ namespace gsgl
             platform::display      *global_console;
             scenegraph::event_map  *global_mapper;
 
-            platform::budget       *global_budget;
-            platform::font         *budget_font;
+            platform::profiler     *global_profiler;
+            platform::font         *profile_font;
+
+            platform::job_scheduler *global_jobs;
 
         public:
 
@@ -151,7 +154,7 @@ namespace gsgl
             scenegraph::node           *get_global_scenery() { return global_scenery; }
             platform::display          *get_console()        { return global_console; }
             scenegraph::simulation     *get_simulation()     { return global_simulation; }
-            platform::budget           *get_global_budget()  { return global_budget; }
+            platform::profiler         *get_global_profiler() { return global_profiler; }
 
             data::simple_stack<widget *> & get_widgets() { return widgets; }
             widget *get_focus_widget() { return focus_widget; } ///< Return the widget with the current keyboard focus.
@@ -202,7 +205,7 @@ namespace gsgl
             //
             void draw_splash_screen();
             void draw_ui(framework::widget *);
-            void draw_budget(unsigned int ticks);
+            void draw_profile();
 
             //
             int mouse_button_pressed;
@@ -0,0 +1,207 @@
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "math/batch.hpp"
+
+namespace gsgl
+{
+
+    namespace math
+    {
+
+        namespace batch
+        {
+
+            template <typename T>
+            static void transform_points_scalar(const gsgl::real_t *m, const gsgl::index_t begin, const gsgl::index_t count, 
+                                                const T *x, const T *y, const T *z, T *out_x, T *out_y, T *out_z, const T w)
+            {
+                for (gsgl::index_t i = begin; i < count; ++i)
+                {
+                    const T px = x[i], py = y[i], pz = z[i];
+                    out_x[i] = m[0]*px + m[4]*py + m[8]*pz  + m[12]*w;
+                    out_y[i] = m[1]*px + m[5]*py + m[9]*pz  + m[13]*w;
+                    out_z[i] = m[2]*px + m[6]*py + m[10]*pz + m[14]*w;
+                }
+            } // transform_points_scalar()
+
+
+#ifdef GSGL_MATH_SSE
+            /// Does four points at a time, and returns the number done.
+            static gsgl::index_t transform_points_sse(const gsgl::real_t *m, const gsgl::index_t count, 
+                                                      const float *x, const float *y, const float *z, float *out_x, float *out_y, float *out_z, const float w)
+            {
+                const gsgl::index_t num_simd = count & ~3;
+
+                for (gsgl::index_t i = 0; i < num_simd; i += 4)
+                {
+                    __m128 px = _mm_loadu_ps(x + i);
+                    __m128 py = _mm_loadu_ps(y + i);
+                    __m128 pz = _mm_loadu_ps(z + i);
+
+                    for (int row = 0; row < 3; ++row)
+                    {
+                        __m128 r = _mm_set1_ps(m[12+row] * w);
+                        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(m[0+row]), px));
+                        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(m[4+row]), py));
+                        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(m[8+row]), pz));
+
+                        float *out = row == 0 ? out_x : (row == 1 ? out_y : out_z);
+                        _mm_storeu_ps(out + i, r);
+                    }
+                }
+
+                return num_simd;
+            } // transform_points_sse()
+#endif
+
+
+            void transform_points(const transform & t, const gsgl::index_t count, 
+                                  const float *x, const float *y, const float *z, 
+                                  float *out_x, float *out_y, float *out_z)
+            {
+                gsgl::index_t done = 0;
+#ifdef GSGL_MATH_SSE
+                done = transform_points_sse(t.ptr(), count, x, y, z, out_x, out_y, out_z, 1);
+#endif
+                transform_points_scalar<float>(t.ptr(), done, count, x, y, z, out_x, out_y, out_z, 1);
+            } // transform_points()
+
+
+            void transform_points(const transform & t, const gsgl::index_t count, 
+                                  const double *x, const double *y, const double *z, 
+                                  double *out_x, double *out_y, double *out_z)
+            {
+                transform_points_scalar<double>(t.ptr(), 0, count, x, y, z, out_x, out_y, out_z, 1);
+            } // transform_points()
+
+
+            void transform_normals(const transform & t, const gsgl::index_t count, 
+                                   const float *x, const float *y, const float *z, 
+                                   float *out_x, float *out_y, float *out_z)
+            {
+                gsgl::index_t done = 0;
+#ifdef GSGL_MATH_SSE
+                done = transform_points_sse(t.ptr(), count, x, y, z, out_x, out_y, out_z, 0);
+#endif
+                transform_points_scalar<float>(t.ptr(), done, count, x, y, z, out_x, out_y, out_z, 0);
+            } // transform_normals()
+
+
+            void transform_normals(const transform & t, const gsgl::index_t count, 
+                                   const double *x, const double *y, const double *z, 
+                                   double *out_x, double *out_y, double *out_z)
+            {
+                transform_points_scalar<double>(t.ptr(), 0, count, x, y, z, out_x, out_y, out_z, 0);
+            } // transform_normals()
+
+
+            //
+
+            void project_to_screen(const transform & modelview_projection, const int viewport[4], const gsgl::index_t count, 
+                                   const float *x, const float *y, const float *z, 
+                                   float *out_x, float *out_y, float *out_depth)
+            {
+                const gsgl::real_t *m = modelview_projection.ptr();
+
+                const float vx = static_cast<float>(viewport[0]), vy = static_cast<float>(viewport[1]);
+                const float half_w = static_cast<float>(viewport[2]) * 0.5f, half_h = static_cast<float>(viewport[3]) * 0.5f;
+
+                gsgl::index_t i = 0;
+
+#ifdef GSGL_MATH_SSE
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 one = _mm_set1_ps(1.0f);
+                const __m128 half = _mm_set1_ps(0.5f);
+
+                const gsgl::index_t num_simd = count & ~3;
+
+                for (; i < num_simd; i += 4)
+                {
+                    __m128 px = _mm_loadu_ps(x + i);
+                    __m128 py = _mm_loadu_ps(y + i);
+                    __m128 pz = _mm_loadu_ps(z + i);
+
+                    __m128 clip[4];
+                    for (int row = 0; row < 4; ++row)
+                    {
+                        __m128 r = _mm_set1_ps(m[12+row]);
+                        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(m[0+row]), px));
+                        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(m[4+row]), py));
+                        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(m[8+row]), pz));
+                        clip[row] = r;
+                    }
+
+                    // divide by w only where w > 0, as vector::normalize_h() does
+                    __m128 in_front = _mm_cmpgt_ps(clip[3], zero);
+                    __m128 safe_w = _mm_or_ps(_mm_and_ps(in_front, clip[3]), _mm_andnot_ps(in_front, one));
+                    __m128 inv_w = _mm_div_ps(one, safe_w);
+
+                    __m128 nx = _mm_mul_ps(clip[0], inv_w);
+                    __m128 ny = _mm_mul_ps(clip[1], inv_w);
+                    __m128 nz = _mm_mul_ps(clip[2], inv_w);
+
+                    _mm_storeu_ps(out_x + i, _mm_add_ps(_mm_set1_ps(vx), _mm_mul_ps(_mm_set1_ps(half_w), _mm_add_ps(nx, one))));
+                    _mm_storeu_ps(out_y + i, _mm_add_ps(_mm_set1_ps(vy), _mm_mul_ps(_mm_set1_ps(half_h), _mm_add_ps(ny, one))));
+                    _mm_storeu_ps(out_depth + i, _mm_mul_ps(half, _mm_add_ps(nz, one)));
+                }
+#endif
+
+                for (; i < count; ++i)
+                {
+                    const float px = x[i], py = y[i], pz = z[i];
+
+                    float cx = m[0]*px + m[4]*py + m[8]*pz  + m[12];
+                    float cy = m[1]*px + m[5]*py + m[9]*pz  + m[13];
+                    float cz = m[2]*px + m[6]*py + m[10]*pz + m[14];
+                    float cw = m[3]*px + m[7]*py + m[11]*pz + m[15];
+
+                    if (cw > 0)
+                    {
+                        const float inv_w = 1.0f / cw;
+                        cx *= inv_w;
+                        cy *= inv_w;
+                        cz *= inv_w;
+                    }
+
+                    out_x[i] = vx + half_w * (cx + 1);
+                    out_y[i] = vy + half_h * (cy + 1);
+                    out_depth[i] = 0.5f * (cz + 1);
+                }
+            } // project_to_screen()
+
+        } // namespace batch
+
+    } // namespace math
+
+} // namespace gsgl
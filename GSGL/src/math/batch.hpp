@@ -0,0 +1,117 @@
+#ifndef GSGL_MATH_BATCH_H
+#define GSGL_MATH_BATCH_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "math/math.hpp"
+#include "math/transform.hpp"
+
+namespace gsgl
+{
+
+    namespace math
+    {
+
+        /// Functions that transform many points at once.
+        /// The points are given in structure-of-arrays form: separate arrays of x, y and z coordinates.
+        /// The output arrays may be the same as the input arrays.  The float versions use SSE four points at a time when it is available.
+        namespace batch
+        {
+
+            /// Transforms points by an affine transform (bottom row 0 0 0 1), without the homogeneous divide.
+            MATH_API void transform_points(const transform & t, const gsgl::index_t count, 
+                                           const float *x, const float *y, const float *z, 
+                                           float *out_x, float *out_y, float *out_z);
+
+            MATH_API void transform_points(const transform & t, const gsgl::index_t count, 
+                                           const double *x, const double *y, const double *z, 
+                                           double *out_x, double *out_y, double *out_z);
+
+
+            /// Transforms directions by the upper 3x3 block of a transform; the translation is ignored.
+            /// This is correct for normals when the transform is rigid.  The results are not renormalized.
+            MATH_API void transform_normals(const transform & t, const gsgl::index_t count, 
+                                            const float *x, const float *y, const float *z, 
+                                            float *out_x, float *out_y, float *out_z);
+
+            MATH_API void transform_normals(const transform & t, const gsgl::index_t count, 
+                                            const double *x, const double *y, const double *z, 
+                                            double *out_x, double *out_y, double *out_z);
+
+
+            /// Projects points to window coordinates, as scenegraph::utils::pos_in_screen_space() does for a single point.
+            /// The depth output is (z+1)/2 of the normalized device z.  As in pos_in_screen_space(), points with w <= 0 (behind the eye) are not divided by w.
+            MATH_API void project_to_screen(const transform & modelview_projection, const int viewport[4], const gsgl::index_t count, 
+                                            const float *x, const float *y, const float *z, 
+                                            float *out_x, float *out_y, float *out_depth);
+
+
+            //
+
+            /// A body for platform::parallel_for() that runs transform_points() over part of a batch.
+            template <typename T>
+            struct transform_points_range
+            {
+                const transform *t;
+                const T *x, *y, *z;
+                T *out_x, *out_y, *out_z;
+
+                void operator() (const gsgl::index_t begin, const gsgl::index_t end) const
+                {
+                    transform_points(*t, end - begin, x + begin, y + begin, z + begin, out_x + begin, out_y + begin, out_z + begin);
+                }
+            }; // struct transform_points_range
+
+
+            /// A body for platform::parallel_for() that runs project_to_screen() over part of a batch.
+            struct project_to_screen_range
+            {
+                const transform *modelview_projection;
+                const int *viewport;
+                const float *x, *y, *z;
+                float *out_x, *out_y, *out_depth;
+
+                void operator() (const gsgl::index_t begin, const gsgl::index_t end) const
+                {
+                    project_to_screen(*modelview_projection, viewport, end - begin, x + begin, y + begin, z + begin, out_x + begin, out_y + begin, out_depth + begin);
+                }
+            }; // struct project_to_screen_range
+
+        } // namespace batch
+
+    } // namespace math
+
+} // namespace gsgl
+
+#endif
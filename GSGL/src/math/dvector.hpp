@@ -0,0 +1,105 @@
+#ifndef GSGL_MATH_DVECTOR_H
+#define GSGL_MATH_DVECTOR_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "math/math.hpp"
+#include "math/vector.hpp"
+#include "math/transform.hpp"
+
+#include <cmath>
+
+namespace gsgl
+{
+
+    namespace math
+    {
+
+        /// A double-precision 3-d vector, for positions that are too far from their frame's origin to be stored in floats.
+        /// Subtract two of these before converting to a vector, so the difference keeps its precision.
+        class MATH_API dvector
+        {
+            double data[3];
+
+        public:
+            dvector(const double x = 0, const double y = 0, const double z = 0) { data[0] = x; data[1] = y; data[2] = z; }
+            explicit dvector(const vector & v) { data[0] = v.get_x(); data[1] = v.get_y(); data[2] = v.get_z(); }
+
+            inline const double & get_x() const { return data[0]; }
+            inline const double & get_y() const { return data[1]; }
+            inline const double & get_z() const { return data[2]; }
+
+            inline double & get_x() { return data[0]; }
+            inline double & get_y() { return data[1]; }
+            inline double & get_z() { return data[2]; }
+
+            /// Rounds the vector to single precision.
+            vector to_vector() const
+            {
+                return vector(static_cast<gsgl::real_t>(data[0]), static_cast<gsgl::real_t>(data[1]), static_cast<gsgl::real_t>(data[2]));
+            }
+
+            dvector operator- () const { return dvector(-data[0], -data[1], -data[2]); }
+            dvector operator+ (const dvector & v) const { return dvector(data[0] + v.data[0], data[1] + v.data[1], data[2] + v.data[2]); }
+            dvector operator- (const dvector & v) const { return dvector(data[0] - v.data[0], data[1] - v.data[1], data[2] - v.data[2]); }
+            dvector operator* (const double n) const { return dvector(data[0] * n, data[1] * n, data[2] * n); }
+
+            dvector & operator+= (const dvector & v) { data[0] += v.data[0]; data[1] += v.data[1]; data[2] += v.data[2]; return *this; }
+            dvector & operator-= (const dvector & v) { data[0] -= v.data[0]; data[1] -= v.data[1]; data[2] -= v.data[2]; return *this; }
+
+            bool operator== (const dvector & v) const { return data[0] == v.data[0] && data[1] == v.data[1] && data[2] == v.data[2]; }
+
+            double mag2() const { return data[0]*data[0] + data[1]*data[1] + data[2]*data[2]; }
+            double mag() const { return ::sqrt(mag2()); }
+
+            /// Multiplies the vector by the upper 3x3 block of a transform, in double precision.
+            dvector rotate_by(const transform & t) const
+            {
+                const gsgl::real_t *m = t.ptr();
+                return dvector(m[0]*data[0] + m[4]*data[1] + m[8]*data[2],
+                               m[1]*data[0] + m[5]*data[1] + m[9]*data[2],
+                               m[2]*data[0] + m[6]*data[1] + m[10]*data[2]);
+            }
+
+            static dvector interpolate(const dvector & start, const dvector & end, const double & percent)
+            {
+                return start + (end - start) * percent;
+            }
+        }; // class dvector
+
+    } // namespace math
+
+} // namespace gsgl
+
+#endif
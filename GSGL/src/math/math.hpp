@@ -49,6 +49,15 @@
 #endif
 
 
+// Use SSE for the 4x4 matrix kernels when the compiler targets it (x64 always does).
+// Define GSGL_MATH_NO_SIMD to force the scalar versions.
+
+#if !defined(GSGL_MATH_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define GSGL_MATH_SSE
+#include <xmmintrin.h>
+#endif
+
+
 namespace gsgl
 {
 
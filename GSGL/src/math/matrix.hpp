@@ -50,6 +50,7 @@ namespace gsgl
     
         /// A generic matrix class.
         /// Implements an RxC matrix, where R is the number of rows and C is the number of columns.
+        /// There are no virtual functions, so a matrix is laid out as exactly R*C values and may be copied with memcpy.
         template <int R, int C, typename T = gsgl::real_t> 
         class matrix
             : public math_object
@@ -59,9 +60,6 @@ namespace gsgl
         public:
             matrix();
             explicit matrix(const T *); ///< Initializes the matrix from an array in column-major order.
-            matrix(const matrix<R,C,T> &);
-            matrix & operator= (const matrix<R,C,T> &);
-            virtual ~matrix();
             
             const T & item (int i, int j) const { return data[j*R+i]; }
             T & item (int i, int j) { return data[j*R+i]; }
@@ -93,25 +91,6 @@ namespace gsgl
             ::memcpy(data, ptr, sizeof(T) * R*C);
         } // matrix<R,C,T>::matrix()
         
-        template <int R, int C, typename T> 
-        matrix<R,C,T>::matrix(const matrix<R,C,T> & m)
-            : math_object()
-        {
-            ::memcpy(data, m.data, sizeof(T) * R*C);
-        } // matrix<R,C,T>::matrix()
-        
-        template <int R, int C, typename T> 
-        matrix<R,C,T> & matrix<R,C,T>::operator= (const matrix<R,C,T> & m)
-        {
-            ::memcpy(data, m.data, sizeof(T) * R*C);
-            return *this;
-        } // matrix<R,C,T>::operator= ()
-        
-        template <int R, int C, typename T> 
-        matrix<R,C,T>::~matrix()
-        {
-        } // matrix<R,C,T>::~matrix()
-        
         //
 
         template <int R, int C, typename T>
@@ -185,6 +164,152 @@ namespace gsgl
                 }
             } // multiply()
 
+
+            /// Transposes an arbitrary matrix.
+            template <int R, int C, typename T>
+            void transpose(const matrix<R,C,T> & a, matrix<C,R,T> & result)
+            {
+                const T *pa = a.ptr();
+                T *pr = result.ptr();
+
+                for (int i = 0; i < R; ++i)
+                    for (int j = 0; j < C; ++j)
+                        pr[i*C+j] = pa[j*R+i];
+            } // transpose()
+
+
+            //
+
+            /// Multiplies two column-major 4x4 float matrices.
+            /// Both operands are read completely before anything is written, so the result may alias either one.
+            inline void multiply_4x4(const float *pa, const float *pb, float *pr)
+            {
+#ifdef GSGL_MATH_SSE
+                __m128 a0 = _mm_loadu_ps(pa + 0);
+                __m128 a1 = _mm_loadu_ps(pa + 4);
+                __m128 a2 = _mm_loadu_ps(pa + 8);
+                __m128 a3 = _mm_loadu_ps(pa + 12);
+
+                __m128 b[4];
+                for (int j = 0; j < 4; ++j)
+                    b[j] = _mm_loadu_ps(pb + j*4);
+
+                for (int j = 0; j < 4; ++j)
+                {
+                    __m128 r =         _mm_mul_ps(a0, _mm_shuffle_ps(b[j], b[j], _MM_SHUFFLE(0,0,0,0)));
+                    r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_shuffle_ps(b[j], b[j], _MM_SHUFFLE(1,1,1,1))));
+                    r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_shuffle_ps(b[j], b[j], _MM_SHUFFLE(2,2,2,2))));
+                    r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_shuffle_ps(b[j], b[j], _MM_SHUFFLE(3,3,3,3))));
+                    _mm_storeu_ps(pr + j*4, r);
+                }
+#else
+                float a[16], b[16];
+                for (int k = 0; k < 16; ++k)
+                {
+                    a[k] = pa[k];
+                    b[k] = pb[k];
+                }
+
+                for (int j = 0; j < 4; ++j)
+                {
+                    const float b0 = b[j*4+0], b1 = b[j*4+1], b2 = b[j*4+2], b3 = b[j*4+3];
+                    pr[j*4+0] = a[0]*b0 + a[4]*b1 + a[8]*b2  + a[12]*b3;
+                    pr[j*4+1] = a[1]*b0 + a[5]*b1 + a[9]*b2  + a[13]*b3;
+                    pr[j*4+2] = a[2]*b0 + a[6]*b1 + a[10]*b2 + a[14]*b3;
+                    pr[j*4+3] = a[3]*b0 + a[7]*b1 + a[11]*b2 + a[15]*b3;
+                }
+#endif
+            } // multiply_4x4()
+
+
+            /// Multiplies a column-major 4x4 float matrix by a 4-element column vector.  The result may alias the vector.
+            inline void multiply_4x1(const float *pa, const float *pv, float *pr)
+            {
+#ifdef GSGL_MATH_SSE
+                __m128 v = _mm_loadu_ps(pv);
+                __m128 r =         _mm_mul_ps(_mm_loadu_ps(pa + 0),  _mm_shuffle_ps(v, v, _MM_SHUFFLE(0,0,0,0)));
+                r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(pa + 4),  _mm_shuffle_ps(v, v, _MM_SHUFFLE(1,1,1,1))));
+                r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(pa + 8),  _mm_shuffle_ps(v, v, _MM_SHUFFLE(2,2,2,2))));
+                r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(pa + 12), _mm_shuffle_ps(v, v, _MM_SHUFFLE(3,3,3,3))));
+                _mm_storeu_ps(pr, r);
+#else
+                const float v0 = pv[0], v1 = pv[1], v2 = pv[2], v3 = pv[3];
+                pr[0] = pa[0]*v0 + pa[4]*v1 + pa[8]*v2  + pa[12]*v3;
+                pr[1] = pa[1]*v0 + pa[5]*v1 + pa[9]*v2  + pa[13]*v3;
+                pr[2] = pa[2]*v0 + pa[6]*v1 + pa[10]*v2 + pa[14]*v3;
+                pr[3] = pa[3]*v0 + pa[7]*v1 + pa[11]*v2 + pa[15]*v3;
+#endif
+            } // multiply_4x1()
+
+
+            /// Multiplies an affine column-major 4x4 float matrix (bottom row 0 0 0 1) by a 3-d point.
+            /// The homogeneous coordinate of the result is 1, so no divide is needed.  If w is 0 the translation is ignored,
+            /// which transforms a direction instead of a point.
+            inline void multiply_affine_4x1(const float *pa, const float x, const float y, const float z, const float w, float *pr)
+            {
+#ifdef GSGL_MATH_SSE
+                __m128 r =         _mm_mul_ps(_mm_loadu_ps(pa + 0),  _mm_set1_ps(x));
+                r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(pa + 4),  _mm_set1_ps(y)));
+                r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(pa + 8),  _mm_set1_ps(z)));
+                r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(pa + 12), _mm_set1_ps(w)));
+                _mm_storeu_ps(pr, r);
+                pr[3] = 1;
+#else
+                pr[0] = pa[0]*x + pa[4]*y + pa[8]*z  + pa[12]*w;
+                pr[1] = pa[1]*x + pa[5]*y + pa[9]*z  + pa[13]*w;
+                pr[2] = pa[2]*x + pa[6]*y + pa[10]*z + pa[14]*w;
+                pr[3] = 1;
+#endif
+            } // multiply_affine_4x1()
+
+
+            /// Transposes a column-major 4x4 float matrix.  The result may alias the source.
+            inline void transpose_4x4(const float *pa, float *pr)
+            {
+#ifdef GSGL_MATH_SSE
+                __m128 c0 = _mm_loadu_ps(pa + 0);
+                __m128 c1 = _mm_loadu_ps(pa + 4);
+                __m128 c2 = _mm_loadu_ps(pa + 8);
+                __m128 c3 = _mm_loadu_ps(pa + 12);
+                _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+                _mm_storeu_ps(pr + 0,  c0);
+                _mm_storeu_ps(pr + 4,  c1);
+                _mm_storeu_ps(pr + 8,  c2);
+                _mm_storeu_ps(pr + 12, c3);
+#else
+                float a[16];
+                for (int k = 0; k < 16; ++k)
+                    a[k] = pa[k];
+
+                for (int i = 0; i < 4; ++i)
+                    for (int j = 0; j < 4; ++j)
+                        pr[i*4+j] = a[j*4+i];
+#endif
+            } // transpose_4x4()
+
+
+            // The 4x4 float cases are picked by the template arguments, so existing callers get them without changes.
+
+            template <>
+            inline void multiply<4,4,4,4,float>(const matrix<4,4,float> & a, const matrix<4,4,float> & b, matrix<4,4,float> & result)
+            {
+                multiply_4x4(a.ptr(), b.ptr(), result.ptr());
+            } // multiply()
+
+
+            template <>
+            inline void multiply<4,4,4,1,float>(const matrix<4,4,float> & a, const matrix<4,1,float> & b, matrix<4,1,float> & result)
+            {
+                multiply_4x1(a.ptr(), b.ptr(), result.ptr());
+            } // multiply()
+
+
+            template <>
+            inline void transpose<4,4,float>(const matrix<4,4,float> & a, matrix<4,4,float> & result)
+            {
+                transpose_4x4(a.ptr(), result.ptr());
+            } // transpose()
+
         } // namespace matrix_utils
 
 
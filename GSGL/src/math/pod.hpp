@@ -1,3 +1,6 @@
+#ifndef GSGL_MATH_POD_H
+#define GSGL_MATH_POD_H
+
 //
 // $Id$
 //
@@ -31,63 +34,48 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //
 
-#include "platform/budget.hpp"
-
-#include "data/exception.hpp"
-#include "platform/lowlevel.hpp"
+#include "math/math.hpp"
 
 namespace gsgl
 {
 
-    using namespace data;
-
-    // global budget
-    platform::budget *platform::budget::instance = 0;
-
-    namespace platform
+    namespace math
     {
 
+        // Plain aggregates with the same memory layout as the math classes.  They have no constructors
+        // or virtual functions, so arrays of them are contiguous and can be memcpy'd, handed to GL, or
+        // loaded by the SIMD kernels directly.  The classes convert to and from these at no cost.
 
-        budget::budget()
-            : platform_object(), singleton<budget>()
+        /// A packed 3-d vector.
+        struct vec3
         {
-        } // budget::budget()
+            gsgl::real_t x, y, z;
+        }; // struct vec3
 
 
-        budget::~budget()
+        /// A packed homogeneous vector; the layout of math::vector.
+        struct vec4
         {
-        } // budget::~budget()
+            gsgl::real_t x, y, z, w;
+        }; // struct vec4
 
 
-        void budget::reset()
+        /// A packed 4x4 matrix in column-major order; the layout of math::transform.
+        struct mat4
         {
-            for (data::dictionary<unsigned int, string>::iterator i = data.iter(); i.is_valid(); ++i)
-            {
-                *i = 0;
-            }
-        } // budget::reset()
+            gsgl::real_t m[16];
+        }; // struct mat4
 
 
-        budget_record::budget_record(const string & category)
-            : parent(budget::global_instance()), category(category)
+        /// A packed quaternion w + xi + yj + zk; the layout of math::quaternion.
+        struct quat
         {
-#ifdef DEBUG
-            assert(parent);
-            start_tick = SDL_GetTicks();
-#endif
-        } // budget_record::budget_record()
+            double w, x, y, z;
+        }; // struct quat
 
 
-        budget_record::~budget_record()
-        {
-#ifdef DEBUG
-            unsigned int end_tick = SDL_GetTicks();
-            if (parent->global_instance())
-                parent->get_data()[category] += end_tick - start_tick;
-#endif
-        } // budget_record::~budget_record()
-
-
-    } // namespace platform
+    } // namespace math
 
 } // namespace gsgl
+
+#endif
@@ -41,6 +41,9 @@ namespace gsgl
 
     namespace math
     {
+
+        // quaternion must have no hidden members, so that arrays of it are arrays of quat
+        typedef char quaternion_layout_check[sizeof(quaternion) == sizeof(quat) ? 1 : -1];
     
         /// Creates a quaternion w + xi + yj + zk.
         quaternion::quaternion(const double w, const double x, const double y, const double z) 
@@ -62,14 +65,10 @@ namespace gsgl
         } // quaternion::quaternion()
         
 
-        /// Copy constructor; creates a copy of the given quaternion.
-        quaternion::quaternion(const quaternion & q)
-            : math_object()
+        /// Creates a quaternion from its packed form.
+        quaternion::quaternion(const quat & q)
+            : math_object(), w(q.w), x(q.x), y(q.y), z(q.z)
         {
-            x = q.x;
-            y = q.y;
-            z = q.z;
-            w = q.w;
         } // quaternion::quaternion()
 
 
@@ -164,22 +163,6 @@ namespace gsgl
             return *this;
         } // quaternion::quaternion()
 
-        
-        /// Assignment operator; sets the quaternion equal to the given quaternion.
-        quaternion & quaternion::operator= (const quaternion & q)
-        {
-            x = q.x;
-            y = q.y;
-            z = q.z;
-            w = q.w;
-            return *this;
-        } // quaternion::operator= ()
-
-        
-        quaternion::~quaternion()
-        {
-        } // quaternion::~quaternion()
-        
 
         //        
 
@@ -270,8 +253,14 @@ namespace gsgl
             double cos_angle = start.dot(end);
             assert(cos_angle < 1.1);
 
-            // use -q if necessary
-            quaternion end2 = cos_angle < 0 ? end*-1 : end;
+            // use -q if necessary (so we take the short way around)
+            quaternion end2 = end;
+
+            if (cos_angle < 0)
+            {
+                end2 = end * -1;
+                cos_angle = -cos_angle;
+            }
 
             // if quaternions are almost the same, use linear interpolation
             double s_start, s_end;
@@ -55,14 +55,16 @@ namespace gsgl
 
             quaternion(const double w = 0, const double x = 0, const double y = 0, const double z = 0);
             quaternion(const vector & v, double a);
-            quaternion(const quaternion &);
 
             explicit quaternion(const gsgl::string &);
             explicit quaternion(const transform &);
+            explicit quaternion(const quat &);
             
-            quaternion & operator= (const quaternion &);
             quaternion & operator= (const transform &);
-            virtual ~quaternion();
+
+            /// Returns the quaternion as a packed quat.
+            inline const quat & as_quat() const { return *reinterpret_cast<const quat *>(&w); }
+            inline quat & as_quat() { return *reinterpret_cast<quat *>(&w); }
             
             double norm() const;
             quaternion conjugate() const;
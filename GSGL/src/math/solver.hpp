@@ -35,6 +35,9 @@
 //
 
 #include "math/math.hpp"
+#include "data/array.hpp"
+
+#include <cmath>
 
 namespace gsgl
 {
@@ -49,6 +52,8 @@ namespace gsgl
         class solver
         {
         public:
+            virtual ~solver() {}
+
             virtual S next(const S & x, const double & t, const double & dt) = 0;
         }; // class solver
 
@@ -82,6 +87,534 @@ namespace gsgl
                 return x + (k1 + k2*2.0 + k3*2.0 + k4)*(dt/6.0);
             } // next()
         }; // class runge_kutta_solver
+
+
+        /// Dormand-Prince 5(4) solver with step size control and dense output.
+        /// next() takes as many sub-steps as it needs to keep the estimated error of each one within the tolerances, and remembers the step size for the next call.
+        /// State classes also need to implement norm() const, returning the magnitude of the state (e.g. its largest absolute component).
+        template <typename S>
+        class dormand_prince_solver
+            : public solver<S>
+        {
+            double rel_tol, abs_tol;
+            int max_steps;
+
+            double h;               ///< The size of the next step to try.
+            int num_evaluations;    ///< The number of derivative evaluations so far.
+
+            // the last accepted step, for dense output
+            double step_t, step_h;
+            S x0, x1, k1, k3, k4, k5, k6, k7;
+
+        public:
+            /// \param max_steps If a call to next() needs more than this many sub-steps, the last one covers the rest of the interval, regardless of its error.
+            dormand_prince_solver(const double & rel_tol = 1e-6, const double & abs_tol = 1e-6, const int max_steps = 1000)
+                : rel_tol(rel_tol), abs_tol(abs_tol), max_steps(max_steps), h(0), num_evaluations(0), step_t(0), step_h(0)
+            {
+            } // dormand_prince_solver()
+
+            int get_num_evaluations() const { return num_evaluations; }
+
+            S next(const S & x, const double & t, const double & dt)
+            {
+                if (dt == 0)
+                    return x;
+
+                const double dir = dt > 0 ? 1.0 : -1.0;
+                const double t_end = t + dt;
+
+                double cur_t = t;
+                S cur_x = x;
+                S f = cur_x.derivative(cur_t);
+                ++num_evaluations;
+
+                double size = h > 0 ? h : ::fabs(dt);
+
+                for (int steps = 1; ; ++steps)
+                {
+                    double remaining = (t_end - cur_t) * dir;
+                    if (remaining <= 0)
+                        break;
+
+                    bool last = size >= remaining;
+                    bool forced = steps >= max_steps;
+                    double cur_size = (last || forced) ? remaining : size;
+
+                    double err;
+                    S x_new = try_step(cur_x, f, cur_t, cur_size * dir, err);
+
+                    // 0.9 * err^(-1/5), kept within [0.2, 5]
+                    double factor = err > 0 ? 0.9 * ::pow(err, -0.2) : 5.0;
+                    if (factor < 0.2)
+                        factor = 0.2;
+                    else if (factor > 5.0)
+                        factor = 5.0;
+
+                    if (err <= 1.0 || forced)
+                    {
+                        cur_x = x_new;
+                        f = k7; // the last stage is evaluated at the new state, so it is the first stage of the next step
+
+                        // don't let a step that was cut short to end the interval shrink the next call's first step
+                        if (!forced)
+                            h = (last && size > cur_size * factor) ? size : cur_size * factor;
+
+                        if (last || forced)
+                            break;
+
+                        cur_t += cur_size * dir;
+                        size = cur_size * factor;
+                    }
+                    else
+                    {
+                        size = cur_size * factor;
+                    }
+                }
+
+                return cur_x;
+            } // next()
+
+            /// \return The state at time \c t, which should be within the last step taken by next().
+            S interpolate(const double & t) const
+            {
+                // Hairer's continuous extension for DOPRI5
+                const double d1 = -12715105075.0 / 11282082432.0;
+                const double d3 = 87487479700.0 / 32700410799.0;
+                const double d4 = -10690763975.0 / 1880347072.0;
+                const double d5 = 701980252875.0 / 199316789632.0;
+                const double d6 = -1453857185.0 / 822651844.0;
+                const double d7 = 69997945.0 / 29380423.0;
+
+                double theta = (t - step_t) / step_h;
+                double theta1 = 1.0 - theta;
+
+                S diff = x1 + x0*(-1.0);
+                S bspl = k1*step_h + diff*(-1.0);
+                S r4 = diff + k7*(-step_h) + bspl*(-1.0);
+                S r5 = (k1*d1 + k3*d3 + k4*d4 + k5*d5 + k6*d6 + k7*d7)*step_h;
+
+                return x0 + (diff + (bspl + (r4 + r5*theta1)*theta)*theta1)*theta;
+            } // interpolate()
+
+        private:
+            /// Takes a single step, and sets \c err to the ratio of the estimated error to the tolerance.
+            S try_step(const S & x, const S & f, const double & t, const double & dt, double & err)
+            {
+                k1 = f;
+                S k2 = (x + k1*(dt/5.0)).derivative(t + dt/5.0);
+                k3 = (x + k1*(dt*3.0/40.0) + k2*(dt*9.0/40.0)).derivative(t + dt*3.0/10.0);
+                k4 = (x + k1*(dt*44.0/45.0) + k2*(dt*-56.0/15.0) + k3*(dt*32.0/9.0)).derivative(t + dt*4.0/5.0);
+                k5 = (x + k1*(dt*19372.0/6561.0) + k2*(dt*-25360.0/2187.0) + k3*(dt*64448.0/6561.0) + k4*(dt*-212.0/729.0)).derivative(t + dt*8.0/9.0);
+                k6 = (x + k1*(dt*9017.0/3168.0) + k2*(dt*-355.0/33.0) + k3*(dt*46732.0/5247.0) + k4*(dt*49.0/176.0) + k5*(dt*-5103.0/18656.0)).derivative(t + dt);
+
+                S x_new = x + (k1*(35.0/384.0) + k3*(500.0/1113.0) + k4*(125.0/192.0) + k5*(-2187.0/6784.0) + k6*(11.0/84.0))*dt;
+                k7 = x_new.derivative(t + dt);
+                num_evaluations += 6;
+
+                // difference between the 5th and 4th order solutions
+                S e = (k1*(71.0/57600.0) + k3*(-71.0/16695.0) + k4*(71.0/1920.0) + k5*(-17253.0/339200.0) + k6*(22.0/525.0) + k7*(-1.0/40.0))*dt;
+
+                double scale = x.norm();
+                double new_scale = x_new.norm();
+                if (new_scale > scale)
+                    scale = new_scale;
+
+                err = e.norm() / (abs_tol + rel_tol * scale);
+
+                step_t = t;
+                step_h = dt;
+                x0 = x;
+                x1 = x_new;
+
+                return x_new;
+            } // try_step()
+        }; // class dormand_prince_solver
+
+
+        /// Second-order symplectic (kick-drift-kick leapfrog) solver, for systems whose positions and momenta can be advanced separately.
+        /// State classes need to implement drift(dt) const, which advances the positions using the momenta, and kick(t, dt) const, which advances the momenta using the forces at the positions.
+        template <typename S>
+        class leapfrog_solver
+            : public solver<S>
+        {
+        public:
+            S next(const S & x, const double & t, const double & dt)
+            {
+                S y = x.kick(t, dt*0.5);
+                y = y.drift(dt);
+                return y.kick(t + dt, dt*0.5);
+            } // next()
+        }; // class leapfrog_solver
+
+
+        /// Yoshida's fourth-order symplectic solver, made of three leapfrog steps.  See leapfrog_solver for what the state class needs.
+        template <typename S>
+        class yoshida_solver
+            : public solver<S>
+        {
+        public:
+            S next(const S & x, const double & t, const double & dt)
+            {
+                const double cbrt2 = 1.2599210498948731647672106;
+                const double w1 = 1.0 / (2.0 - cbrt2);
+                const double w0 = -cbrt2 / (2.0 - cbrt2);
+                const double c1 = w1 * 0.5, c2 = (w0 + w1) * 0.5;
+
+                double cur_t = t + c1*dt;
+                S y = x.drift(c1*dt);
+                y = y.kick(cur_t, w1*dt);
+
+                cur_t += c2*dt;
+                y = y.drift(c2*dt);
+                y = y.kick(cur_t, w0*dt);
+
+                cur_t += c2*dt;
+                y = y.drift(c2*dt);
+                y = y.kick(cur_t, w1*dt);
+
+                return y.drift(c1*dt);
+            } // next()
+        }; // class yoshida_solver
+
+
+        /// Splits each step into equal sub-steps no longer than a maximum size, for solvers with fixed steps.
+        /// Owns the solver it is given.
+        template <typename S>
+        class substep_solver
+            : public solver<S>
+        {
+            solver<S> *base;
+            double max_step;
+            int max_substeps;
+
+        public:
+            /// \param max_substeps If a step would need more sub-steps than this, the sub-steps are made longer than \c max_step.
+            substep_solver(solver<S> *base, const double & max_step, const int max_substeps = 1000)
+                : base(base), max_step(max_step), max_substeps(max_substeps)
+            {
+            } // substep_solver()
+
+            virtual ~substep_solver()
+            {
+                delete base;
+            } // ~substep_solver()
+
+            S next(const S & x, const double & t, const double & dt)
+            {
+                int n = static_cast<int>(::ceil(::fabs(dt) / max_step));
+                if (n < 1)
+                    n = 1;
+                else if (n > max_substeps)
+                    n = max_substeps;
+
+                double h = dt / n;
+                S y = x;
+                for (int i = 0; i < n; ++i)
+                    y = base->next(y, t + h*i, h);
+
+                return y;
+            } // next()
+
+        private:
+            /// You cannot copy substep solvers.
+            substep_solver(const substep_solver &);
+
+            /// You cannot copy substep solvers.
+            substep_solver & operator= (const substep_solver &);
+        }; // class substep_solver
+
+
+
+        //////////////////////////////////////////
+
+        /// Base class for solvers that advance a flat array of values in place, where the equation is x' = f(t, x).
+        /// System classes need to implement derivative(const double & t, const double *x, double *dxdt), which writes the derivatives of all \c n values.
+        /// Solvers keep their own scratch space, so once it has grown to the size of the state, a step makes no allocations or temporary states.
+        template <typename F>
+        class in_place_solver
+        {
+        public:
+            virtual ~in_place_solver() {}
+
+            virtual void step(F & system, double *x, const gsgl::index_t & n, const double & t, const double & dt) = 0;
+
+        protected:
+            /// \return Scratch space for \c num arrays of \c n values each.
+            static double *get_scratch(gsgl::data::simple_array<double> & scratch, const gsgl::index_t & n, const int num)
+            {
+                if (scratch.size() < n * num)
+                    scratch[n * num - 1] = 0; // item() grows the array to reach the index
+
+                return scratch.ptr();
+            } // get_scratch()
+        }; // class in_place_solver
+
+
+        /// Euler's method, in place.
+        template <typename F>
+        class in_place_euler_solver
+            : public in_place_solver<F>
+        {
+            gsgl::data::simple_array<double> scratch;
+
+        public:
+            void step(F & system, double *x, const gsgl::index_t & n, const double & t, const double & dt)
+            {
+                double *k = in_place_solver<F>::get_scratch(scratch, n, 1);
+
+                system.derivative(t, x, k);
+                for (gsgl::index_t i = 0; i < n; ++i)
+                    x[i] += k[i] * dt;
+            } // step()
+        }; // class in_place_euler_solver
+
+
+        /// The Runge-Kutta solver, in place.  Each stage's contribution is added to a running sum as soon as it is evaluated, so only three arrays of scratch space are needed.
+        template <typename F>
+        class in_place_runge_kutta_solver
+            : public in_place_solver<F>
+        {
+            gsgl::data::simple_array<double> scratch;
+
+        public:
+            void step(F & system, double *x, const gsgl::index_t & n, const double & t, const double & dt)
+            {
+                double *k = in_place_solver<F>::get_scratch(scratch, n, 3);
+                double *sum = k + n;
+                double *y = sum + n;
+
+                const double half = dt * 0.5;
+                gsgl::index_t i;
+
+                // k1
+                system.derivative(t, x, k);
+                for (i = 0; i < n; ++i)
+                {
+                    sum[i] = k[i];
+                    y[i] = x[i] + k[i] * half;
+                }
+
+                // k2
+                system.derivative(t + half, y, k);
+                for (i = 0; i < n; ++i)
+                {
+                    sum[i] += k[i] * 2.0;
+                    y[i] = x[i] + k[i] * half;
+                }
+
+                // k3
+                system.derivative(t + half, y, k);
+                for (i = 0; i < n; ++i)
+                {
+                    sum[i] += k[i] * 2.0;
+                    y[i] = x[i] + k[i] * dt;
+                }
+
+                // k4
+                system.derivative(t + dt, y, k);
+                for (i = 0; i < n; ++i)
+                    x[i] += (sum[i] + k[i]) * (dt / 6.0);
+            } // step()
+        }; // class in_place_runge_kutta_solver
+
+
+        /// The Dormand-Prince 5(4) solver, in place.  It controls its step size the same way as dormand_prince_solver, but has no dense output.
+        /// The magnitude of the state for the error estimate is its largest absolute value.
+        template <typename F>
+        class in_place_dormand_prince_solver
+            : public in_place_solver<F>
+        {
+            double rel_tol, abs_tol;
+            int max_steps;
+
+            double h;               ///< The size of the next step to try.
+            int num_evaluations;    ///< The number of derivative evaluations so far.
+
+            gsgl::data::simple_array<double> scratch;
+            double *k1, *k2, *k3, *k4, *k5, *k6, *k7; ///< The stages, in the scratch space.  k1 is the derivative at the start of the step.
+            double *y;      ///< The input to the next stage, and then the error estimate.
+            double *x_new;  ///< The state at the end of the trial step.
+
+        public:
+            /// \param max_steps If a call to step() needs more than this many sub-steps, the last one covers the rest of the interval, regardless of its error.
+            in_place_dormand_prince_solver(const double & rel_tol = 1e-6, const double & abs_tol = 1e-6, const int max_steps = 1000)
+                : rel_tol(rel_tol), abs_tol(abs_tol), max_steps(max_steps), h(0), num_evaluations(0),
+                  k1(0), k2(0), k3(0), k4(0), k5(0), k6(0), k7(0), y(0), x_new(0)
+            {
+            } // in_place_dormand_prince_solver()
+
+            int get_num_evaluations() const { return num_evaluations; }
+
+            void step(F & system, double *x, const gsgl::index_t & n, const double & t, const double & dt)
+            {
+                if (dt == 0)
+                    return;
+
+                k1 = in_place_solver<F>::get_scratch(scratch, n, 9);
+                k2 = k1 + n;
+                k3 = k2 + n;
+                k4 = k3 + n;
+                k5 = k4 + n;
+                k6 = k5 + n;
+                k7 = k6 + n;
+                y = k7 + n;
+                x_new = y + n;
+
+                const double dir = dt > 0 ? 1.0 : -1.0;
+                const double t_end = t + dt;
+
+                double cur_t = t;
+                system.derivative(cur_t, x, k1);
+                ++num_evaluations;
+
+                double size = h > 0 ? h : ::fabs(dt);
+
+                for (int steps = 1; ; ++steps)
+                {
+                    double remaining = (t_end - cur_t) * dir;
+                    if (remaining <= 0)
+                        break;
+
+                    bool last = size >= remaining;
+                    bool forced = steps >= max_steps;
+                    double cur_size = (last || forced) ? remaining : size;
+
+                    double err = try_step(system, x, n, cur_t, cur_size * dir);
+
+                    // 0.9 * err^(-1/5), kept within [0.2, 5]
+                    double factor = err > 0 ? 0.9 * ::pow(err, -0.2) : 5.0;
+                    if (factor < 0.2)
+                        factor = 0.2;
+                    else if (factor > 5.0)
+                        factor = 5.0;
+
+                    if (err <= 1.0 || forced)
+                    {
+                        for (gsgl::index_t i = 0; i < n; ++i)
+                            x[i] = x_new[i];
+
+                        // the last stage is evaluated at the new state, so it is the first stage of the next step
+                        double *tmp = k1;
+                        k1 = k7;
+                        k7 = tmp;
+
+                        // don't let a step that was cut short to end the interval shrink the next call's first step
+                        if (!forced)
+                            h = (last && size > cur_size * factor) ? size : cur_size * factor;
+
+                        if (last || forced)
+                            break;
+
+                        cur_t += cur_size * dir;
+                        size = cur_size * factor;
+                    }
+                    else
+                    {
+                        size = cur_size * factor;
+                    }
+                }
+            } // step()
+
+        private:
+            static double max_abs(const double *a, const gsgl::index_t & n)
+            {
+                double result = 0;
+                for (gsgl::index_t i = 0; i < n; ++i)
+                {
+                    double abs_a = ::fabs(a[i]);
+                    if (abs_a > result)
+                        result = abs_a;
+                }
+
+                return result;
+            } // max_abs()
+
+            /// Takes a single step from \c x into x_new, and returns the ratio of the estimated error to the tolerance.
+            double try_step(F & system, const double *x, const gsgl::index_t & n, const double & t, const double & dt)
+            {
+                gsgl::index_t i;
+
+                for (i = 0; i < n; ++i)
+                    y[i] = x[i] + k1[i]*(dt/5.0);
+                system.derivative(t + dt/5.0, y, k2);
+
+                for (i = 0; i < n; ++i)
+                    y[i] = x[i] + k1[i]*(dt*3.0/40.0) + k2[i]*(dt*9.0/40.0);
+                system.derivative(t + dt*3.0/10.0, y, k3);
+
+                for (i = 0; i < n; ++i)
+                    y[i] = x[i] + k1[i]*(dt*44.0/45.0) + k2[i]*(dt*-56.0/15.0) + k3[i]*(dt*32.0/9.0);
+                system.derivative(t + dt*4.0/5.0, y, k4);
+
+                for (i = 0; i < n; ++i)
+                    y[i] = x[i] + k1[i]*(dt*19372.0/6561.0) + k2[i]*(dt*-25360.0/2187.0) + k3[i]*(dt*64448.0/6561.0) + k4[i]*(dt*-212.0/729.0);
+                system.derivative(t + dt*8.0/9.0, y, k5);
+
+                for (i = 0; i < n; ++i)
+                    y[i] = x[i] + k1[i]*(dt*9017.0/3168.0) + k2[i]*(dt*-355.0/33.0) + k3[i]*(dt*46732.0/5247.0) + k4[i]*(dt*49.0/176.0) + k5[i]*(dt*-5103.0/18656.0);
+                system.derivative(t + dt, y, k6);
+
+                for (i = 0; i < n; ++i)
+                    x_new[i] = x[i] + (k1[i]*(35.0/384.0) + k3[i]*(500.0/1113.0) + k4[i]*(125.0/192.0) + k5[i]*(-2187.0/6784.0) + k6[i]*(11.0/84.0))*dt;
+                system.derivative(t + dt, x_new, k7);
+                num_evaluations += 6;
+
+                // difference between the 5th and 4th order solutions
+                for (i = 0; i < n; ++i)
+                    y[i] = (k1[i]*(71.0/57600.0) + k3[i]*(-71.0/16695.0) + k4[i]*(71.0/1920.0) + k5[i]*(-17253.0/339200.0) + k6[i]*(22.0/525.0) + k7[i]*(-1.0/40.0))*dt;
+
+                double scale = max_abs(x, n);
+                double new_scale = max_abs(x_new, n);
+                if (new_scale > scale)
+                    scale = new_scale;
+
+                return max_abs(y, n) / (abs_tol + rel_tol * scale);
+            } // try_step()
+        }; // class in_place_dormand_prince_solver
+
+
+        /// Splits each step into equal sub-steps no longer than a maximum size, for in-place solvers.
+        /// Owns the solver it is given.
+        template <typename F>
+        class in_place_substep_solver
+            : public in_place_solver<F>
+        {
+            in_place_solver<F> *base;
+            double max_step;
+            int max_substeps;
+
+        public:
+            /// \param max_substeps If a step would need more sub-steps than this, the sub-steps are made longer than \c max_step.
+            in_place_substep_solver(in_place_solver<F> *base, const double & max_step, const int max_substeps = 1000)
+                : base(base), max_step(max_step), max_substeps(max_substeps)
+            {
+            } // in_place_substep_solver()
+
+            virtual ~in_place_substep_solver()
+            {
+                delete base;
+            } // ~in_place_substep_solver()
+
+            void step(F & system, double *x, const gsgl::index_t & n, const double & t, const double & dt)
+            {
+                int num = static_cast<int>(::ceil(::fabs(dt) / max_step));
+                if (num < 1)
+                    num = 1;
+                else if (num > max_substeps)
+                    num = max_substeps;
+
+                double h = dt / num;
+                for (int i = 0; i < num; ++i)
+                    base->step(system, x, n, t + h*i, h);
+            } // step()
+
+        private:
+            /// You cannot copy substep solvers.
+            in_place_substep_solver(const in_place_substep_solver &);
+
+            /// You cannot copy substep solvers.
+            in_place_substep_solver & operator= (const in_place_substep_solver &);
+        }; // class in_place_substep_solver
         
 
     } // namespace math
@@ -44,6 +44,9 @@ namespace gsgl
 
     namespace math
     {
+
+        // transform must have no hidden members, so that arrays of it are arrays of mat4
+        typedef char transform_layout_check[sizeof(transform) == sizeof(mat4) ? 1 : -1];
     
         transform::transform() 
             : matrix<4,4,gsgl::real_t>()
@@ -57,8 +60,8 @@ namespace gsgl
         } // transform::transform()
         
 
-        transform::transform(const transform & t) 
-            : matrix<4,4,gsgl::real_t>(t)
+        transform::transform(const mat4 & m) 
+            : matrix<4,4,gsgl::real_t>(m.m)
         {
         } // transform::transform()
         
@@ -75,13 +78,6 @@ namespace gsgl
         } // transform::transform()
         
 
-        transform & transform::operator= (const transform & t)
-        {
-            ::memcpy(data, t.data, 16 * sizeof(gsgl::real_t));
-            return *this;
-        } // transform::operator= ()
-
-
         transform & transform::operator= (const matrix<4,4,gsgl::real_t> & m)
         {
             ::memcpy(data, m.ptr(), 16 * sizeof(gsgl::real_t));
@@ -114,11 +110,6 @@ namespace gsgl
             return *this;
         } // transform::operator= ()
 
-        
-        transform::~transform()
-        {
-        } // transform::~transform()
-        
 
         //
         
@@ -316,13 +307,17 @@ namespace gsgl
             return res;
         } // transform::inverse()
 
+
+        transform transform::rigid_inverse() const
+        {
+            return inverse_rigid(*this, translation_part());
+        } // transform::rigid_inverse()
+
         
         transform transform::transpose() const
         {
             transform res;
-            for (int i = 0; i < 4; ++i)
-                for (int j = 0; j < 4; ++j)
-                    res.item(i,j) = this->item(j,i);
+            matrix_utils::transpose<4,4,gsgl::real_t>(*this, res);
             return res;
         } // transform::transpose()
 
@@ -337,6 +332,42 @@ namespace gsgl
         } // transform::translation_transform()
 
 
+        transform transform::rigid(const transform & rotation, const vector & t)
+        {
+            transform res = IDENTITY;
+
+            memcpy(res.data + 0, rotation.data + 0, sizeof(gsgl::real_t) * 3);
+            memcpy(res.data + 4, rotation.data + 4, sizeof(gsgl::real_t) * 3);
+            memcpy(res.data + 8, rotation.data + 8, sizeof(gsgl::real_t) * 3);
+
+            res.data[12] = t.get_x();
+            res.data[13] = t.get_y();
+            res.data[14] = t.get_z();
+
+            return res;
+        } // transform::rigid()
+
+
+        transform transform::inverse_rigid(const transform & rotation, const vector & t)
+        {
+            transform res = IDENTITY;
+            const gsgl::real_t *r = rotation.data;
+
+            for (int i = 0; i < 3; ++i)
+            {
+                // the transpose of the rotation block...
+                res.data[i*4 + 0] = r[0*4 + i];
+                res.data[i*4 + 1] = r[1*4 + i];
+                res.data[i*4 + 2] = r[2*4 + i];
+
+                // ...applied to the negated translation
+                res.data[12 + i] = -(r[i*4 + 0] * t.get_x() + r[i*4 + 1] * t.get_y() + r[i*4 + 2] * t.get_z());
+            }
+
+            return res;
+        } // transform::inverse_rigid()
+
+
         transform transform::scale(const gsgl::real_t & s)
         {
             return scale(s, s, s);
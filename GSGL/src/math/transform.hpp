@@ -55,17 +55,18 @@ namespace gsgl
             transform();
             explicit transform(const gsgl::real_t *);
             explicit transform(const quaternion &);
-            transform(const transform &);
+            explicit transform(const mat4 &);
             transform(const matrix<4,4,gsgl::real_t> &);
 
-            transform & operator= (const transform &);
             transform & operator= (const matrix<4,4,gsgl::real_t> &);
             transform & operator= (const quaternion &);
             
-            virtual ~transform();
-            
             //
 
+            /// Returns the transform's data as a packed mat4.
+            inline const mat4 & as_mat4() const { return *reinterpret_cast<const mat4 *>(data); }
+            inline mat4 & as_mat4() { return *reinterpret_cast<mat4 *>(data); }
+
             inline const gsgl::real_t & operator[] (const gsgl::index_t & i) const { return data[i]; }
             inline gsgl::real_t & operator[] (const gsgl::index_t & i) { return data[i]; }
 
@@ -85,6 +86,10 @@ namespace gsgl
             transform transpose() const;
             transform inverse() const;
 
+            /// Returns the inverse of a rigid transform (a rotation followed by a translation).
+            /// This is much cheaper than inverse(), but gives wrong results for transforms with scaling or projection.
+            transform rigid_inverse() const;
+
             vector    translation_part() const;
             transform rotation_part() const;
 
@@ -98,6 +103,22 @@ namespace gsgl
                 return res;
             } // operator * ()
 
+            /// Transforms a point by an affine transform (one whose bottom row is 0 0 0 1), skipping the homogeneous divide.
+            inline vector transform_point(const vector & v) const
+            {
+                vector res;
+                matrix_utils::multiply_affine_4x1(data, v.get_x(), v.get_y(), v.get_z(), 1, res.ptr());
+                return res;
+            } // transform_point()
+
+            /// Transforms a direction by an affine transform; the translation part is ignored.
+            inline vector transform_direction(const vector & v) const
+            {
+                vector res;
+                matrix_utils::multiply_affine_4x1(data, v.get_x(), v.get_y(), v.get_z(), 0, res.ptr());
+                return res;
+            } // transform_direction()
+
             inline transform operator* (const transform & t) const
             {
                 transform res;
@@ -109,6 +130,12 @@ namespace gsgl
             
             static transform parse(const gsgl::string &);
             static transform translation_transform(const vector &);
+
+            /// Returns translation_transform(t) * rotation, without the multiplication.  Only the upper 3x3 block of rotation is used.
+            static transform rigid(const transform & rotation, const vector & t);
+
+            /// Returns rotation.transpose() * translation_transform(-t), the inverse of rigid(rotation, t), without the multiplication.
+            static transform inverse_rigid(const transform & rotation, const vector & t);
             
             static transform scale(const gsgl::real_t & s);
             static transform scale(const gsgl::real_t &, const gsgl::real_t &, const gsgl::real_t &);
@@ -44,6 +44,9 @@ namespace gsgl
 
     namespace math
     {
+
+        // vector must have no hidden members, so that arrays of it are arrays of vec4
+        typedef char vector_layout_check[sizeof(vector) == sizeof(vec4) ? 1 : -1];
     
         const vector vector::ZERO(0, 0, 0);
         const vector vector::X_AXIS(1, 0, 0);
@@ -67,23 +70,28 @@ namespace gsgl
         {
         } // vector::vector()
         
-        vector::vector(const vector & v) 
-            : matrix<4,1,gsgl::real_t>(v)
-        {
-        } // vector::vector()
-        
         vector::vector(const matrix<4,1,gsgl::real_t> & v) 
             : matrix<4,1,gsgl::real_t>(v)
         {
             if (data[3] != static_cast<gsgl::real_t>(1))
                 normalize_h();
         } // vector::vector()
-        
-        vector & vector::operator= (const vector & v)
+
+        vector::vector(const vec3 & v)
+            : matrix<4,1,gsgl::real_t>()
         {
-            ::memcpy(data, v.data, sizeof(gsgl::real_t) * 4);
-            return *this;
-        } // vector::operator= ()
+            data[0] = v.x;
+            data[1] = v.y;
+            data[2] = v.z;
+            data[3] = 1;
+        } // vector::vector()
+
+        vector::vector(const vec4 & v)
+            : matrix<4,1,gsgl::real_t>(&v.x)
+        {
+            if (data[3] != static_cast<gsgl::real_t>(1))
+                normalize_h();
+        } // vector::vector()
         
         vector & vector::operator= (const matrix<4,1,gsgl::real_t> & m)
         {
@@ -91,10 +99,6 @@ namespace gsgl
             return *this;
         } // vector::operator= ()
         
-        vector::~vector()
-        {
-        } // vector::~vector()
-        
         vector::vector(const string & s) 
             : matrix<4,1,gsgl::real_t>()
         {
@@ -125,7 +129,7 @@ namespace gsgl
         void vector::normalize_h()
         {
             gsgl::real_t m = data[3];
-            if (m > 0)
+            if (m > 0 && m != 1)
             {
                 data[0] /= m;
                 data[1] /= m;
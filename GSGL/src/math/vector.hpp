@@ -36,6 +36,7 @@
 
 #include "math/math.hpp"
 #include "math/matrix.hpp"
+#include "math/pod.hpp"
 
 namespace gsgl
 {
@@ -55,15 +56,18 @@ namespace gsgl
         {
         public:
             vector(gsgl::real_t x = 0, gsgl::real_t y = 0, gsgl::real_t z = 0);
-            vector(const vector &);
             vector(const matrix<4,1,gsgl::real_t> &);
+            explicit vector(const vec3 &);
+            explicit vector(const vec4 &);
 
             explicit vector(const gsgl::real_t *);
             explicit vector(const gsgl::string &);
             
-            vector & operator= (const vector &);
             vector & operator= (const matrix<4,1,gsgl::real_t> &);
-            virtual ~vector();
+
+            /// Returns the vector's data as a packed vec4.
+            inline const vec4 & as_vec4() const { return *reinterpret_cast<const vec4 *>(data); }
+            inline vec4 & as_vec4() { return *reinterpret_cast<vec4 *>(data); }
                         
             inline const gsgl::real_t & get_x() const { return data[0]; }
             inline const gsgl::real_t & get_y() const { return data[1]; }
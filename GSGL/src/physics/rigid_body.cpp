@@ -32,6 +32,12 @@
 //
 
 #include "physics/rigid_body.hpp"
+#include "physics/rigid_body_system.hpp"
+
+#include "data/exception.hpp"
+#include "data/config.hpp"
+
+#include <cmath>
 
 namespace gsgl
 {
@@ -87,11 +93,12 @@ namespace gsgl
             rigid_body_state result;
             result.parent_body = parent_body;
             
+            parent_body->stage_position = x;
             parent_body->calculate_force_and_torque(t, parent_body->force, parent_body->torque);
             result.x = parent_body->mass_inverse * p;
 
             vector w = parent_body->j_inverse * L;
-            result.q = (quaternion(w.get_w(), w.get_x(), w.get_y(), w.get_z()) * q) * 0.5f;
+            result.q = (quaternion(0, w.get_x(), w.get_y(), w.get_z()) * q) * 0.5f;
 
             result.p = parent_body->force;
             result.L = parent_body->torque;
@@ -100,26 +107,157 @@ namespace gsgl
         } // rigid_body_state::derivative()
 
 
+        rigid_body_state rigid_body_state::drift(const double & dt) const
+        {
+            rigid_body_state result = *this;
+            result.x = x + p * static_cast<gsgl::real_t>(parent_body->mass_inverse * dt);
+
+            // rotate by the angular velocity in this state's orientation
+            transform r(q);
+            vector w = (r * parent_body->jbody_inverse * r.transpose()) * L;
+            gsgl::real_t w_mag = w.mag();
+
+            if (w_mag > 0)
+            {
+                result.q = quaternion(w / w_mag, w_mag * dt) * q;
+                result.q.normalize();
+            }
+
+            return result;
+        } // rigid_body_state::drift()
+
+
+        rigid_body_state rigid_body_state::kick(const double & t, const double & dt) const
+        {
+            rigid_body_state result = *this;
+
+            parent_body->stage_position = x;
+            parent_body->calculate_force_and_torque(t, parent_body->force, parent_body->torque);
+            result.p = p + parent_body->force * static_cast<gsgl::real_t>(dt);
+            result.L = L + parent_body->torque * static_cast<gsgl::real_t>(dt);
+
+            return result;
+        } // rigid_body_state::kick()
+
+
+        void rigid_body_state::to_array(double *a) const
+        {
+            a[0] = x.get_x();   a[1] = x.get_y();   a[2] = x.get_z();
+            a[3] = q.w;         a[4] = q.x;         a[5] = q.y;         a[6] = q.z;
+            a[7] = p.get_x();   a[8] = p.get_y();   a[9] = p.get_z();
+            a[10] = L.get_x();  a[11] = L.get_y();  a[12] = L.get_z();
+        } // rigid_body_state::to_array()
+
+
+        void rigid_body_state::from_array(const double *a)
+        {
+            x = vector(static_cast<gsgl::real_t>(a[0]), static_cast<gsgl::real_t>(a[1]), static_cast<gsgl::real_t>(a[2]));
+            q = quaternion(a[3], a[4], a[5], a[6]);
+            p = vector(static_cast<gsgl::real_t>(a[7]), static_cast<gsgl::real_t>(a[8]), static_cast<gsgl::real_t>(a[9]));
+            L = vector(static_cast<gsgl::real_t>(a[10]), static_cast<gsgl::real_t>(a[11]), static_cast<gsgl::real_t>(a[12]));
+        } // rigid_body_state::from_array()
+
+
 
         //
 
+        static config_variable<string> SOLVER(L"physics/rigid_body/solver", L"dopri5");                  ///< One of dopri5, rk4, euler, leapfrog or yoshida.
+        static config_variable<gsgl::real_t> TOLERANCE(L"physics/rigid_body/tolerance", 1e-6f);        ///< Relative and absolute error tolerance for dopri5.
+        static config_variable<gsgl::real_t> MAX_STEP(L"physics/rigid_body/max_step", 0.02f);         ///< Longest sub-step (in seconds) for the fixed-step solvers.
+        static config_variable<int> MAX_SUBSTEPS(L"physics/rigid_body/max_substeps", 1000);          ///< Most sub-steps any solver takes in one update.
+        static config_variable<int> BATCH(L"physics/rigid_body/batch", 0);                           ///< Integrate rigid bodies together in the global rigid_body_system.
+
+
+        rigid_body::rigid_body(const string & name, scenegraph::node *parent)
+            : physics_frame(name, parent), 
+              center_of_mass(vector::ZERO), mass(1), mass_inverse(1),
+              jbody(transform::IDENTITY), jbody_inverse(transform::IDENTITY), in_system(false)
+        {
+            create_solver();
+        } // rigid_body::rigid_body()
+
+
         rigid_body::rigid_body(const config_record & obj_config)
             : physics_frame(obj_config), 
               center_of_mass(vector::ZERO), mass(1), mass_inverse(1),
-              jbody(transform::IDENTITY), jbody_inverse(transform::IDENTITY)
+              jbody(transform::IDENTITY), jbody_inverse(transform::IDENTITY), in_system(false)
         {
-            motion_solver = new runge_kutta_solver<rigid_body_state>();
-            //motion_solver = new euler_solver<rigid_body_state>();
-
-            cur_state.parent_body = this;
+            create_solver();
         } // rigid_body::rigid_body()
 
 
         rigid_body::~rigid_body()
         {
+            if (in_system)
+            {
+                rigid_body_system *system = rigid_body_system::global_instance();
+                system->remove(this);
+
+                if (system->size() == 0)
+                    delete system;
+            }
+
+            delete motion_solver;
+            delete in_place_motion_solver;
         } // rigid_body::~rigid_body()
 
 
+        void rigid_body::create_solver()
+        {
+            const string & name = SOLVER.get_value();
+
+            motion_solver = 0;
+            in_place_motion_solver = 0;
+
+            if (name == L"dopri5")
+                in_place_motion_solver = new in_place_dormand_prince_solver<rigid_body>(TOLERANCE, TOLERANCE, MAX_SUBSTEPS);
+            else if (name == L"rk4")
+                in_place_motion_solver = new in_place_substep_solver<rigid_body>(new in_place_runge_kutta_solver<rigid_body>(), MAX_STEP, MAX_SUBSTEPS);
+            else if (name == L"euler")
+                in_place_motion_solver = new in_place_substep_solver<rigid_body>(new in_place_euler_solver<rigid_body>(), MAX_STEP, MAX_SUBSTEPS);
+            else if (name == L"leapfrog")
+                motion_solver = new substep_solver<rigid_body_state>(new leapfrog_solver<rigid_body_state>(), MAX_STEP, MAX_SUBSTEPS);
+            else if (name == L"yoshida")
+                motion_solver = new substep_solver<rigid_body_state>(new yoshida_solver<rigid_body_state>(), MAX_STEP, MAX_SUBSTEPS);
+            else
+                throw runtime_exception(L"Unknown rigid body solver '%ls'.", name.w_string());
+
+            cur_state.parent_body = this;
+        } // rigid_body::create_solver()
+
+
+        void rigid_body::derivative(const double & t, const double *state, double *dstate)
+        {
+            stage_position = vector(static_cast<gsgl::real_t>(state[0]), static_cast<gsgl::real_t>(state[1]), static_cast<gsgl::real_t>(state[2]));
+            calculate_force_and_torque(t, force, torque);
+
+            // x' = p / m
+            dstate[0] = mass_inverse * state[7];
+            dstate[1] = mass_inverse * state[8];
+            dstate[2] = mass_inverse * state[9];
+
+            // q' = (0, w) q / 2, where w = J^-1 L
+            double wx = j_inverse.item(0, 0)*state[10] + j_inverse.item(0, 1)*state[11] + j_inverse.item(0, 2)*state[12];
+            double wy = j_inverse.item(1, 0)*state[10] + j_inverse.item(1, 1)*state[11] + j_inverse.item(1, 2)*state[12];
+            double wz = j_inverse.item(2, 0)*state[10] + j_inverse.item(2, 1)*state[11] + j_inverse.item(2, 2)*state[12];
+
+            const double *q = state + 3;
+            dstate[3] = 0.5 * (-wx*q[1] - wy*q[2] - wz*q[3]);
+            dstate[4] = 0.5 * ( wx*q[0] + wy*q[3] - wz*q[2]);
+            dstate[5] = 0.5 * ( wy*q[0] + wz*q[1] - wx*q[3]);
+            dstate[6] = 0.5 * ( wz*q[0] + wx*q[2] - wy*q[1]);
+
+            // p' = F, L' = torque
+            dstate[7] = force.get_x();
+            dstate[8] = force.get_y();
+            dstate[9] = force.get_z();
+
+            dstate[10] = torque.get_x();
+            dstate[11] = torque.get_y();
+            dstate[12] = torque.get_z();
+        } // rigid_body::derivative()
+
+
         /// \todo When saving, make sure to account for the center of mass...
         void rigid_body::init(const gsgl::scenegraph::simulation_context *c)
         {
@@ -143,16 +281,47 @@ namespace gsgl
             cur_state.q = get_orientation();
             
             R = get_orientation();
-            cur_state.L = (R * jbody_inverse * R.transpose()).inverse() * get_angular_velocity();
+            // (R * jbody_inverse * R^T)^-1 == R * jbody * R^T, since R is a rotation
+            cur_state.L = (R * jbody * R.transpose()) * get_angular_velocity();
 
             compute_derived_quantities();
+
+            if (BATCH && !in_system)
+            {
+                if (!rigid_body_system::global_instance())
+                    new rigid_body_system();
+
+                rigid_body_system::global_instance()->add(this);
+                in_system = true;
+            }
         } // rigid_body::init()
 
 
         void rigid_body::update(const gsgl::scenegraph::simulation_context *c)
         {
+            // the system has already moved us this tick
+            if (in_system)
+                return;
+
             // calculate next state
-            cur_state = motion_solver->next(cur_state, c->cur_time, c->delta_time);
+            if (in_place_motion_solver)
+            {
+                double state[rigid_body_state::FLAT_SIZE];
+                cur_state.to_array(state);
+                in_place_motion_solver->step(*this, state, rigid_body_state::FLAT_SIZE, c->cur_time, c->delta_time);
+                cur_state.from_array(state);
+            }
+            else
+            {
+                cur_state = motion_solver->next(cur_state, c->cur_time, c->delta_time);
+            }
+
+            apply_state();
+        } // rigid_body::update()
+
+
+        void rigid_body::apply_state()
+        {
             compute_derived_quantities();
 
             // set scenegraph variables
@@ -160,7 +329,7 @@ namespace gsgl
             get_orientation() = R;
             get_linear_velocity() = v;
             get_angular_velocity() = w;
-        } // rigid_body::update()
+        } // rigid_body::apply_state()
 
 
         void rigid_body::compute_derived_quantities()
@@ -49,6 +49,7 @@ namespace gsgl
     {
 
         class rigid_body;
+        class rigid_body_system;
 
 
         struct PHYSICS_API rigid_body_state
@@ -66,6 +67,21 @@ namespace gsgl
             rigid_body_state operator+ (const rigid_body_state & s) const;
             rigid_body_state operator* (const double & n) const;
             rigid_body_state derivative(const double & t) const;
+
+            /// Advances the position and orientation by the current momenta, for the symplectic solvers.
+            rigid_body_state drift(const double & dt) const;
+
+            /// Advances the momenta by the force and torque at time \c t, for the symplectic solvers.
+            rigid_body_state kick(const double & t, const double & dt) const;
+
+            /// The number of values in the flat form of the state: x, q (w first), p and L.
+            enum { FLAT_SIZE = 13 };
+
+            /// Writes the state into \c a, which must hold FLAT_SIZE values.
+            void to_array(double *a) const;
+
+            /// Reads the state from \c a, which must hold FLAT_SIZE values.
+            void from_array(const double *a);
         }; // class rigid_body_state
 
 
@@ -93,11 +109,17 @@ namespace gsgl
 
             // computed quantities
             math::vector force, torque;
+            math::vector stage_position; ///< The position of the center of mass at which calculate_force_and_torque() is being called, which differs from cur_state.x during a step.
 
-            // differential equation solver
+            // differential equation solver (only one of these is used)
             math::solver<rigid_body_state> *motion_solver;
+            math::in_place_solver<rigid_body> *in_place_motion_solver;
+
+            bool in_system; ///< Whether the body is integrated by the global rigid_body_system, rather than on its own.
+            friend class rigid_body_system;
 
         public:
+            rigid_body(const gsgl::string & name, gsgl::scenegraph::node *parent);
             rigid_body(const data::config_record & obj_config);
             virtual ~rigid_body();
 
@@ -108,11 +130,19 @@ namespace gsgl
             /// \note Forces & torques are in world coordinates, and the time is in UNIX time (seconds)!
             virtual void calculate_force_and_torque(const double & t, math::vector & force, math::vector & torque) = 0;
 
+            /// Writes the derivative of a flat state (see rigid_body_state::to_array()) at time \c t, for the in-place solvers.
+            void derivative(const double & t, const double *state, double *dstate);
+
             // node implementation
             virtual void init(const gsgl::scenegraph::simulation_context *);
             virtual void update(const gsgl::scenegraph::simulation_context *c);
 
+        protected:
+            /// Sets the derived quantities and the scene graph variables from the current state.
+            void apply_state();
+
         private:
+            void create_solver();
             void compute_derived_quantities();
         }; // class rigid_body
 
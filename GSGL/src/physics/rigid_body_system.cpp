@@ -0,0 +1,215 @@
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "physics/rigid_body_system.hpp"
+#include "data/config.hpp"
+
+namespace gsgl
+{
+
+    using namespace data;
+    using namespace math;
+
+    // global rigid body system
+    physics::rigid_body_system *physics::rigid_body_system::instance = 0;
+
+    namespace physics
+    {
+
+        static config_variable<gsgl::real_t> MAX_STEP(L"physics/rigid_body_system/max_step", 0.02f);   ///< Longest sub-step (in seconds).
+        static config_variable<int> MAX_SUBSTEPS(L"physics/rigid_body_system/max_substeps", 1000);   ///< Most sub-steps in one update.
+
+
+        /// \return A pointer to at least \c n values in the array.
+        static double *get_values(simple_array<double> & a, const gsgl::index_t & n)
+        {
+            if (a.size() < n)
+                a[n - 1] = 0;
+
+            return a.ptr();
+        } // get_values()
+
+
+        //
+
+        rigid_body_system::rigid_body_system()
+            : singleton<rigid_body_system>(),
+              solver(new in_place_substep_solver<rigid_body_system>(new in_place_runge_kutta_solver<rigid_body_system>(), MAX_STEP, MAX_SUBSTEPS))
+        {
+            scenegraph::simulation::add_tick_listener(this);
+        } // rigid_body_system::rigid_body_system()
+
+
+        rigid_body_system::~rigid_body_system()
+        {
+            scenegraph::simulation::remove_tick_listener(this);
+
+            for (gsgl::index_t i = 0; i < bodies.size(); ++i)
+                bodies[i]->in_system = false;
+
+            delete solver;
+        } // rigid_body_system::~rigid_body_system()
+
+
+        void rigid_body_system::add(rigid_body *body)
+        {
+            assert(body);
+            bodies.append(body);
+        } // rigid_body_system::add()
+
+
+        void rigid_body_system::remove(rigid_body *body)
+        {
+            for (gsgl::index_t i = 0; i < bodies.size(); ++i)
+            {
+                if (bodies[i] == body)
+                {
+                    bodies.remove(i);
+                    return;
+                }
+            }
+        } // rigid_body_system::remove()
+
+
+        void rigid_body_system::pre_update(const gsgl::scenegraph::simulation_context *c)
+        {
+            step(c->cur_time, c->delta_time);
+        } // rigid_body_system::pre_update()
+
+
+        void rigid_body_system::step(const double & t, const double & dt)
+        {
+            const gsgl::index_t n = bodies.size();
+            if (n == 0)
+                return;
+
+            double *x = get_values(state, n * rigid_body_state::FLAT_SIZE);
+            double *mi = get_values(mass_inverse, n);
+            double *ji = get_values(j_inverse, n * 9);
+            get_values(force_torque, n * 6);
+
+            // gather
+            double body_state[rigid_body_state::FLAT_SIZE];
+            gsgl::index_t i;
+            int c;
+
+            for (i = 0; i < n; ++i)
+            {
+                rigid_body *body = bodies[i];
+
+                body->cur_state.to_array(body_state);
+                for (c = 0; c < rigid_body_state::FLAT_SIZE; ++c)
+                    x[c*n + i] = body_state[c];
+
+                mi[i] = body->mass_inverse;
+
+                for (c = 0; c < 9; ++c)
+                    ji[c*n + i] = body->j_inverse.item(c / 3, c % 3);
+            }
+
+            solver->step(*this, x, n * rigid_body_state::FLAT_SIZE, t, dt);
+
+            // scatter
+            for (i = 0; i < n; ++i)
+            {
+                rigid_body *body = bodies[i];
+
+                for (c = 0; c < rigid_body_state::FLAT_SIZE; ++c)
+                    body_state[c] = x[c*n + i];
+
+                body->cur_state.from_array(body_state);
+                body->apply_state();
+            }
+        } // rigid_body_system::step()
+
+
+        void rigid_body_system::derivative(const double & t, const double *x, double *dxdt)
+        {
+            const gsgl::index_t n = bodies.size();
+            const double *mi = mass_inverse.ptr();
+            const double *ji = j_inverse.ptr();
+            double *ft = force_torque.ptr();
+
+            gsgl::index_t i;
+
+            // forces and torques come from each body
+            vector force, torque;
+            for (i = 0; i < n; ++i)
+            {
+                bodies[i]->stage_position = vector(static_cast<gsgl::real_t>(x[0*n + i]), static_cast<gsgl::real_t>(x[1*n + i]), static_cast<gsgl::real_t>(x[2*n + i]));
+                bodies[i]->calculate_force_and_torque(t, force, torque);
+
+                ft[0*n + i] = force.get_x();
+                ft[1*n + i] = force.get_y();
+                ft[2*n + i] = force.get_z();
+                ft[3*n + i] = torque.get_x();
+                ft[4*n + i] = torque.get_y();
+                ft[5*n + i] = torque.get_z();
+            }
+
+            // x' = p / m
+            for (int c = 0; c < 3; ++c)
+            {
+                const double *p = x + (7 + c)*n;
+                double *dx = dxdt + c*n;
+
+                for (i = 0; i < n; ++i)
+                    dx[i] = mi[i] * p[i];
+            }
+
+            // q' = (0, w) q / 2, where w = J^-1 L
+            const double *qw = x + 3*n, *qx = x + 4*n, *qy = x + 5*n, *qz = x + 6*n;
+            const double *lx = x + 10*n, *ly = x + 11*n, *lz = x + 12*n;
+            double *dqw = dxdt + 3*n, *dqx = dxdt + 4*n, *dqy = dxdt + 5*n, *dqz = dxdt + 6*n;
+
+            for (i = 0; i < n; ++i)
+            {
+                double wx = ji[0*n + i]*lx[i] + ji[1*n + i]*ly[i] + ji[2*n + i]*lz[i];
+                double wy = ji[3*n + i]*lx[i] + ji[4*n + i]*ly[i] + ji[5*n + i]*lz[i];
+                double wz = ji[6*n + i]*lx[i] + ji[7*n + i]*ly[i] + ji[8*n + i]*lz[i];
+
+                dqw[i] = 0.5 * (-wx*qx[i] - wy*qy[i] - wz*qz[i]);
+                dqx[i] = 0.5 * ( wx*qw[i] + wy*qz[i] - wz*qy[i]);
+                dqy[i] = 0.5 * ( wy*qw[i] + wz*qx[i] - wx*qz[i]);
+                dqz[i] = 0.5 * ( wz*qw[i] + wx*qy[i] - wy*qx[i]);
+            }
+
+            // p' = F, L' = torque
+            for (i = 0; i < n * 6; ++i)
+                dxdt[7*n + i] = ft[i];
+        } // rigid_body_system::derivative()
+
+
+    } // namespace physics
+
+} // namespace gsgl
@@ -0,0 +1,95 @@
+#ifndef GSGL_PHYSICS_RIGID_BODY_SYSTEM_H
+#define GSGL_PHYSICS_RIGID_BODY_SYSTEM_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "physics/physics.hpp"
+#include "physics/rigid_body.hpp"
+
+#include "data/singleton.hpp"
+#include "data/array.hpp"
+#include "math/solver.hpp"
+#include "scenegraph/context.hpp"
+#include "scenegraph/simulation.hpp"
+
+namespace gsgl
+{
+
+    namespace physics
+    {
+
+        /// Integrates many rigid bodies together.
+        /// The bodies' states are gathered into one structure-of-arrays state (all the bodies' x positions, then all their y positions, and so on), 
+        /// which is stepped by a single in-place solver, so each stage of the step is a few long loops over all the bodies.
+        /// When physics/rigid_body/batch is set, rigid bodies join the global instance as they are initialized, creating it if need be, and it is deleted when the last one leaves.
+        /// It steps its bodies at the start of each tick, before the scene graph is updated.
+        class PHYSICS_API rigid_body_system
+            : public data::singleton<rigid_body_system>, public gsgl::scenegraph::tick_listener
+        {
+            data::simple_array<rigid_body *> bodies;
+
+            /// \name Structure-of-arrays state and per-step constants.
+            /// Component \c c of body \c i is at <tt>[c * n + i]</tt>, where \c n is the number of bodies.
+            /// @{
+            data::simple_array<double> state;
+            data::simple_array<double> mass_inverse;
+            data::simple_array<double> j_inverse;       ///< The bodies' inverse inertia tensors (in world coordinates) at the start of the step, row by row.
+            data::simple_array<double> force_torque;    ///< Scratch space for the forces and torques at each stage.
+            /// @}
+
+            math::in_place_solver<rigid_body_system> *solver;
+
+        public:
+            rigid_body_system();
+            virtual ~rigid_body_system();
+
+            void add(rigid_body *body);
+            void remove(rigid_body *body);
+            gsgl::index_t size() const { return bodies.size(); }
+
+            /// Steps all the bodies by the context's time step, and sets their scene graph variables.
+            virtual void pre_update(const gsgl::scenegraph::simulation_context *c);
+
+            /// Steps all the bodies from \c t to <tt>t + dt</tt>, and sets their scene graph variables.
+            void step(const double & t, const double & dt);
+
+            /// Writes the derivative of the structure-of-arrays state, for the solver.
+            void derivative(const double & t, const double *x, double *dxdt);
+        }; // class rigid_body_system
+
+    } // namespace physics
+
+} // namespace gsgl
+
+#endif
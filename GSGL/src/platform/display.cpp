@@ -34,6 +34,8 @@
 #include "platform/display.hpp"
 #include "platform/lowlevel.hpp"
 #include "platform/extensions.hpp"
+#include "platform/job_scheduler.hpp"
+#include "math/batch.hpp"
 
 #include <cmath>
 
@@ -739,12 +741,51 @@ namespace gsgl
                 gsgl::real_t wx = text_draw_viewport[0] + text_draw_viewport[2]*(p_in_clip_space.get_x() + 1)/2;
                 gsgl::real_t wy = text_draw_viewport[1] + text_draw_viewport[3]*(p_in_clip_space.get_y() + 1)/2;
 
-                if (wx >= -100 && wx < parent.surface->w && wy >= -10 && wy < parent.surface->h+10)
-                    draw_2d(wx + x_offset, wy + y_offset, f, str);
+                draw_projected(wx, wy, f, str, x_offset, y_offset);
             }
         } // display::scoped_text::draw_3d()
 
 
+        /// Below this many labels, projecting them on the calling thread is quicker than handing them to the job scheduler.
+        static const gsgl::index_t MIN_PARALLEL_LABELS = 8192;
+
+        void display::scoped_text::draw_3d(const gsgl::index_t count, const gsgl::real_t *x, const gsgl::real_t *y, const gsgl::real_t *z, 
+                                           const font *f, const gsgl::string * const *strs, const gsgl::real_t & x_offset, const gsgl::real_t & y_offset)
+        {
+            if (count <= 0)
+                return;
+
+            // writing past the end grows the scratch arrays
+            screen_x[count - 1] = 0;
+            screen_y[count - 1] = 0;
+            screen_depth[count - 1] = 0;
+
+            batch::project_to_screen_range body = { &text_draw_pm, text_draw_viewport, x, y, z, screen_x.ptr(), screen_y.ptr(), screen_depth.ptr() };
+
+            job_scheduler *jobs = job_scheduler::global_instance();
+            if (jobs && count >= MIN_PARALLEL_LABELS)
+                parallel_for(*jobs, 0, count, body);
+            else
+                body(0, count);
+
+            parent.bind();
+
+            // a depth of 0.5 is a normalized z of 0, which is what the single-point version tests
+            for (gsgl::index_t i = 0; i < count; ++i)
+            {
+                if (screen_depth[i] >= 0.5f)
+                    draw_projected(screen_x[i], screen_y[i], f, *strs[i], x_offset, y_offset);
+            }
+        } // display::scoped_text::draw_3d()
+
+
+        void display::scoped_text::draw_projected(const gsgl::real_t & wx, const gsgl::real_t & wy, const font *f, const gsgl::string & str, const gsgl::real_t & x_offset, const gsgl::real_t & y_offset)
+        {
+            if (wx >= -100 && wx < parent.surface->w && wy >= -10 && wy < parent.surface->h+10)
+                draw_2d(wx + x_offset, wy + y_offset, f, str);
+        } // display::scoped_text::draw_projected()
+
+
     } // namespace platform
     
 } // namespace gsgl
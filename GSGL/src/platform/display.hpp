@@ -43,6 +43,7 @@
 #include "platform/vbuffer.hpp"
 
 #include "data/config.hpp"
+#include "data/array.hpp"
 #include "math/math.hpp"
 #include "math/transform.hpp"
 
@@ -319,6 +320,8 @@ namespace gsgl
                 math::transform text_draw_projection;
                 math::transform text_draw_pm;
 
+                gsgl::data::simple_array<gsgl::real_t> screen_x, screen_y, screen_depth; ///< Scratch space for projecting batches of labels.
+
             public:
                 scoped_text(display & parent);
                 ~scoped_text();
@@ -328,6 +331,14 @@ namespace gsgl
 
                 /// Draws text at the given world coordinates.
                 void draw_3d(const math::vector & p, const font *f, const gsgl::string & str, const gsgl::real_t & x_offset = 0, const gsgl::real_t & y_offset = 0);
+
+                /// Draws a label at each of count world coordinates, given as separate x, y and z arrays.
+                /// The points are projected together with math::batch::project_to_screen(), across the job scheduler if there are many of them.
+                void draw_3d(const gsgl::index_t count, const gsgl::real_t *x, const gsgl::real_t *y, const gsgl::real_t *z, 
+                             const font *f, const gsgl::string * const *strs, const gsgl::real_t & x_offset = 0, const gsgl::real_t & y_offset = 0);
+
+            private:
+                void draw_projected(const gsgl::real_t & wx, const gsgl::real_t & wy, const font *f, const gsgl::string & str, const gsgl::real_t & x_offset, const gsgl::real_t & y_offset);
             }; // class scoped_text
 
             /// \}
@@ -47,7 +47,7 @@ namespace gsgl
             : width(width), height(height), data(data), own_pointer(!data)
         {
             if (!data)
-                data = new gsgl::real_t[width*height];
+                this->data = new gsgl::real_t[width*height];
         } // heightmap::heightmap()
 
 
@@ -0,0 +1,392 @@
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "platform/job_scheduler.hpp"
+#include "data/exception.hpp"
+
+#include <cstring>
+
+namespace gsgl
+{
+
+    using namespace data;
+
+    // global job scheduler
+    platform::job_scheduler *platform::job_scheduler::instance = 0;
+
+    namespace platform
+    {
+
+        /// The scheduler and worker index of the current thread, if it is a worker.
+        static GSGL_THREAD_LOCAL job_scheduler *current_scheduler = 0;
+        static GSGL_THREAD_LOCAL int current_worker = -1;
+
+        /// How long a thread waiting on a group sleeps before looking for jobs to help with again.
+        static const unsigned int WAIT_POLL_MS = 1;
+
+
+        //////////////////////////////////////////////////////////////
+
+        /// A double-ended queue of jobs.  The owning worker pushes and pops at the bottom; other threads steal from the top.
+        class job_queue
+        {
+            mutex m;
+
+            job **jobs;
+            gsgl::index_t capacity, top, count;
+
+        public:
+            job_queue() : jobs(0), capacity(0), top(0), count(0) {}
+            ~job_queue() { delete [] jobs; }
+
+            bool might_have_jobs() const { return count != 0; } ///< Only a hint; the queue may change before the caller looks again.
+
+            void push(job *j)
+            {
+                m.lock();
+
+                if (count == capacity)
+                {
+                    gsgl::index_t new_capacity = capacity ? capacity * 2 : 64;
+                    job **new_jobs = new job *[new_capacity];
+
+                    for (gsgl::index_t i = 0; i < count; ++i)
+                        new_jobs[i] = jobs[(top + i) % capacity];
+
+                    delete [] jobs;
+                    jobs = new_jobs;
+                    capacity = new_capacity;
+                    top = 0;
+                }
+
+                jobs[(top + count) % capacity] = j;
+                ++count;
+
+                m.unlock();
+            } // push()
+
+            job *pop()
+            {
+                job *j = 0;
+                m.lock();
+
+                if (count)
+                    j = jobs[(top + --count) % capacity];
+
+                m.unlock();
+                return j;
+            } // pop()
+
+            job *steal()
+            {
+                job *j = 0;
+                m.lock();
+
+                if (count)
+                {
+                    j = jobs[top];
+                    top = (top + 1) % capacity;
+                    --count;
+                }
+
+                m.unlock();
+                return j;
+            } // steal()
+        }; // class job_queue
+
+
+        //////////////////////////////////////////////////////////////
+
+        class job_worker
+            : public thread
+        {
+            job_scheduler *scheduler;
+            const int index;
+
+        public:
+            job_worker(job_scheduler *scheduler, const int index) : thread(), scheduler(scheduler), index(index) {}
+
+        protected:
+            virtual int run()
+            {
+                current_scheduler = scheduler;
+                current_worker = index;
+
+                while (!scheduler->shutting_down)
+                {
+                    if (!scheduler->run_one(index))
+                        scheduler->wait_for_work();
+                }
+
+                return 0;
+            } // run()
+        }; // class job_worker
+
+
+        //////////////////////////////////////////////////////////////
+
+        job_group::job_group(job_scheduler & scheduler)
+            : scheduler(scheduler), pending(0), continuation(0)
+        {
+        } // job_group::job_group()
+
+
+        job_group::~job_group()
+        {
+            wait();
+        } // job_group::~job_group()
+
+
+        void job_group::run(job *j)
+        {
+            if (!j)
+                throw internal_exception(__FILE__, __LINE__, L"Null job.");
+
+            add_pending();
+            j->group = this;
+            scheduler.submit(j);
+        } // job_group::run()
+
+
+        void job_group::then(job *cont, job_group *continuation_group)
+        {
+            if (!cont)
+                throw internal_exception(__FILE__, __LINE__, L"Null continuation.");
+
+            if (continuation_group)
+                continuation_group->add_pending();
+            cont->group = continuation_group;
+
+            m.lock();
+            bool run_now = pending == 0;
+
+            if (!run_now)
+            {
+                if (continuation)
+                {
+                    m.unlock();
+                    throw internal_exception(__FILE__, __LINE__, L"A job group can only have one continuation at a time.");
+                }
+
+                continuation = cont;
+            }
+            m.unlock();
+
+            if (run_now)
+                scheduler.submit(cont);
+        } // job_group::then()
+
+
+        void job_group::wait()
+        {
+            scheduler.wait_for(*this);
+        } // job_group::wait()
+
+
+        bool job_group::is_done()
+        {
+            m.lock();
+            bool done = pending == 0;
+            m.unlock();
+
+            return done;
+        } // job_group::is_done()
+
+
+        void job_group::add_pending()
+        {
+            m.lock();
+            ++pending;
+            m.unlock();
+        } // job_group::add_pending()
+
+
+        /// Once the count reaches zero a waiting thread may destroy the group, so nothing here touches the group after unlocking.
+        void job_group::job_finished()
+        {
+            job_scheduler *s = &scheduler;
+            job *cont = 0;
+
+            m.lock();
+            bool done = --pending == 0;
+            if (done)
+            {
+                cont = continuation;
+                continuation = 0;
+            }
+            m.unlock();
+
+            if (done)
+            {
+                if (cont)
+                    s->submit(cont);
+                s->notify_group_done();
+            }
+        } // job_group::job_finished()
+
+
+        //////////////////////////////////////////////////////////////
+
+        job_scheduler::job_scheduler(int num_workers)
+            : singleton<job_scheduler>(), num_workers(num_workers > 0 ? num_workers : thread::get_num_processors()),
+              queues(0), workers(0), num_queued(0), num_sleeping(0), shutting_down(false)
+        {
+            queues = new job_queue[this->num_workers + 1];
+            workers = new job_worker *[this->num_workers];
+
+            for (int i = 0; i < this->num_workers; ++i)
+                workers[i] = new job_worker(this, i);
+            for (int i = 0; i < this->num_workers; ++i)
+                workers[i]->start();
+        } // job_scheduler::job_scheduler()
+
+
+        job_scheduler::~job_scheduler()
+        {
+            sleep_mutex.lock();
+            shutting_down = true;
+            work_available.broadcast();
+            sleep_mutex.unlock();
+
+            for (int i = 0; i < num_workers; ++i)
+            {
+                workers[i]->wait();
+                delete workers[i];
+            }
+
+            delete [] workers;
+            delete [] queues;
+        } // job_scheduler::~job_scheduler()
+
+
+        void job_scheduler::submit(job *j)
+        {
+            // workers push onto their own queue, everyone else onto the shared one
+            int index = (current_scheduler == this) ? current_worker : num_workers;
+            queues[index].push(j);
+
+            atomic_increment(&num_queued);
+
+            if (num_sleeping)
+            {
+                sleep_mutex.lock();
+                work_available.signal();
+                sleep_mutex.unlock();
+            }
+        } // job_scheduler::submit()
+
+
+        /// Finds a job and runs it: first from the worker's own queue, then from the shared queue, then by stealing from the other workers.
+        /// \return False if there was nothing to do.
+        bool job_scheduler::run_one(const int worker_index)
+        {
+            job *j = 0;
+
+            if (worker_index >= 0)
+                j = queues[worker_index].pop();
+
+            if (!j)
+                j = queues[num_workers].steal();
+
+            for (int i = 1; !j && i <= num_workers; ++i)
+            {
+                int victim = (worker_index + i + num_workers) % num_workers;
+
+                if (victim != worker_index && queues[victim].might_have_jobs())
+                    j = queues[victim].steal();
+            }
+
+            if (!j)
+                return false;
+
+            atomic_decrement(&num_queued);
+            execute(j);
+
+            return true;
+        } // job_scheduler::run_one()
+
+
+        void job_scheduler::execute(job *j)
+        {
+            job_group *group = j->group;
+
+            j->execute();
+
+            if (group)
+                group->job_finished();
+        } // job_scheduler::execute()
+
+
+        void job_scheduler::wait_for(job_group & group)
+        {
+            int worker_index = (current_scheduler == this) ? current_worker : -1;
+
+            while (!group.is_done())
+            {
+                if (run_one(worker_index))
+                    continue;
+
+                // nothing to help with, so wait for a group to finish (or a while, in case more jobs show up)
+                sleep_mutex.lock();
+                if (!group.is_done())
+                    group_done.wait(sleep_mutex, WAIT_POLL_MS);
+                sleep_mutex.unlock();
+            }
+        } // job_scheduler::wait_for()
+
+
+        /// Puts a worker to sleep until there is work.  The sleeper count is raised before the queues are checked, and submit() raises the job count before checking the sleepers, so a wakeup can't be missed.
+        void job_scheduler::wait_for_work()
+        {
+            sleep_mutex.lock();
+            atomic_increment(&num_sleeping);
+
+            if (num_queued == 0 && !shutting_down)
+                work_available.wait(sleep_mutex);
+
+            atomic_decrement(&num_sleeping);
+            sleep_mutex.unlock();
+        } // job_scheduler::wait_for_work()
+
+
+        void job_scheduler::notify_group_done()
+        {
+            sleep_mutex.lock();
+            group_done.broadcast();
+            sleep_mutex.unlock();
+        } // job_scheduler::notify_group_done()
+
+
+    } // namespace platform
+
+} // namespace gsgl
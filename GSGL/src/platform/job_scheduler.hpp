@@ -0,0 +1,213 @@
+#ifndef GSGL_PLATFORM_JOB_SCHEDULER_H
+#define GSGL_PLATFORM_JOB_SCHEDULER_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "platform/platform.hpp"
+#include "platform/thread.hpp"
+#include "data/singleton.hpp"
+#include "data/pointer.hpp"
+
+namespace gsgl
+{
+
+    namespace platform
+    {
+
+        class job_group;
+        class job_scheduler;
+        class job_queue;
+        class job_worker;
+
+
+        /// A piece of work that can run on any of the job scheduler's threads.
+        /// The scheduler never deletes jobs; whoever runs a job must keep it alive until its group is done.
+        /// Jobs must not let exceptions escape from execute().
+        class PLATFORM_API job
+        {
+            job_group *group;
+
+        public:
+            job() : group(0) {}
+            virtual ~job() {}
+
+            virtual void execute() = 0;
+
+            friend class job_group;
+            friend class job_scheduler;
+        }; // class job
+
+
+        /// A set of jobs that can be waited on together, and optionally followed by a continuation.
+        class PLATFORM_API job_group
+        {
+            job_scheduler & scheduler;
+
+            mutex m;
+            gsgl::index_t pending;
+
+            job *continuation;
+
+        public:
+            job_group(job_scheduler & scheduler);
+            ~job_group(); ///< Waits for any jobs that are still running.
+
+            /// Schedules a job as part of this group.
+            void run(job *);
+
+            /// Schedules a job to run once every job in this group has finished.
+            /// If continuation_group is given, the continuation counts as part of it from now on, so waiting on continuation_group waits for the continuation as well.
+            void then(job *continuation, job_group *continuation_group = 0);
+
+            /// Waits for every job in the group to finish.  The calling thread runs queued jobs while it waits.
+            void wait();
+
+            bool is_done();
+
+        private:
+            void add_pending();
+            void job_finished();
+
+            friend class job_scheduler;
+        }; // class job_group
+
+
+        /// A work-stealing job scheduler.
+        /// Each worker thread has its own queue of jobs; it runs the newest jobs from its own queue first, and steals the oldest jobs from other queues when its own is empty.
+        /// Jobs submitted from threads that are not workers go into a shared queue.  Nothing here needs a display, so the scheduler can be used by command-line tools.
+        class PLATFORM_API job_scheduler
+            : public gsgl::data::singleton<job_scheduler>
+        {
+            int num_workers;
+            job_queue *queues;      ///< One for each worker, then one for jobs from other threads.
+            job_worker **workers;
+
+            mutex sleep_mutex;
+            condition work_available, group_done;
+
+            volatile long num_queued;
+            volatile long num_sleeping;
+            volatile bool shutting_down;
+
+        public:
+            /// Starts num_workers worker threads; if num_workers is 0, one per processor.
+            job_scheduler(int num_workers = 0);
+
+            /// Stops the worker threads.  All job groups should have been waited on by this point.
+            virtual ~job_scheduler();
+
+            int get_num_workers() const { return num_workers; }
+
+        private:
+            void submit(job *);
+            bool run_one(const int worker_index);
+            void execute(job *);
+            void wait_for(job_group & group);
+            void wait_for_work();
+            void notify_group_done();
+
+            friend class job_group;
+            friend class job_worker;
+        }; // class job_scheduler
+
+
+        //////////////////////////////////////////////////////////////
+
+        /// Used by parallel_for() to run one chunk of an index range.
+        template <typename Body>
+        class parallel_for_job
+            : public job
+        {
+        public:
+            const Body *body;
+            gsgl::index_t begin, end;
+
+            parallel_for_job() : job(), body(0), begin(0), end(0) {}
+
+            virtual void execute() { (*body)(begin, end); }
+        }; // class parallel_for_job
+
+
+        /// Calls body(chunk_begin, chunk_end) for consecutive chunks of [begin, end), in parallel.
+        /// Body must have a const member operator() (gsgl::index_t, gsgl::index_t) that is safe to call concurrently on disjoint ranges.
+        /// If grain_size is 0, the range is split into a few chunks per worker; otherwise it is split into chunks of grain_size.
+        template <typename Body>
+        void parallel_for(job_scheduler & scheduler, const gsgl::index_t begin, const gsgl::index_t end, const Body & body, gsgl::index_t grain_size = 0)
+        {
+            if (end <= begin)
+                return;
+
+            gsgl::index_t total = end - begin;
+
+            if (grain_size <= 0)
+            {
+                gsgl::index_t max_chunks = scheduler.get_num_workers() * 4;
+                grain_size = max_chunks ? (total + max_chunks - 1) / max_chunks : total;
+            }
+
+            gsgl::index_t num_chunks = (total + grain_size - 1) / grain_size;
+
+            if (num_chunks < 2 || scheduler.get_num_workers() == 0)
+            {
+                body(begin, end);
+                return;
+            }
+
+            // the group must be destroyed (which waits) before the jobs are
+            data::smart_pointer<parallel_for_job<Body>, true> jobs(new parallel_for_job<Body>[num_chunks]);
+            job_group group(scheduler);
+
+            parallel_for_job<Body> *chunks = jobs.ptr();
+
+            for (gsgl::index_t i = 0; i < num_chunks; ++i)
+            {
+                chunks[i].body = &body;
+                chunks[i].begin = begin + i * grain_size;
+                chunks[i].end = (i == num_chunks - 1) ? end : chunks[i].begin + grain_size;
+            }
+
+            // the calling thread does the first chunk itself
+            for (gsgl::index_t i = 1; i < num_chunks; ++i)
+                group.run(&chunks[i]);
+
+            chunks[0].execute();
+            group.wait();
+        } // parallel_for()
+
+
+    } // namespace platform
+
+} // namespace gsgl
+
+#endif
@@ -38,6 +38,16 @@
 
 #include "platform/lowlevel.hpp"
 
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <climits>
+#endif
 
 namespace gsgl
 {
@@ -57,15 +67,22 @@ namespace gsgl
 
             return res;
         }
+#else
+        static string get_posix_error()
+        {
+            return string(::strerror(errno));
+        }
 #endif
 
 
 
+#ifdef WIN32
         static int NUM_MAPPED_FILES = 0;
+#endif
 
 
         mapped_file::mapped_file(const string & fname, unsigned int io_open_mode, unsigned int create_size)
-            : file_handle(0), map_handle(0), map_pointer(0)
+            : file_handle(0), map_handle(0), map_pointer(0), map_size(0), writable((io_open_mode & io::FILE_OPEN_WRITE) != 0)
         {
 #ifdef WIN32
             string full_path = io::file::get_full_path(fname);
@@ -129,7 +146,59 @@ namespace gsgl
 
             map_size = create_size;
 #else
-#error Implement memory-mapped files!
+            // open the file; the descriptor can be closed as soon as the mapping exists
+            int fd = ::open(fname.c_string(), writable ? O_RDWR : O_RDONLY);
+
+            if (fd < 0 && errno == ENOENT)
+            {
+                if (create_size == 0)
+                    throw internal_exception(__FILE__, __LINE__, L"Must specify size for creating memory-mapped files.");
+
+                fd = ::open(fname.c_string(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+                if (fd >= 0 && ::ftruncate(fd, create_size) != 0)
+                {
+                    string err = get_posix_error();
+                    ::close(fd);
+                    throw io_exception(L"Unable to size %ls: %ls", fname.w_string(), err.w_string());
+                }
+            }
+
+            if (fd < 0)
+                throw io_exception(L"Unable to open %ls: %ls", fname.w_string(), get_posix_error().w_string());
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0)
+            {
+                string err = get_posix_error();
+                ::close(fd);
+                throw io_exception(L"Unable to get the size of %ls: %ls", fname.w_string(), err.w_string());
+            }
+
+            if (static_cast<unsigned long long>(st.st_size) > UINT_MAX)
+            {
+                ::close(fd);
+                throw io_exception(L"%ls is too large to be memory-mapped.", fname.w_string());
+            }
+
+            map_size = static_cast<unsigned int>(st.st_size);
+
+            // map file (an empty file has nothing to map)
+            if (map_size)
+            {
+                void *ptr = ::mmap(0, map_size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+
+                if (ptr == MAP_FAILED)
+                {
+                    string err = get_posix_error();
+                    ::close(fd);
+                    throw io_exception(L"Unable to create memory map for %ls: %ls", fname.w_string(), err.w_string());
+                }
+
+                map_pointer = ptr;
+            }
+
+            ::close(fd);
 #endif
         } // mapped_file::mapped_file()
 
@@ -155,23 +224,63 @@ namespace gsgl
                 file_handle = 0;
             }
 #else
-#error Implement memory-mapped files!
+            if (map_pointer)
+            {
+                ::munmap(map_pointer, map_size);
+                map_pointer = 0;
+            }
 #endif
         } // mapped_file::~mapped_file()
 
 
-        unsigned int mapped_file::get_size()
+        unsigned int mapped_file::get_size() const
         {
             return map_size;
         } // mapped_file::get_size()
 
 
-        void *mapped_file::get_pointer()
+        void *mapped_file::get_pointer() const
         {
             return map_pointer;
         } // mapped_file::get_pointer()
 
 
+        void mapped_file::advise(const access_pattern pattern, const unsigned int offset, const unsigned int num_bytes)
+        {
+#ifndef WIN32
+            if (!map_pointer || offset >= map_size)
+                return;
+
+            unsigned int len = (num_bytes && num_bytes < map_size - offset) ? num_bytes : map_size - offset;
+
+            // madvise() wants a page-aligned start
+            unsigned int page_size = static_cast<unsigned int>(::sysconf(_SC_PAGESIZE));
+            unsigned int start = offset - (offset % page_size);
+            len += offset - start;
+
+            int advice;
+            switch (pattern)
+            {
+            case ACCESS_SEQUENTIAL:
+                advice = MADV_SEQUENTIAL;
+                break;
+            case ACCESS_RANDOM:
+                advice = MADV_RANDOM;
+                break;
+            case ACCESS_WILLNEED:
+                advice = MADV_WILLNEED;
+                break;
+            default:
+                advice = MADV_NORMAL;
+                break;
+            }
+
+            // this is only a hint, so failure isn't an error
+            ::madvise(static_cast<char *>(map_pointer) + start, len, advice);
+#endif
+        } // mapped_file::advise()
+
+
     } // namespace platform
 
 } // namespace gsgl
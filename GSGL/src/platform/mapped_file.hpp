@@ -36,6 +36,7 @@
 
 #include "platform/platform.hpp"
 #include "data/fstream.hpp"
+#include "data/exception.hpp"
 
 namespace gsgl
 {
@@ -45,19 +46,82 @@ namespace gsgl
     namespace platform
     {
 
+        /// A window onto part of a memory-mapped file, treated as an array of T.
+        /// T should be a plain data type laid out the way it was written.  Use a const T for files that are mapped read-only.
+        /// The view does not own its memory; it is only valid while the mapped_file it came from is alive.
+        template <typename T>
+        class mapped_view
+        {
+            T *data;
+            gsgl::index_t count;
+
+        public:
+            mapped_view() : data(0), count(0) {}
+            mapped_view(T *data, const gsgl::index_t count) : data(data), count(count) {}
+
+            gsgl::index_t size() const { return count; }
+            bool is_empty() const { return count == 0; }
+
+            T *ptr() const { return data; }
+            T *begin() const { return data; }
+            T *end() const { return data + count; }
+
+            T & operator[] (const gsgl::index_t i) const
+            {
+                assert(i >= 0 && i < count);
+                return data[i];
+            }
+
+            /// \return A view on count elements starting at element start.
+            mapped_view subview(const gsgl::index_t start, const gsgl::index_t num) const
+            {
+                if (start < 0 || num < 0 || start + num > count)
+                    throw internal_exception(__FILE__, __LINE__, L"Sub-view [%d, %d) is outside a view of size %d.", start, start + num, count);
+
+                return mapped_view(data + start, num);
+            }
+        }; // class mapped_view
+
+
+        /// A file mapped into memory.
+        /// Loaders can parse large files straight out of the mapped pages with get_view() instead of copying them through a stream.
         class PLATFORM_API mapped_file
         {
             void *file_handle, *map_handle;
             void *map_pointer;
 
             unsigned int map_size;
+            bool writable;
 
         public:
+            /// Hints about how the mapping will be read, so the OS can read ahead or not.
+            enum access_pattern
+            {
+                ACCESS_NORMAL,
+                ACCESS_SEQUENTIAL,  ///< The range will be read from front to back, once.
+                ACCESS_RANDOM,      ///< The range will be read in no particular order; read-ahead is wasted.
+                ACCESS_WILLNEED     ///< The range will be needed soon; start reading it in now.
+            };
+
             mapped_file(const gsgl::string & fname, unsigned int io_open_mode = io::FILE_OPEN_READ, unsigned int create_size = 0);
             ~mapped_file();
 
-            unsigned int get_size();
-            void *get_pointer();
+            unsigned int get_size() const;
+            void *get_pointer() const;
+            bool is_writable() const { return writable; }
+
+            /// Passes an access hint for num_bytes bytes starting at offset to the OS (the whole file if num_bytes is 0).  Does nothing where the OS has no such call.
+            void advise(const access_pattern pattern, const unsigned int offset = 0, const unsigned int num_bytes = 0);
+
+            /// \return A view of num elements of type T, starting offset bytes into the file.  Throws an io_exception if the view doesn't fit in the file.
+            template <typename T>
+            mapped_view<T> get_view(const unsigned int offset, const gsgl::index_t num) const
+            {
+                if (num < 0 || offset > map_size || (map_size - offset) / sizeof(T) < static_cast<unsigned int>(num))
+                    throw io_exception(L"A view of %d elements at offset %u does not fit in a mapped file of %u bytes.", num, offset, map_size);
+
+                return mapped_view<T>(reinterpret_cast<T *>(static_cast<unsigned char *>(map_pointer) + offset), num);
+            }
         }; // class mapped_file
 
 
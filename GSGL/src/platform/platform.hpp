@@ -48,6 +48,13 @@
 #endif
 
 
+#ifdef WIN32
+#define GSGL_THREAD_LOCAL __declspec(thread)
+#else
+#define GSGL_THREAD_LOCAL __thread
+#endif
+
+
 namespace gsgl
 {
 
@@ -0,0 +1,407 @@
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "platform/profiler.hpp"
+
+#include "data/exception.hpp"
+#include "data/fstream.hpp"
+#include "platform/lowlevel.hpp"
+
+#include <cstring>
+
+#ifndef WIN32
+#include <time.h>
+#endif
+
+namespace gsgl
+{
+
+    using namespace data;
+    using namespace io;
+
+    // global profiler
+    platform::profiler *platform::profiler::instance = 0;
+
+    namespace platform
+    {
+
+        /// The number of scopes a thread can have open at once; scopes nested deeper than this are not recorded.
+        static const int MAX_DEPTH = 64;
+
+        /// The number of closed scopes a thread can hold until end_frame() collects them; any more are dropped.
+        static const unsigned long BUFFER_SIZE = 1 << 14;
+
+        static const unsigned long long NS_PER_SEC = 1000000000;
+
+
+        struct profile_event
+        {
+            int scope;
+            unsigned long long start_ns;
+            unsigned long long duration_ns;
+            unsigned long long exclusive_ns;
+        }; // struct profile_event
+
+
+        /// The scopes recorded by one thread.  Closed scopes go into a ring buffer that only the owning thread writes and only end_frame() reads, so neither side needs a lock.
+        class profiler_buffer
+        {
+        public:
+            struct open_scope
+            {
+                int scope;
+                unsigned long long start_ns;
+                unsigned long long child_ns;
+            }; // struct open_scope
+
+            const int thread_index;
+            bool in_use;
+
+            int depth;
+            open_scope stack[MAX_DEPTH];
+
+            profile_event events[BUFFER_SIZE];
+            volatile unsigned long write_pos; ///< Only written by the owning thread.
+            volatile unsigned long read_pos;  ///< Only written by end_frame().
+
+            profiler_buffer(const int thread_index) 
+                : thread_index(thread_index), in_use(true), depth(0), write_pos(0), read_pos(0) 
+            {
+            }
+        }; // class profiler_buffer
+
+
+        /// Guards the scope names and the list of buffers.
+        static mutex registry_lock;
+
+        static char *scope_names[profiler::MAX_SCOPES];
+        static volatile int num_scopes = 0;
+
+        static simple_array<profiler_buffer *> buffers;
+        static GSGL_THREAD_LOCAL profiler_buffer *current_buffer = 0;
+
+        volatile bool profiler::enabled = true;
+
+
+        //////////////////////////////////////////////////////////////
+
+        profiler::profiler()
+            : platform_object(), singleton<profiler>(), 
+              frame_start_ns(get_time_ns()), frame_ns(0), capturing(false), capture_start_ns(0)
+        {
+            ::memset(frame_totals, 0, sizeof(frame_totals));
+        } // profiler::profiler()
+
+
+        profiler::~profiler()
+        {
+        } // profiler::~profiler()
+
+
+        void profiler::end_frame()
+        {
+            unsigned long long now = get_time_ns();
+            frame_ns = now - frame_start_ns;
+            frame_start_ns = now;
+
+            ::memset(frame_totals, 0, sizeof(frame_totals));
+
+            registry_lock.lock();
+            for (int i = 0; i < buffers.size(); ++i)
+                collect(buffers[i]);
+            registry_lock.unlock();
+        } // profiler::end_frame()
+
+
+        void profiler::collect(profiler_buffer *buffer)
+        {
+            unsigned long end = buffer->write_pos;
+            acquire_barrier();
+
+            for (unsigned long pos = buffer->read_pos; pos != end; ++pos)
+            {
+                const profile_event & e = buffer->events[pos % BUFFER_SIZE];
+
+                scope_totals & totals = frame_totals[e.scope];
+                totals.inclusive_ns += e.duration_ns;
+                totals.exclusive_ns += e.exclusive_ns;
+                ++totals.count;
+
+                if (capturing && capture.size() < MAX_CAPTURE_EVENTS)
+                {
+                    trace_event te;
+                    te.scope = e.scope;
+                    te.thread = buffer->thread_index;
+                    te.start_ns = e.start_ns;
+                    te.duration_ns = e.duration_ns;
+
+                    capture.append(te);
+                }
+            }
+
+            release_barrier();
+            buffer->read_pos = end;
+        } // profiler::collect()
+
+
+        //////////////////////////////////////////////////////////////
+
+        void profiler::start_capture()
+        {
+            capture.clear();
+            capture_start_ns = get_time_ns();
+            capturing = true;
+        } // profiler::start_capture()
+
+
+        /// Scope names come from type names and string literals, but escape them anyway.
+        static string json_string(const char *str)
+        {
+            string result(L"\"");
+
+            for (const char *ch = str; *ch; ++ch)
+            {
+                if (*ch == '"' || *ch == '\\')
+                    result.append(L'\\');
+                result.append(static_cast<wchar_t>(static_cast<unsigned char>(*ch)));
+            }
+
+            result.append(L'"');
+            return result;
+        } // json_string()
+
+
+        void profiler::stop_capture(const string & fname)
+        {
+            capturing = false;
+
+            ft_stream out(fname, FILE_OPEN_WRITE | FILE_OPEN_TEXT);
+            out << L"{\"traceEvents\":[\n";
+
+            for (int i = 0; i < capture.size(); ++i)
+            {
+                const trace_event & e = capture[i];
+                double start_us = static_cast<double>(static_cast<long long>(e.start_ns - capture_start_ns)) / 1000.0;
+                double duration_us = static_cast<double>(e.duration_ns) / 1000.0;
+
+                out << string::format(L"%ls{\"name\":%ls,\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}\n", 
+                                      i ? L"," : L"", json_string(scope_names[e.scope]).w_string(), e.thread, start_us, duration_us).w_string();
+            }
+
+            out << L"],\"displayTimeUnit\":\"ms\"}\n";
+
+            capture.clear();
+        } // profiler::stop_capture()
+
+
+        //////////////////////////////////////////////////////////////
+
+        int profiler::register_scope(const char *name)
+        {
+            int scope;
+
+            registry_lock.lock();
+
+            for (scope = 0; scope < num_scopes; ++scope)
+            {
+                if (::strcmp(scope_names[scope], name) == 0)
+                    break;
+            }
+
+            if (scope == num_scopes)
+            {
+                if (num_scopes == MAX_SCOPES)
+                {
+                    registry_lock.unlock();
+                    throw internal_exception(__FILE__, __LINE__, L"Too many profiler scopes.");
+                }
+
+                scope_names[scope] = new char[::strlen(name) + 1];
+                ::strcpy(scope_names[scope], name);
+
+                memory_barrier();
+                ++num_scopes;
+            }
+
+            registry_lock.unlock();
+            return scope;
+        } // profiler::register_scope()
+
+
+        int profiler::register_scope(const string & name)
+        {
+            return register_scope(name.c_string());
+        } // profiler::register_scope()
+
+
+        int profiler::get_num_scopes()
+        {
+            return num_scopes;
+        } // profiler::get_num_scopes()
+
+
+        const char *profiler::get_scope_name(const int scope)
+        {
+            assert(scope >= 0 && scope < num_scopes);
+            return scope_names[scope];
+        } // profiler::get_scope_name()
+
+
+        void profiler::set_enabled(const bool e)
+        {
+            enabled = e;
+        } // profiler::set_enabled()
+
+
+        unsigned long long profiler::get_time_ns()
+        {
+#ifdef WIN32
+            static LARGE_INTEGER frequency = { 0 };
+            if (!frequency.QuadPart)
+                QueryPerformanceFrequency(&frequency);
+
+            LARGE_INTEGER count;
+            QueryPerformanceCounter(&count);
+
+            unsigned long long secs = count.QuadPart / frequency.QuadPart;
+            unsigned long long rem = count.QuadPart % frequency.QuadPart;
+
+            return secs * NS_PER_SEC + rem * NS_PER_SEC / frequency.QuadPart;
+#else
+            timespec ts;
+            ::clock_gettime(CLOCK_MONOTONIC, &ts);
+
+            return static_cast<unsigned long long>(ts.tv_sec) * NS_PER_SEC + ts.tv_nsec;
+#endif
+        } // profiler::get_time_ns()
+
+
+        static profiler_buffer *claim_buffer()
+        {
+            profiler_buffer *buffer = 0;
+
+            registry_lock.lock();
+
+            for (int i = 0; i < buffers.size(); ++i)
+            {
+                if (!buffers[i]->in_use)
+                {
+                    buffer = buffers[i];
+                    buffer->in_use = true;
+                    buffer->depth = 0;
+                    break;
+                }
+            }
+
+            if (!buffer)
+            {
+                buffer = new profiler_buffer(buffers.size());
+                buffers.append(buffer);
+            }
+
+            registry_lock.unlock();
+            return buffer;
+        } // claim_buffer()
+
+
+        profiler_buffer *profiler::enter(const int scope)
+        {
+            if (!enabled || !instance)
+                return 0;
+
+            profiler_buffer *buffer = current_buffer;
+            if (!buffer)
+                buffer = current_buffer = claim_buffer();
+
+            if (buffer->depth < MAX_DEPTH)
+            {
+                profiler_buffer::open_scope & s = buffer->stack[buffer->depth];
+                s.scope = scope;
+                s.child_ns = 0;
+                s.start_ns = get_time_ns();
+            }
+
+            ++buffer->depth;
+            return buffer;
+        } // profiler::enter()
+
+
+        void profiler::leave(profiler_buffer *buffer)
+        {
+            unsigned long long end_ns = get_time_ns();
+
+            int depth = --buffer->depth;
+            if (depth >= MAX_DEPTH)
+                return;
+
+            profiler_buffer::open_scope & s = buffer->stack[depth];
+            unsigned long long duration_ns = end_ns - s.start_ns;
+
+            if (depth > 0)
+                buffer->stack[depth-1].child_ns += duration_ns;
+
+            // drop the scope if end_frame() has fallen behind
+            unsigned long pos = buffer->write_pos;
+            if (pos - buffer->read_pos >= BUFFER_SIZE)
+                return;
+
+            profile_event & e = buffer->events[pos % BUFFER_SIZE];
+            e.scope = s.scope;
+            e.start_ns = s.start_ns;
+            e.duration_ns = duration_ns;
+            e.exclusive_ns = duration_ns - s.child_ns;
+
+            // only this thread writes the buffer, so publishing the event to end_frame() just needs the stores kept in order
+            release_barrier();
+            buffer->write_pos = pos + 1;
+        } // profiler::leave()
+
+
+        void profiler::release_thread()
+        {
+            profiler_buffer *buffer = current_buffer;
+
+            if (buffer)
+            {
+                registry_lock.lock();
+                buffer->in_use = false;
+                registry_lock.unlock();
+
+                current_buffer = 0;
+            }
+        } // profiler::release_thread()
+
+
+    } // namespace platform
+
+} // namespace gsgl
@@ -0,0 +1,193 @@
+#ifndef GSGL_PLATFORM_PROFILER_H
+#define GSGL_PLATFORM_PROFILER_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "platform/platform.hpp"
+#include "data/singleton.hpp"
+#include "data/string.hpp"
+#include "data/array.hpp"
+#include "platform/thread.hpp"
+
+namespace gsgl
+{
+
+    class string;
+
+    namespace platform
+    {
+
+        class profiler_buffer;
+
+
+        /// A hierarchical profiler that is cheap enough to leave on in release builds.
+        ///
+        /// Scopes are identified by small integers handed out by register_scope(), so entering and leaving a scope only reads the clock and writes to a buffer owned by the calling thread; no locks or strings are involved.
+        /// The thread that owns the profiler calls end_frame() once per frame to collect every thread's buffer into per-scope totals for that frame.
+        /// Between start_capture() and stop_capture() the individual scopes are kept as well, and written out in Chrome's trace event format (open the file in chrome://tracing).
+        class PLATFORM_API profiler
+            : public platform_object, public data::singleton<profiler>
+        {
+        public:
+            enum
+            {
+                MAX_SCOPES = 1024,         ///< The maximum number of distinct scope names.
+                MAX_CAPTURE_EVENTS = 1 << 20 ///< Capturing stops recording scopes after this many.
+            };
+
+            /// The time spent in one scope during a frame.
+            struct scope_totals
+            {
+                unsigned long long inclusive_ns; ///< Time spent in the scope, including nested scopes.
+                unsigned long long exclusive_ns; ///< Time spent in the scope, excluding nested scopes.
+                unsigned int count;              ///< The number of times the scope was entered.
+            }; // struct scope_totals
+
+            /// One scope recorded during a capture.
+            struct trace_event
+            {
+                int scope;
+                int thread;
+                unsigned long long start_ns;
+                unsigned long long duration_ns;
+            }; // struct trace_event
+
+        private:
+            scope_totals frame_totals[MAX_SCOPES];
+
+            unsigned long long frame_start_ns;
+            unsigned long long frame_ns;
+
+            bool capturing;
+            unsigned long long capture_start_ns;
+            data::simple_array<trace_event> capture;
+
+            static volatile bool enabled;
+
+        public:
+            profiler();
+            ~profiler();
+
+            /// \name Frame Statistics.
+            /// @{
+
+            /// Collects the scopes recorded by all threads since the last call.  Call this once per frame.
+            void end_frame();
+
+            /// \return The length of the last frame, in nanoseconds.
+            unsigned long long get_frame_time() const { return frame_ns; }
+
+            /// \return The totals for a scope during the last frame.
+            const scope_totals & get_frame_totals(const int scope) const { return frame_totals[scope]; }
+
+            /// @}
+
+            /// \name Capturing.
+            /// @{
+
+            void start_capture();
+            bool is_capturing() const { return capturing; }
+
+            /// Writes the scopes recorded since start_capture() to a Chrome trace event file.
+            void stop_capture(const string & fname);
+
+            /// @}
+
+            /// \name Scopes.
+            /// These are safe to call from any thread.
+            /// @{
+
+            /// \return The id of the scope with the given name, registering it if necessary.
+            static int register_scope(const char *name);
+            static int register_scope(const string & name);
+
+            /// \return The id of the scope with the given name, registering it the first time.  \c id caches the result and must start out negative.
+            /// Threads that race to fill in \c id all get the same id from register_scope(), so no further locking is needed.
+            static int cached_scope(volatile int & id, const char *name)
+            {
+                int scope = id;
+                if (scope < 0)
+                    id = scope = register_scope(name);
+                return scope;
+            }
+
+            static int get_num_scopes();
+            static const char *get_scope_name(const int scope);
+
+            static void set_enabled(const bool enabled);
+            static bool is_enabled() { return enabled; }
+
+            static unsigned long long get_time_ns(); ///< \return A monotonic time in nanoseconds.
+
+            /// \return The calling thread's buffer if the scope is being recorded, or 0.
+            static profiler_buffer *enter(const int scope);
+            static void leave(profiler_buffer *buffer);
+
+            /// Called when a thread exits, so its buffer can be reused by a later thread.
+            static void release_thread();
+
+            /// @}
+
+        private:
+            void collect(profiler_buffer *buffer);
+        }; // class profiler
+
+
+        /// Records the time spent in the enclosing block.
+        class profile_scope
+        {
+            profiler_buffer *buffer;
+
+        public:
+            profile_scope(const int scope) : buffer(profiler::enter(scope)) {}
+            ~profile_scope() { if (buffer) profiler::leave(buffer); }
+        }; // class profile_scope
+
+
+    } // namespace platform
+
+} // namespace gsgl
+
+
+/// Profiles the rest of the enclosing block under \c name, which must be a string literal.  The name is only looked up the first time.
+/// The id is a constant-initialized static rather than one initialized by a function call, because MSVC does not guard the initialization of function-local statics against other threads.
+#define PROFILE_SCOPE(name) \
+    static volatile int _profile_id = -1; \
+    gsgl::platform::profile_scope _ps(gsgl::platform::profiler::cached_scope(_profile_id, name))
+
+/// Profiles the rest of the enclosing block under a scope id returned by profiler::register_scope().
+#define PROFILE_SCOPE_ID(id) gsgl::platform::profile_scope _ps(id)
+
+
+#endif
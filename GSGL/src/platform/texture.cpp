@@ -64,12 +64,12 @@ namespace gsgl
                 throw runtime_exception(L"Unable to map %ls: file does not exist!", full_path.w_string());
 
             mf = new mapped_file(fname, io::FILE_OPEN_READ | io::FILE_OPEN_WRITE);
-            int *iptr = static_cast<int *>( mf->get_pointer() );
-            
-            width = *iptr++;
-            height = *iptr++;
+            mapped_view<int> header = mf->get_view<int>(0, 2);
+
+            width = header[0];
+            height = header[1];
 
-            buffer = reinterpret_cast<unsigned char *>( iptr );
+            buffer = mf->get_view<unsigned char>(2 * sizeof(int), width * height * 4).ptr();
         } // rgba_buffer::rgba_buffer()
 
 
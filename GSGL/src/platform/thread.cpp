@@ -32,9 +32,14 @@
 //
 
 #include "platform/thread.hpp"
+#include "platform/profiler.hpp"
 #include "data/exception.hpp"
 #include "platform/lowlevel.hpp"
 
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
 namespace gsgl
 {
 
@@ -69,6 +74,80 @@ namespace gsgl
         } // mutex::unlock()
 
 
+        //////////////////////////////////////////////////////////////
+
+        condition::condition()
+            : c(0)
+        {
+            c = SDL_CreateCond();
+            if (!c)
+                throw runtime_exception(L"Unable to create condition variable: %hs", SDL_GetError());
+        } // condition::condition()
+
+
+        condition::~condition()
+        {
+            if (c)
+                SDL_DestroyCond(c);
+        } // condition::~condition()
+
+
+        void condition::wait(mutex & m)
+        {
+            SDL_CondWait(c, m.m);
+        } // condition::wait()
+
+
+        bool condition::wait(mutex & m, const unsigned int timeout_ms)
+        {
+            return SDL_CondWaitTimeout(c, m.m, timeout_ms) == 0;
+        } // condition::wait()
+
+
+        void condition::signal()
+        {
+            SDL_CondSignal(c);
+        } // condition::signal()
+
+
+        void condition::broadcast()
+        {
+            SDL_CondBroadcast(c);
+        } // condition::broadcast()
+
+
+        //////////////////////////////////////////////////////////////
+
+        long atomic_increment(volatile long *val)
+        {
+#ifdef WIN32
+            return InterlockedIncrement(val);
+#else
+            return __sync_add_and_fetch(val, 1);
+#endif
+        } // atomic_increment()
+
+
+        long atomic_decrement(volatile long *val)
+        {
+#ifdef WIN32
+            return InterlockedDecrement(val);
+#else
+            return __sync_sub_and_fetch(val, 1);
+#endif
+        } // atomic_decrement()
+
+
+        void memory_barrier()
+        {
+#ifdef WIN32
+            MemoryBarrier();
+#else
+            __sync_synchronize();
+#endif
+        } // memory_barrier()
+
+
         //////////////////////////////////////////////////////////////
 
         static int run_thread(void *data)
@@ -76,9 +155,15 @@ namespace gsgl
             thread *th = (thread *) data;
 
             if (th)
-                return th->run();
+            {
+                int result = th->run();
+                profiler::release_thread();
+                return result;
+            }
             else
+            {
                 return -1;
+            }
         } // run_thread()
 
 
@@ -126,6 +211,19 @@ namespace gsgl
             }
         } // thread::wait()
 
+
+        int thread::get_num_processors()
+        {
+#ifdef WIN32
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            return static_cast<int>(info.dwNumberOfProcessors);
+#else
+            long num = ::sysconf(_SC_NPROCESSORS_ONLN);
+            return num > 0 ? static_cast<int>(num) : 1;
+#endif
+        } // thread::get_num_processors()
+
     } // namespace platform
 
 } // namespace gsgl
@@ -36,7 +36,13 @@
 
 #include "platform/platform.hpp"
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#pragma intrinsic(_ReadWriteBarrier)
+#endif
+
 struct SDL_mutex;
+struct SDL_cond;
 struct SDL_Thread;
 
 namespace gsgl
@@ -55,9 +61,58 @@ namespace gsgl
 
             void lock();
             void unlock();
+
+            friend class condition;
         }; // class mutex
 
 
+        /// A condition variable.  The mutex passed to wait() must be locked by the calling thread.
+        class PLATFORM_API condition
+        {
+            SDL_cond *c;
+
+        public:
+            condition();
+            ~condition();
+
+            void wait(mutex & m);
+            bool wait(mutex & m, const unsigned int timeout_ms); ///< \return False if the wait timed out.
+
+            void signal();
+            void broadcast();
+        }; // class condition
+
+
+        /// \name Atomic Operations
+        /// These act as full memory barriers.
+        /// @{
+        PLATFORM_API long atomic_increment(volatile long *); ///< \return The new value.
+        PLATFORM_API long atomic_decrement(volatile long *); ///< \return The new value.
+        PLATFORM_API void memory_barrier();
+        /// @}
+
+
+        /// Keeps the writes before it from being reordered after the writes after it (and the reads before it after the writes after it), so data written before a flag is visible to a thread that sees the flag.
+        /// x86 and x64 processors already keep stores in order, so there it only stops the compiler from moving them.
+        inline void release_barrier()
+        {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+            _ReadWriteBarrier();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+            __asm__ __volatile__ ("" ::: "memory");
+#else
+            memory_barrier();
+#endif
+        } // release_barrier()
+
+
+        /// Keeps the reads after it from being reordered before the reads before it; the counterpart of release_barrier() on the reading thread.
+        inline void acquire_barrier()
+        {
+            release_barrier();
+        } // acquire_barrier()
+
+
         template <typename T>
         class synchronized
         {
@@ -101,6 +156,8 @@ namespace gsgl
             void wait();
             void kill();
 
+            static int get_num_processors(); ///< \return The number of processors available to run threads.
+
         protected:
             virtual int run() = 0;
 
@@ -38,6 +38,8 @@
 #include "data/array.hpp"
 #include "math/vector.hpp"
 
+#include <cstring>
+
 namespace gsgl
 {
 
@@ -113,6 +115,19 @@ namespace gsgl
             gsgl::index_t size() const { return buffer.size(); }
             void append(const T & t) { buffer.append(t); }
 
+            /// Replaces the contents of the buffer with num elements copied from src (which may be a mapped file).
+            void assign(const T *src, const gsgl::index_t num)
+            {
+                buffer.clear();
+                if (num)
+                {
+                    buffer[num-1] = T();
+                    ::memcpy(buffer.ptr(), src, num * sizeof(T));
+                }
+                lowest_dirty_index = 0;
+                highest_dirty_index = num - 1;
+            }
+
             inline const T & operator[] (const gsgl::index_t & i) const { return buffer[i]; }
             inline T & operator[] (const gsgl::index_t & i) { if (i < lowest_dirty_index) lowest_dirty_index = i; if (i > highest_dirty_index) highest_dirty_index = i; return buffer[i]; }
 
@@ -76,6 +76,7 @@ namespace gsgl
               view(0), 
               cam(0), 
               num_lights(0),
+              interpolation(1),
               render_flags(RENDER_NO_FLAGS)
         {
         } // drawing_context::drawing_context()
@@ -87,6 +88,7 @@ namespace gsgl
               view(dc.view),
               cam(dc.cam),
               num_lights(dc.num_lights),
+              interpolation(dc.interpolation),
               render_flags(dc.render_flags)
         {
         } // drawing_context::drawing_context()
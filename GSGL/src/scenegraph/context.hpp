@@ -94,6 +94,8 @@ namespace gsgl
 
             int num_lights;             ///< The number of lights in the world.
 
+            gsgl::real_t interpolation; ///< How far between the last two simulation ticks the frame is being drawn (0 to 1).
+
             enum
             {
                 RENDER_NO_FLAGS      = 0,
@@ -100,6 +100,8 @@ namespace gsgl
 
             if (get_translation().mag() > 0)
                 relative = true;
+
+            reset_snapshot();
         } // freeview::reset()
 
 
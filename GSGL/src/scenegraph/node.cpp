@@ -38,8 +38,9 @@
 
 #include "data/pqueue.hpp"
 #include "math/units.hpp"
+#include "math/quaternion.hpp"
 
-#include "platform/budget.hpp"
+#include "platform/profiler.hpp"
 
 #include <cmath>
 #include <cfloat>
@@ -103,17 +104,19 @@ namespace gsgl
             int i, len = from_ref.size();
             for (i = 0; i < len; ++i)
             {
-                relative_transform = relative_transform * from_ref[i]->get_orientation().transpose();
                 if (include_translation)
-                    relative_transform = relative_transform * transform::translation_transform(-from_ref[i]->get_translation() * from_ref[i]->get_scale());
+                    relative_transform = relative_transform * transform::inverse_rigid(from_ref[i]->get_orientation(), from_ref[i]->get_translation() * from_ref[i]->get_scale());
+                else
+                    relative_transform = relative_transform * from_ref[i]->get_orientation().transpose();
             }
 
             len = to_cur.size();
             for (i = 0; i < len; ++i)
             {
                 if (include_translation)
-                    relative_transform = relative_transform * transform::translation_transform(to_cur[i]->get_translation() * from_ref[i]->get_scale());
-                relative_transform = relative_transform * to_cur[i]->get_orientation();
+                    relative_transform = relative_transform * transform::rigid(to_cur[i]->get_orientation(), to_cur[i]->get_translation() * from_ref[i]->get_scale());
+                else
+                    relative_transform = relative_transform * to_cur[i]->get_orientation();
             }
 
             return relative_transform;
@@ -126,12 +129,15 @@ namespace gsgl
               parent(parent), name(name), scale(1),
               translation(vector::ZERO), orientation(transform::IDENTITY), 
               modelview(transform::IDENTITY),
-              draw_flags(0), draw_results(0)
+              draw_flags(0), draw_results(0),
+              update_scope(-1), draw_scope(-1)
         {
             set_flags(get_draw_flags(), NODE_DRAW_UNLIT);
 
             if (parent)
                 parent->add_child(this);
+
+            reset_snapshot();
         } // node::node()
 
         
@@ -140,7 +146,8 @@ namespace gsgl
               parent(0), scale(1),
               translation(vector::ZERO), orientation(transform::IDENTITY), 
               modelview(transform::IDENTITY),
-              draw_flags(0), draw_results(0)
+              draw_flags(0), draw_results(0),
+              update_scope(-1), draw_scope(-1)
         {
             set_flags(get_draw_flags(), NODE_DRAW_UNLIT);
 
@@ -153,6 +160,8 @@ namespace gsgl
                 translation = vector::parse(conf[L"position"]);
             if (!conf[L"orientation"].is_empty())
                 orientation = transform::parse(conf[L"orientation"]);
+
+            reset_snapshot();
         } // node::node()
         
 
@@ -233,6 +242,12 @@ namespace gsgl
         } // node::draw_priority()
 
 
+        node::node_update_mode node::get_update_mode() const
+        {
+            return NODE_UPDATE_CONCURRENT;
+        } // node::get_update_mode()
+
+
         gsgl::real_t node::view_radius() const
         {
             return 0;
@@ -251,6 +266,84 @@ namespace gsgl
         } // node::minimum_view_distance()
 
         
+        int node::get_update_scope()
+        {
+            if (update_scope == -1)
+                update_scope = profiler::register_scope(string(L"physics: ") + get_type_name());
+
+            return update_scope;
+        } // node::get_update_scope()
+
+
+        int node::get_draw_scope()
+        {
+            if (draw_scope == -1)
+                draw_scope = profiler::register_scope(string(L"render: ") + get_type_name());
+
+            return draw_scope;
+        } // node::get_draw_scope()
+
+
+        void node::set_translation(const math::dvector & t)
+        {
+            precise_translation = t;
+            translation = t.to_vector();
+        } // node::set_translation()
+
+
+        math::dvector node::get_precise_translation() const
+        {
+            // if the float translation no longer matches, someone has set it directly
+            if (static_cast<gsgl::real_t>(precise_translation.get_x()) == translation.get_x()
+                && static_cast<gsgl::real_t>(precise_translation.get_y()) == translation.get_y()
+                && static_cast<gsgl::real_t>(precise_translation.get_z()) == translation.get_z())
+                return precise_translation;
+
+            return dvector(translation);
+        } // node::get_precise_translation()
+
+
+        void node::take_snapshot()
+        {
+            prev_translation = next_translation;
+            prev_orientation = next_orientation;
+
+            next_translation = get_precise_translation();
+            next_orientation = orientation;
+        } // node::take_snapshot()
+
+
+        void node::reset_snapshot()
+        {
+            prev_translation = next_translation = get_precise_translation();
+            prev_orientation = next_orientation = orientation;
+        } // node::reset_snapshot()
+
+
+        math::vector node::get_draw_translation(const gsgl::real_t t) const
+        {
+            return get_draw_precise_translation(t).to_vector();
+        } // node::get_draw_translation()
+
+
+        math::dvector node::get_draw_precise_translation(const gsgl::real_t t) const
+        {
+            if (t >= 1)
+                return next_translation;
+
+            return dvector::interpolate(prev_translation, next_translation, t);
+        } // node::get_draw_precise_translation()
+
+
+        math::transform node::get_draw_orientation(const gsgl::real_t t) const
+        {
+            if (t >= 1 || prev_orientation == next_orientation)
+                return next_orientation;
+
+            return transform(quaternion::interpolate(quaternion(prev_orientation), quaternion(next_orientation), t));
+        } // node::get_draw_orientation()
+
+        
         void node::add_child(node *child)
         {
             assert(child);
@@ -324,11 +417,30 @@ namespace gsgl
             // collect parent
             if (cur->parent && cur->parent != prev)
             {
-                transform to_parent = cur->orientation.transpose() * transform::translation_transform(cur->translation * (-1 * cur->parent->scale));
+                transform to_parent = transform::inverse_rigid(cur->get_draw_orientation(draw_context->interpolation), cur->get_draw_translation(draw_context->interpolation) * cur->parent->scale);
                 build_draw_list(cur->parent, cur, sim_context, draw_context, modelview * to_parent, rec);
             }
             
             // collect me
+            add_to_draw_list(cur, sim_context, draw_context, modelview, rec);
+
+            // collect children (& scale)
+            int i, len = cur->children.size();
+            for (i = 0; i < len; ++i)
+            {
+                node *child = cur->children[i];
+
+                if (child != prev)
+                {
+                    transform from_parent = transform::rigid(child->get_draw_orientation(draw_context->interpolation), child->get_draw_translation(draw_context->interpolation) * cur->scale);
+                    build_draw_list(child, cur, sim_context, draw_context, modelview * from_parent, rec);
+                }
+            }
+        } // build_draw_list()
+
+
+        void node::add_to_draw_list(node *cur, simulation_context *sim_context, drawing_context *draw_context, const transform & modelview, pre_draw_rec & rec)
+        {
             cur->modelview = modelview;
             cur->get_draw_results() = node::NODE_NO_DRAW_RESULTS;
 
@@ -355,20 +467,76 @@ namespace gsgl
                     set_flags(cur->get_draw_results(), node::NODE_OFF_SCREEN);
                 }
             }
+        } // node::add_to_draw_list()
+
+
+        //
+
+        /// Finds a child's frame, given its parent's.  Positions are in meters, relative to the root's origin, and rotations are relative to the root's axes.
+        /// Both the camera's frame and the nodes' frames are found with this, so any rounding in a shared ancestor's frame is the same for both and cancels when they are subtracted.
+        void node::get_child_draw_frame(const node *parent, const dvector & parent_pos, const transform & parent_rot, const node *child, const gsgl::real_t t, 
+                                        dvector & child_pos, transform & child_rot)
+        {
+            child_pos = parent_pos + (child->get_draw_precise_translation(t) * parent->scale).rotate_by(parent_rot);
+            child_rot = parent_rot * child->get_draw_orientation(t);
+        } // node::get_child_draw_frame()
+
+
+        void node::get_draw_frame(node *n, const gsgl::real_t t, dvector & pos, transform & rot)
+        {
+            if (!n->parent)
+            {
+                pos = dvector();
+                rot = transform::IDENTITY;
+                return;
+            }
+
+            dvector parent_pos;
+            transform parent_rot;
+            get_draw_frame(n->parent, t, parent_pos, parent_rot);
+            get_child_draw_frame(n->parent, parent_pos, parent_rot, n, t, pos, rot);
+        } // node::get_draw_frame()
+
+
+        /// Builds the modelview for a node's frame, given the frames in double precision.  Only the offset from the eye is rounded to single precision.
+        static transform floating_modelview(const dvector & pos, const transform & rot, const dvector & eye_pos, const transform & eye_rot_inverse)
+        {
+            vector offset = (pos - eye_pos).to_vector();
+            return transform::rigid(eye_rot_inverse * rot, eye_rot_inverse.transform_direction(offset));
+        } // floating_modelview()
+
+
+        transform node::get_floating_modelview(node *eye, node *n, const gsgl::real_t t)
+        {
+            dvector eye_pos, pos;
+            transform eye_rot, rot;
+            get_draw_frame(eye, t, eye_pos, eye_rot);
+            get_draw_frame(n, t, pos, rot);
+
+            return floating_modelview(pos, rot, eye_pos, eye_rot.transpose());
+        } // node::get_floating_modelview()
+
+
+        void node::build_draw_list_floating(node *cur, simulation_context *sim_context, drawing_context *draw_context, const dvector & cur_pos, const transform & cur_rot, 
+                                            const dvector & eye_pos, const transform & eye_rot_inverse, pre_draw_rec & rec)
+        {
+            add_to_draw_list(cur, sim_context, draw_context, floating_modelview(cur_pos, cur_rot, eye_pos, eye_rot_inverse), rec);
 
-            // collect children (& scale)
             int i, len = cur->children.size();
             for (i = 0; i < len; ++i)
             {
                 node *child = cur->children[i];
 
-                if (child != prev)
-                {
-                    transform from_parent = transform::translation_transform(child->translation * cur->scale) * child->orientation;
-                    build_draw_list(child, cur, sim_context, draw_context, modelview * from_parent, rec);
-                }
+                dvector child_pos;
+                transform child_rot;
+                get_child_draw_frame(cur, cur_pos, cur_rot, child, draw_context->interpolation, child_pos, child_rot);
+
+                build_draw_list_floating(child, sim_context, draw_context, child_pos, child_rot, eye_pos, eye_rot_inverse, rec);
             }
-        } // build_draw_list()
+        } // node::build_draw_list_floating()
+
+
+        static config_variable<int> FLOATING_ORIGIN(L"scenegraph/floating_origin", 1); ///< Build modelviews from double-precision positions relative to the camera.
 
 
         void node::pre_draw_scene(simulation_context *sim_context, drawing_context *draw_context, pre_draw_rec & rec)
@@ -378,11 +546,25 @@ namespace gsgl
             rec.solids.clear();
             rec.translucents.clear();
 
-            build_draw_list(draw_context->cam, 0, sim_context, draw_context, transform::IDENTITY, rec);
+            if (FLOATING_ORIGIN)
+            {
+                node *root = draw_context->cam;
+                while (root->parent)
+                    root = root->parent;
+
+                dvector eye_pos;
+                transform eye_rot;
+                get_draw_frame(draw_context->cam, draw_context->interpolation, eye_pos, eye_rot);
+
+                build_draw_list_floating(root, sim_context, draw_context, dvector(), transform::IDENTITY, eye_pos, eye_rot.transpose(), rec);
+            }
+            else
+            {
+                build_draw_list(draw_context->cam, 0, sim_context, draw_context, transform::IDENTITY, rec);
+            }
         } // node::pre_draw_scene()
 
 
-        static const string RENDER_CATEGORY = L"render: ";
 
         static config_variable<platform::color> AMBIENT_LIGHT(L"scenegraph/draw/ambient_light", platform::color(0.15f, 0.15f, 0.15f, 1.0f));
         static config_variable<gsgl::real_t> LOCAL_CULL_DISTANCE(L"scenegraph/draw/local_cull_distance", 100000.0f);
@@ -390,6 +572,8 @@ namespace gsgl
 
         void node::draw_scene(simulation_context *sim_context, drawing_context *draw_context, pre_draw_rec & rec)
         {
+            PROFILE_SCOPE("render: scene");
+
             display & fb = *draw_context->screen;
 
             display::scoped_state state(fb, draw_context->display_flags());
@@ -456,7 +640,7 @@ namespace gsgl
                 if (flag_is_set(n->draw_results, NODE_OFF_SCREEN))
                     continue;
 
-                BUDGET_SCOPE(RENDER_CATEGORY + n->get_type_name());
+                PROFILE_SCOPE_ID(n->get_draw_scope());
                 display::scoped_modelview mv(fb, &n->get_modelview());
 
                 // nodes need to do their own frustum checks
@@ -472,7 +656,7 @@ namespace gsgl
             {
                 node *n = nodes[i];
                 
-                float zdist = (n->get_modelview() * vector::ZERO).get_z();
+                float zdist = n->get_modelview().transform_point(vector::ZERO).get_z();
                 if (zdist < 0.1f) zdist = 0.1f;
 
                 if (zdist > LOCAL_CULL_DISTANCE) {
@@ -498,7 +682,7 @@ namespace gsgl
                 if (flag_is_set(n->draw_results, NODE_OFF_SCREEN | NODE_DISTANCE_CULLED))
                     continue;
 
-                BUDGET_SCOPE(RENDER_CATEGORY + n->get_type_name());
+                PROFILE_SCOPE_ID(n->get_draw_scope());
                 display::scoped_modelview mv(*draw_context->screen, &n->get_modelview());
                 n->draw(sim_context, draw_context);
             }
@@ -550,7 +734,7 @@ namespace gsgl
                 node *n = rec.paint_queue[i];
                 n->draw_results = NODE_NO_DRAW_RESULTS;
              
-                BUDGET_SCOPE(RENDER_CATEGORY + n->get_type_name());
+                PROFILE_SCOPE_ID(n->get_draw_scope());
 
                 glMatrixMode(GL_MODELVIEW);                                                                         CHECK_GL_ERRORS();
                 glLoadMatrixf(n->get_modelview().ptr());
@@ -646,7 +830,7 @@ namespace gsgl
                     if (n->draw_results & (NODE_OFF_SCREEN | NODE_DISTANCE_CULLED))
                         continue;
 
-                    BUDGET_SCOPE(RENDER_CATEGORY + n->get_type_name());
+                    PROFILE_SCOPE_ID(n->get_draw_scope());
 
                     glMatrixMode(GL_MODELVIEW);
                     glLoadMatrixf(n->get_modelview().ptr());
@@ -666,7 +850,7 @@ namespace gsgl
                     if (n->draw_results & (NODE_OFF_SCREEN | NODE_DISTANCE_CULLED))
                         continue;
 
-                    BUDGET_SCOPE(RENDER_CATEGORY + n->get_type_name());
+                    PROFILE_SCOPE_ID(n->get_draw_scope());
 
                     glMatrixMode(GL_MODELVIEW);
                     glLoadMatrixf(n->get_modelview().ptr());
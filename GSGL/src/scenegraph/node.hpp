@@ -47,6 +47,7 @@
 
 #include "math/vector.hpp"
 #include "math/transform.hpp"
+#include "math/dvector.hpp"
 
 namespace gsgl
 {
@@ -87,13 +88,19 @@ namespace gsgl
             gsgl::real_t    scale;       ///< The scale of the node in meters per unit.
 
             math::vector    translation; ///< The translation of the node's frame in its parent's frame and scale.
+            math::dvector   precise_translation; ///< The translation in double precision, as given to set_translation().  It is ignored once translation is changed directly.
             math::transform orientation; ///< Multiply this by a position in the node's frame to yield the position in the parent's frame.  Should never contain a translation component!
             
             math::transform modelview;   ///< The modelview matrix the node should be drawn with.
 
+            math::dvector   prev_translation, next_translation; ///< The translation as of the last two simulation ticks.
+            math::transform prev_orientation, next_orientation; ///< The orientation as of the last two simulation ticks.
+
             gsgl::flags_t draw_flags;   ///< Flags that control how the node should be drawn (these stay fairly constant).
             gsgl::flags_t draw_results; ///< Flags that indicate what happened to the node when it was drawn (these may change frame to frame).
 
+            int update_scope, draw_scope; ///< Profiler scopes for this node's type (registered when first used).
+
         public:
 
             /// Creates a node with a given name and parent.
@@ -120,6 +127,12 @@ namespace gsgl
             inline math::vector    & get_translation() { return translation; }
             inline math::transform & get_orientation() { return orientation; }
 
+            /// Sets the translation in double precision.  get_translation() returns it rounded to single precision.
+            void set_translation(const math::dvector & t);
+
+            /// \return The translation in double precision.  This is the value given to set_translation(), unless the translation has been changed through get_translation() since.
+            math::dvector get_precise_translation() const;
+
             inline math::transform & get_modelview()   { return modelview; }
             
             /// @}
@@ -178,8 +191,13 @@ namespace gsgl
             }; // struct pre_draw_rec
 
             /// Collect information about the scene to draw.  Unsafe to call while update is being called in the tree.
+            /// With scenegraph/floating_origin set, node positions are accumulated from the root in double precision and the modelviews are made relative to the camera,
+            /// so only the camera-relative offsets are rounded to floats.  Otherwise the modelviews are built by walking the graph outwards from the camera.
             static void pre_draw_scene(gsgl::scenegraph::simulation_context *sim_context, gsgl::scenegraph::drawing_context *draw_context, pre_draw_rec & rec);
 
+            /// \return The modelview matrix that pre_draw_scene() gives \c n with scenegraph/floating_origin set, when drawing from \c eye, \c t of the way between the last two snapshots.
+            static math::transform get_floating_modelview(node *eye, node *n, const gsgl::real_t t);
+
             /// Draws a scene.  Safe to call while update is also being called in the tree.
             static void draw_scene(gsgl::scenegraph::simulation_context *sim_context, gsgl::scenegraph::drawing_context *draw_context, pre_draw_rec & rec);
 
@@ -192,6 +210,7 @@ namespace gsgl
             virtual void init(const gsgl::scenegraph::simulation_context *sim_context);
             
             /// Called to draw the node.  The node's modelview matrix is in the correct state for drawing, and already loaded into the OpenGL modelview matrix.
+            /// The simulation may be updating the next tick on its own thread meanwhile, so this should use the modelview matrix and \c sim_context (a copy taken with the draw list) rather than reading the translation, orientation or other state that update() changes.
             virtual void draw(const gsgl::scenegraph::simulation_context *sim_context, const gsgl::scenegraph::drawing_context *draw_context);
             
             /// Called from the root of the world-tree up to update the node's state.  The node's modelview matrix is that of the previously-drawn frame.
@@ -208,6 +227,52 @@ namespace gsgl
             
             /// @}
 
+            /// \name Update Ordering.
+            /// The simulation may update sibling subtrees concurrently on different threads; a node is always updated after its parent.
+            /// So update() may read the state of the node's ancestors, but must not touch any other node's state or shared caches.
+            /// Nodes that need more than that should return NODE_UPDATE_SERIAL; their whole subtree is then updated on the simulation thread, after the concurrent updates.
+            /// @{
+
+            enum node_update_mode
+            {
+                NODE_UPDATE_CONCURRENT = 0, ///< update() follows the contract above.
+                NODE_UPDATE_SERIAL     = 1  ///< update() must run on the simulation thread.
+            };
+
+            virtual node_update_mode get_update_mode() const;
+
+            /// @}
+
+            /// \name Interpolation Snapshots.
+            /// The simulation may update the scene graph on its own thread at a fixed tick.  After each tick it takes a snapshot of every node's translation and orientation,
+            /// and pre_draw_scene() builds the modelview matrices by interpolating between the last two snapshots, so drawing does not depend on the tick rate.
+            /// @{
+
+            /// Shifts the latest snapshot back and records the current translation and orientation.
+            void take_snapshot();
+
+            /// Makes both snapshots the current translation and orientation.  Call this when a node jumps (e.g. it is moved to a different frame), so it is not drawn moving between the two positions.
+            void reset_snapshot();
+
+            /// \return The translation to draw with, \c t of the way from the previous snapshot to the latest one.
+            math::vector get_draw_translation(const gsgl::real_t t) const;
+
+            /// \return The translation to draw with, in double precision.
+            math::dvector get_draw_precise_translation(const gsgl::real_t t) const;
+
+            /// \return The orientation to draw with, \c t of the way from the previous snapshot to the latest one.
+            math::transform get_draw_orientation(const gsgl::real_t t) const;
+
+            /// @}
+
+            /// \name Profiling.
+            /// @{
+
+            int get_update_scope(); ///< \return The profiler scope for updating nodes of this type.
+            int get_draw_scope();   ///< \return The profiler scope for drawing nodes of this type.
+
+            /// @}
+
             /// \name Drawing Information Functions.
             /// @{
 
@@ -232,6 +297,12 @@ namespace gsgl
 
         private:
             static void build_draw_list(node *cur, node *prev, simulation_context *sim_context, drawing_context *draw_context, const math::transform & modelview, pre_draw_rec &);
+            static void build_draw_list_floating(node *cur, simulation_context *sim_context, drawing_context *draw_context, const math::dvector & cur_pos, const math::transform & cur_rot, 
+                                                 const math::dvector & eye_pos, const math::transform & eye_rot_inverse, pre_draw_rec &);
+            static void add_to_draw_list(node *cur, simulation_context *sim_context, drawing_context *draw_context, const math::transform & modelview, pre_draw_rec &);
+            static void get_draw_frame(node *n, const gsgl::real_t t, math::dvector & pos, math::transform & rot);
+            static void get_child_draw_frame(const node *parent, const math::dvector & parent_pos, const math::transform & parent_rot, const node *child, const gsgl::real_t t, 
+                                             math::dvector & child_pos, math::transform & child_rot);
 
             static void draw_scene_lighting(simulation_context *sim_context, drawing_context *draw_context, pre_draw_rec & rec);
             static void draw_distant_nodes(simulation_context *sim_context, drawing_context *draw_context, pre_draw_rec & rec);
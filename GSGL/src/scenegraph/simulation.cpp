@@ -43,7 +43,8 @@
 #include "math/transform.hpp"
 #include "physics/vehicle.hpp"
 
-#include "platform/budget.hpp"
+#include "platform/profiler.hpp"
+#include "platform/job_scheduler.hpp"
 #include "platform/lowlevel.hpp"
 
 #include <cmath>
@@ -67,6 +68,96 @@ namespace gsgl
     {
 
         static config_variable<int> NUM_FRAME_DELTAS(L"scenegraph/simulation/num_frame_deltas", 100);
+        static config_variable<int> PARALLEL_UPDATE(L"scenegraph/simulation/parallel_update", 1);       ///< Update independent subtrees of the scene graph on the job scheduler's threads.
+        static config_variable<int> SUBTREES_PER_WORKER(L"scenegraph/simulation/subtrees_per_worker", 4); ///< Subtrees bigger than (graph size / (workers * this)) are split up further.
+        static config_variable<int> THREADED_UPDATE(L"scenegraph/simulation/threaded_update", 1);        ///< Update the scene graph on its own thread at a fixed tick.
+        static config_variable<int> UPDATE_RATE(L"scenegraph/simulation/update_rate", 60);               ///< The number of ticks per second when the scene graph is updated on its own thread.
+
+        /// Called at the start of each tick.
+        static simple_array<tick_listener *> tick_listeners;
+
+        /// Maximum frame time is 200 milliseconds (helps with debugging).  The update thread drops time rather than falling further behind than this.
+        static const unsigned long MAX_FRAME_TICKS = 200;
+
+
+        /// Updates the scene graph at a fixed tick, until stopped.
+        class simulation_thread
+            : public thread
+        {
+            simulation *sim;
+
+            volatile bool stopping;
+            mutex wait_lock;
+            condition wake;
+
+        public:
+            simulation_thread(simulation *sim) : thread(), sim(sim), stopping(false) {}
+
+            void stop()
+            {
+                wait_lock.lock();
+                stopping = true;
+                wake.signal();
+                wait_lock.unlock();
+
+                wait();
+            } // stop()
+
+        protected:
+            virtual int run()
+            {
+                unsigned long next_due = SDL_GetTicks();
+
+                wait_lock.lock();
+
+                while (!stopping)
+                {
+                    unsigned long now = SDL_GetTicks();
+
+                    if (now < next_due)
+                    {
+                        wake.wait(wait_lock, next_due - now);
+                        continue;
+                    }
+
+                    if (now - next_due > MAX_FRAME_TICKS)
+                        next_due = now;
+
+                    wait_lock.unlock();
+
+                    bool ok = true;
+                    sim->state_lock.lock();
+
+                    try
+                    {
+                        sim->tick(sim->sim_context->cur_tick + sim->tick_length);
+                        sim->tick_due = next_due;
+                    }
+                    catch (gsgl::exception & e)
+                    {
+                        sim->update_error = e.get_message();
+                        ok = false;
+                    }
+                    catch (...)
+                    {
+                        // an exception escaping the thread would end the process; stop updating and let update() report it instead
+                        sim->update_error = L"Unknown exception in the simulation update thread.";
+                        ok = false;
+                    }
+
+                    sim->state_lock.unlock();
+
+                    if (!ok)
+                        return 1;
+
+                    next_due += sim->tick_length;
+                    wait_lock.lock();
+                }
+
+                wait_lock.unlock();
+                return 0;
+            } // run()
+        }; // class simulation_thread
 
         //
 
@@ -78,7 +169,9 @@ namespace gsgl
                                node *scenery)
             : scenegraph_object(), running(true),
               console(console), sim_context(sim_context), draw_context(draw_context), scenery(scenery), 
-              start_time(0), time_scale(1), info_font(new platform::font(L"Sans", 18, platform::color(1, 0, 0))), frame_deltas(NUM_FRAME_DELTAS)
+              start_time(0), time_scale(1), info_font(new platform::font(L"Sans", 18, platform::color(1, 0, 0))), frame_deltas(NUM_FRAME_DELTAS),
+              update_thread(0), tick_length(0), tick_due(0), serial_frame(0),
+              draw_frame(0), last_draw_tick(0), draw_t_time(0)
         {
             assert(console);
             assert(sim_context);
@@ -165,6 +258,8 @@ namespace gsgl
 
         simulation::~simulation()
         {
+            stop_update_thread();
+
             for (list<node *>::iterator i = non_scenery_nodes.iter(); i.is_valid(); ++i)
             {
                 (*i)->detach();
@@ -174,6 +269,30 @@ namespace gsgl
         } // simulation::~simulation()
 
 
+        void simulation::add_tick_listener(tick_listener *listener, const bool first)
+        {
+            assert(listener);
+
+            if (first)
+                tick_listeners.insert(0, listener);
+            else
+                tick_listeners.append(listener);
+        } // simulation::add_tick_listener()
+
+
+        void simulation::remove_tick_listener(tick_listener *listener)
+        {
+            for (gsgl::index_t i = 0; i < tick_listeners.size(); ++i)
+            {
+                if (tick_listeners[i] == listener)
+                {
+                    tick_listeners.remove(i);
+                    return;
+                }
+            }
+        } // simulation::remove_tick_listener()
+
+
         void simulation::init_context()
         {
             sim_context->sim = this;
@@ -210,7 +329,7 @@ namespace gsgl
         } // simulation::init_context()
 
 
-        void simulation::update_context()
+        void simulation::update_context(const unsigned long cur_tick)
         {
             sim_context->sim = this;
             sim_context->scenery = scenery;
@@ -222,12 +341,11 @@ namespace gsgl
             ++sim_context->frame;
 
             unsigned int prev_tick = sim_context->cur_tick;
-            sim_context->cur_tick = SDL_GetTicks();
+            sim_context->cur_tick = cur_tick;
             sim_context->delta_tick = sim_context->cur_tick - prev_tick;
 
-            // maximum frame time is 200 milliseconds (helps with debugging)
-            if (sim_context->delta_tick > 200)
-                sim_context->delta_tick = 200;
+            if (sim_context->delta_tick > MAX_FRAME_TICKS)
+                sim_context->delta_tick = MAX_FRAME_TICKS;
 
             sim_context->delta_time = time_scale * static_cast<double>(sim_context->delta_tick) / 1000.0;
             sim_context->cur_time += sim_context->delta_time;
@@ -236,13 +354,6 @@ namespace gsgl
 
             sim_context->julian_dt = sim_context->delta_time / math::julian_day::JDAY;
             sim_context->julian_cur += sim_context->julian_dt;
-
-            //
-            draw_context->console = console;
-            draw_context->screen = console;
-            draw_context->view = view;
-            draw_context->cam = view->get_camera();
-            draw_context->num_lights = 0;
         } // simulation::update_context()
 
 
@@ -258,13 +369,95 @@ namespace gsgl
             // init world
             if (scenery)
                 init_node(scenery);
+
+            last_draw_tick = SDL_GetTicks();
+
+            if (THREADED_UPDATE)
+                start_update_thread();
         } // simulation::init()
+
+
+        void simulation::start_update_thread()
+        {
+            if (update_thread)
+                return;
+
+            tick_length = 1000 / gsgl::max_val(5, gsgl::min_val(static_cast<int>(UPDATE_RATE), 1000));
+            tick_due = SDL_GetTicks();
+            serial_frame = sim_context->frame;
+
+            update_thread = new simulation_thread(this);
+            update_thread->start();
+        } // simulation::start_update_thread()
+
+
+        void simulation::stop_update_thread()
+        {
+            if (update_thread)
+            {
+                update_thread->stop();
+                delete update_thread;
+                update_thread = 0;
+            }
+        } // simulation::stop_update_thread()
         
 
+        /// With the update thread running, this holds the state lock while it reads the latest snapshot of the scene graph, and copies the simulation context for draw().
+        /// Serial subtrees are updated here as well, since they need the thread that owns the OpenGL context.
         void simulation::pre_draw()
         {
-            BUDGET_SCOPE(L"pre-render");
-            node::pre_draw_scene(sim_context, draw_context, pre_rec);
+            PROFILE_SCOPE("pre-render");
+
+            unsigned long now = SDL_GetTicks();
+            frame_deltas[draw_frame++ % NUM_FRAME_DELTAS] = static_cast<gsgl::real_t>(now - last_draw_tick) / 1000.0f;
+            last_draw_tick = now;
+
+            if (update_thread)
+                state_lock.lock();
+
+            try
+            {
+                if (update_thread && serial_frame != sim_context->frame)
+                {
+                    for (int i = 0; i < serial_subtrees.size(); ++i)
+                    {
+                        update_node(serial_subtrees[i]);
+                        snapshot_node(serial_subtrees[i]);
+                    }
+
+                    serial_frame = sim_context->frame;
+                }
+
+                if (update_thread && tick_length)
+                {
+                    long since_tick = static_cast<long>(now - tick_due);
+                    draw_context->interpolation = gsgl::max_val(0.0f, gsgl::min_val(1.0f, static_cast<gsgl::real_t>(since_tick) / static_cast<gsgl::real_t>(tick_length)));
+                }
+                else
+                {
+                    draw_context->interpolation = 1;
+                }
+
+                draw_context->console = console;
+                draw_context->screen = console;
+                draw_context->view = view;
+                draw_context->cam = view->get_camera();
+                draw_context->num_lights = 0;
+
+                draw_t_time = sim_context->cur_t_time;
+                draw_sim_context = *sim_context;
+
+                node::pre_draw_scene(&draw_sim_context, draw_context, pre_rec);
+            }
+            catch (...)
+            {
+                if (update_thread)
+                    state_lock.unlock();
+                throw;
+            }
+
+            if (update_thread)
+                state_lock.unlock();
         } // simulation::pre_draw()
 
 
@@ -277,11 +470,11 @@ namespace gsgl
             draw_context->view = view;
             draw_context->cam = view->get_camera();
 
-            node::draw_scene(sim_context, draw_context, pre_rec);
+            node::draw_scene(&draw_sim_context, draw_context, pre_rec);
 
             // draw screen information
             {
-                BUDGET_SCOPE(L"sim info");
+                PROFILE_SCOPE("sim info");
 
                 // update fps info
                 gsgl::real_t avg_delta = 0.0f;
@@ -299,7 +492,7 @@ namespace gsgl
                 string rel = string::format(L"View Mode: %ls", view->is_relative() ? L"RELATIVE" : L"ABSOLUTE");
                 td.draw_2d(1.0f, console->get_height() - 2*height, info_font, rel);
 
-                struct tm *gmt = ::gmtime(&sim_context->cur_t_time);
+                struct tm *gmt = ::gmtime(&draw_t_time);
                 string utc(::asctime(gmt));
                 string date = string::format(L"%ls UTC", utc.trim().w_string());
                 td.draw_2d(1.0f, console->get_height() - 3*height, info_font, date);
@@ -312,18 +505,51 @@ namespace gsgl
 
         void simulation::update()
         {
-            update_context();
+            if (update_thread)
+            {
+                state_lock.lock();
+                string error = update_error;
+                state_lock.unlock();
+
+                if (!error.is_empty())
+                    throw runtime_exception(L"Error updating the simulation: %ls", error.w_string());
+
+                return;
+            }
+
+            tick(SDL_GetTicks());
+        } // simulation::update()
+
+
+        /// Advances the scene graph to \c cur_tick.  On the update thread, serial subtrees are left for pre_draw() and not included in the snapshot.
+        void simulation::tick(const unsigned long cur_tick)
+        {
+            PROFILE_SCOPE("physics: tick");
+
+            update_context(cur_tick);
 
-            frame_deltas[sim_context->frame % NUM_FRAME_DELTAS] = static_cast<gsgl::real_t>(sim_context->delta_tick) / 1000.0f;
+            serial_subtrees.clear();
             
             // update world
             if (time_scale != 0.0f && scenery)
-                update_node(scenery);
-        } // simulation::update()
+            {
+                for (gsgl::index_t i = 0; i < tick_listeners.size(); ++i)
+                    tick_listeners[i]->pre_update(sim_context);
+
+                if (PARALLEL_UPDATE && job_scheduler::global_instance())
+                    update_parallel();
+                else
+                    update_node(scenery, update_thread != 0);
+            }
+
+            if (scenery)
+                snapshot_node(scenery, update_thread != 0);
+        } // simulation::tick()
         
         
         void simulation::cleanup()
         {
+            stop_update_thread();
             cleanup_context();
 
             // cleanup world
@@ -336,6 +562,30 @@ namespace gsgl
 
 
         bool simulation::handle_event(sg_event & e)
+        {
+            if (!update_thread)
+                return handle_event_locked(e);
+
+            state_lock.lock();
+
+            bool result;
+
+            try
+            {
+                result = handle_event_locked(e);
+            }
+            catch (...)
+            {
+                state_lock.unlock();
+                throw;
+            }
+
+            state_lock.unlock();
+            return result;
+        } // simulation::handle_event()
+
+
+        bool simulation::handle_event_locked(sg_event & e)
         {
             switch (e.get_code())
             {
@@ -384,7 +634,7 @@ namespace gsgl
                 return handle_event(e, scenery);
             else
                 return false;
-        } // simulation::handle_event()
+        } // simulation::handle_event_locked()
 
 
         void simulation::init_node(node *n)
@@ -392,6 +642,7 @@ namespace gsgl
             assert(n);
 
             n->init(sim_context);
+            n->reset_snapshot();
             
             // update children
             for (simple_array<node *>::iterator i = n->get_children().iter(); i.is_valid(); ++i)
@@ -399,23 +650,144 @@ namespace gsgl
         } // simulation::init_node()
         
         
-        static const string PHYSICS_CATEGORY = L"physics: ";
-
-        void simulation::update_node(node *n)
+        void simulation::update_node(node *n, const bool defer_serial)
         {
-            assert(n);
-
+            if (defer_serial && n->get_update_mode() == node::NODE_UPDATE_SERIAL)
             {
-                BUDGET_SCOPE(PHYSICS_CATEGORY + n->get_type_name());
-                n->update(sim_context);
+                serial_subtrees.append(n);
+                return;
             }
+
+            update_single_node(n);
                         
             //
             for (simple_array<node *>::iterator i = n->get_children().iter(); i.is_valid(); ++i)
-                update_node(*i);
+                update_node(*i, defer_serial);
         } // simulation::update_node()
 
 
+        void simulation::snapshot_node(node *n, const bool defer_serial)
+        {
+            if (defer_serial && n->get_update_mode() == node::NODE_UPDATE_SERIAL)
+                return;
+
+            n->take_snapshot();
+
+            for (simple_array<node *>::iterator i = n->get_children().iter(); i.is_valid(); ++i)
+                snapshot_node(*i, defer_serial);
+        } // simulation::snapshot_node()
+
+
+        void simulation::update_single_node(node *n)
+        {
+            assert(n);
+
+            PROFILE_SCOPE_ID(n->get_update_scope());
+            n->update(sim_context);
+        } // simulation::update_single_node()
+
+
+        /// Counts the nodes in a subtree, and whether any of them must be updated serially.
+        static gsgl::index_t count_subtree(node *n, bool & has_serial)
+        {
+            gsgl::index_t count = 1;
+
+            if (n->get_update_mode() == node::NODE_UPDATE_SERIAL)
+                has_serial = true;
+
+            for (simple_array<node *>::iterator i = n->get_children().iter(); i.is_valid(); ++i)
+                count += count_subtree(*i, has_serial);
+
+            return count;
+        } // count_subtree()
+
+
+        /// Sorts the children of a spine node: small subtrees are updated as a unit on a worker thread, and big ones (or ones containing serial nodes) become part of the spine and are split up further.
+        void simulation::partition_update(node *n, const gsgl::index_t max_subtree_size)
+        {
+            for (simple_array<node *>::iterator i = n->get_children().iter(); i.is_valid(); ++i)
+            {
+                node *child = *i;
+
+                if (child->get_update_mode() == node::NODE_UPDATE_SERIAL)
+                {
+                    serial_subtrees.append(child);
+                    continue;
+                }
+
+                bool has_serial = false;
+                gsgl::index_t size = count_subtree(child, has_serial);
+
+                if (has_serial || (size > max_subtree_size && child->get_children().size()))
+                {
+                    update_spine.append(child);
+                    partition_update(child, max_subtree_size);
+                }
+                else
+                {
+                    update_subtrees.append(child);
+                }
+            }
+        } // simulation::partition_update()
+
+
+        struct update_subtrees_body
+        {
+            simulation *sim;
+
+            void operator() (gsgl::index_t begin, gsgl::index_t end) const
+            {
+                for (gsgl::index_t i = begin; i < end; ++i)
+                    sim->update_node(sim->update_subtrees[i]);
+            }
+        }; // struct update_subtrees_body
+
+
+        /// Updates the spine of the scene graph on this thread, then the independent subtrees hanging off it concurrently, then the subtrees that must be updated serially.
+        /// This keeps the ordering contract in node: each node is updated after its parent, and sibling subtrees never see each other half-updated.
+        void simulation::update_parallel()
+        {
+            job_scheduler *jobs = job_scheduler::global_instance();
+
+            update_spine.clear();
+            update_subtrees.clear();
+
+            if (scenery->get_update_mode() == node::NODE_UPDATE_SERIAL)
+            {
+                update_node(scenery, update_thread != 0);
+                return;
+            }
+
+            bool has_serial = false;
+            gsgl::index_t total = count_subtree(scenery, has_serial);
+            gsgl::index_t max_subtree_size = gsgl::max_val<gsgl::index_t>(1, total / gsgl::max_val<gsgl::index_t>(1, jobs->get_num_workers() * SUBTREES_PER_WORKER));
+
+            update_spine.append(scenery);
+            partition_update(scenery, max_subtree_size);
+
+            // spine
+            for (int i = 0; i < update_spine.size(); ++i)
+                update_single_node(update_spine[i]);
+
+            // independent subtrees
+            {
+                PROFILE_SCOPE("physics: parallel subtrees");
+
+                update_subtrees_body body;
+                body.sim = this;
+
+                parallel_for(*jobs, 0, update_subtrees.size(), body, 1);
+            }
+
+            // serial subtrees (the update thread leaves these for pre_draw())
+            if (!update_thread)
+            {
+                for (int i = 0; i < serial_subtrees.size(); ++i)
+                    update_node(serial_subtrees[i]);
+            }
+        } // simulation::update_parallel()
+
+
         void simulation::cleanup_node(node *n)
         {
             assert(n);
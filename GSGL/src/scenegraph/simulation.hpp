@@ -41,6 +41,7 @@
 
 #include "platform/display.hpp"
 #include "platform/font.hpp"
+#include "platform/thread.hpp"
 
 #include "data/pointer.hpp"
 #include "data/config.hpp"
@@ -52,6 +53,20 @@ namespace gsgl
 
     namespace scenegraph
     {
+
+        class simulation_thread;
+
+
+        /// Something that needs to run once per tick, before the scene graph is updated (e.g. a system that moves many nodes at once).
+        class SCENEGRAPH_API tick_listener
+        {
+        public:
+            virtual ~tick_listener() {}
+
+            /// Called on the thread that updates the scene graph, before any nodes are updated.  Not called while the simulation is paused.
+            virtual void pre_update(const simulation_context *c) = 0;
+        }; // class tick_listener
+
     
         /// Encapsulates a simulation.
         class SCENEGRAPH_API simulation
@@ -75,6 +90,30 @@ namespace gsgl
             data::simple_array<gsgl::real_t> frame_deltas;
 
             node::pre_draw_rec pre_rec;
+            simulation_context draw_sim_context; ///< A copy of the simulation context, taken with the draw list, for draw() to use while the update thread changes the original.
+
+            /// \name Parallel update partition.
+            /// Rebuilt every frame, so it follows changes to the scene graph.
+            /// @{
+            data::simple_array<node *> update_spine;    ///< Nodes updated on the simulation thread first, parents before children.
+            data::simple_array<node *> update_subtrees; ///< Roots of subtrees that are updated concurrently once the spine is done.
+            data::simple_array<node *> serial_subtrees; ///< Roots of subtrees that are updated on the simulation thread last.
+            /// @}
+
+            /// \name Update thread.
+            /// When scenegraph/simulation/threaded_update is set, the scene graph is updated on its own thread at a fixed tick, and drawn by interpolating between the last two ticks.
+            /// @{
+            simulation_thread *update_thread;  ///< Null if the scene graph is updated from the main loop.
+            platform::mutex    state_lock;     ///< Held by the update thread for each tick, and by the main thread while it reads or changes the scene graph.
+            unsigned long      tick_length;    ///< The length of a tick (in milliseconds).
+            unsigned long      tick_due;       ///< The real time (in SDL ticks) at which the latest tick was due.
+            unsigned long      serial_frame;   ///< The frame for which the serial subtrees were last updated.
+            string             update_error;   ///< The message of an exception thrown on the update thread.
+            /// @}
+
+            unsigned long draw_frame;     ///< The number of frames drawn (for the frame rate display).
+            unsigned long last_draw_tick; ///< The real time (in SDL ticks) at which the last frame was drawn.
+            time_t draw_t_time;           ///< The simulation time displayed with the current frame.
 
         public:
             simulation(const data::config_record & sim_config, 
@@ -92,20 +131,39 @@ namespace gsgl
             void pre_draw(); ///< This is called at the beginning of each frame.  It records drawing information for all the nodes in the scene graph.
 
             void draw();     ///< This is called to draw the frame.  It may be called concurrently with update(), which is updating the next frame while the current one is being drawn.
-            void update();   ///< This is called to update the scene graph.  It may be called concurrently with draw(), which is drawing the previous frame.
+            void update();   ///< This is called once per frame.  It updates the scene graph by the time since the last call or, if the scene graph is updated on its own thread, just reports errors from that thread.
             void cleanup();  ///< This is called at the end of the simulation.
             
             bool handle_event(sg_event & e); ///< This is called to pass events to the scene graph after they have been left unhandled by the UI.
+
+            bool is_threaded() const { return update_thread != 0; }
+
+            /// Listeners should be added and removed while the scene graph is not being updated (e.g. from node::init() or a node's destructor).
+            /// A listener added with \c first set is called before those already added (e.g. a cache that other listeners read).
+            static void add_tick_listener(tick_listener *listener, const bool first = false);
+            static void remove_tick_listener(tick_listener *listener);
             
         private:
             void init_context();
-            void update_context();
+            void update_context(const unsigned long cur_tick);
             void cleanup_context();
 
+            void start_update_thread();
+            void stop_update_thread();
+            void tick(const unsigned long cur_tick);
+
             void init_node(scenegraph::node *n);
-            void update_node(scenegraph::node *n);
+            void update_node(scenegraph::node *n, const bool defer_serial = false);
+            void snapshot_node(scenegraph::node *n, const bool defer_serial = false);
+            void update_single_node(scenegraph::node *n);
+            void update_parallel();
+            void partition_update(scenegraph::node *n, const gsgl::index_t max_subtree_size);
             void cleanup_node(scenegraph::node *n);
+            bool handle_event_locked(sg_event & e);
             bool handle_event(sg_event & e, node *n);
+
+            friend struct update_subtrees_body;
+            friend class simulation_thread;
         }; // class simulation
 
 
@@ -323,13 +323,13 @@ namespace gsgl
 
             vector pos_in_eye_space(node *frame, const vector & p)
             {
-                return frame->get_modelview() * p;
+                return frame->get_modelview().transform_point(p);
             } // pos_in_eye_space()
 
 
             gsgl::real_t dot_in_eye_space(node *frame, const vector & pos)
             {
-                vector eye_dir = frame->get_modelview() * pos;
+                vector eye_dir = frame->get_modelview().transform_point(pos);
                 eye_dir.normalize();
 
                 return eye_dir.dot(vector::NEG_Z_AXIS);
@@ -343,7 +343,7 @@ namespace gsgl
                 if (frame->get_draw_flags() & node::NODE_NO_FRUSTUM_CHECK)
                     return true;
 
-                vector eye_dir = frame->get_modelview() * pos;
+                vector eye_dir = frame->get_modelview().transform_point(pos);
                 double dist = eye_dir.mag();
 
                 eye_dir.normalize();
@@ -416,7 +416,7 @@ namespace gsgl
             void draw_billboard(node *frame, const vector & pos, const gsgl::real_t radius)
             {
                 // get target position in eye space
-                vector eye_pos = frame->get_modelview() * pos;
+                vector eye_pos = frame->get_modelview().transform_point(pos);
                 
                 // normalize to get the billboard front (in eye space)
                 vector front = eye_pos; // vector::NEG_Z_AXIS;
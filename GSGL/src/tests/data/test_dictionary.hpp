@@ -255,6 +255,51 @@ namespace test
         }; // class dict_left
 
 
+        //
+
+
+        class dict_large
+        {
+            gsgl::data::dictionary<int, int> d;
+
+        public:
+            dict_large()
+            {
+                // sorted insertion used to degrade the tree into a list
+                for (int i = 0; i < 4096; ++i)
+                    d[i] = i;
+            } // dict_large()
+
+
+            void test_size()
+            {
+                TEST_ASSERT(d.size() == 4096);
+            } // test_size()
+
+
+            void test_remove()
+            {
+                for (int i = 0; i < 4096; i += 2)
+                    d.remove(i);
+
+                TEST_ASSERT(d.size() == 2048);
+
+                int n = 1;
+                for (gsgl::data::dictionary<int, int>::iterator i = d.iter(); i.is_valid(); n += 2, ++i)
+                {
+                    TEST_ASSERT(*i == n);
+                }
+                TEST_ASSERT(n == 4097);
+
+                for (int i = 0; i < 4096; ++i)
+                {
+                    TEST_ASSERT(d.contains_index(i) == ((i % 2) != 0));
+                }
+            } // test_remove()
+
+        }; // class dict_large
+
+
         class dict_remove
         {
             gsgl::data::dictionary<int, gsgl::string> d;
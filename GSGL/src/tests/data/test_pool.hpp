@@ -0,0 +1,154 @@
+#ifndef GSGL_TEST_DATA_POOL_H
+#define GSGL_TEST_DATA_POOL_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "data/pool.hpp"
+
+#include "unit_tester.hpp"
+
+namespace test
+{
+
+    namespace data
+    {
+
+        struct pool_counted
+        {
+            static int num_live;
+            int value;
+
+            pool_counted() : value(0) { ++num_live; }
+            ~pool_counted() { --num_live; }
+        }; // struct pool_counted
+
+        int pool_counted::num_live = 0;
+
+
+        class pool_basic
+        {
+            gsgl::data::pool<pool_counted> p;
+
+        public:
+            pool_basic()
+                : p(8, 8)
+            {
+                pool_counted::num_live = 0;
+            } // pool_basic()
+
+
+            void test_reuse()
+            {
+                pool_counted *a = p.allocate();
+                pool_counted *b = p.allocate();
+                TEST_ASSERT(p.size() == 2);
+                TEST_ASSERT(pool_counted::num_live == 2);
+
+                p.deallocate(a);
+                TEST_ASSERT(p.size() == 1);
+                TEST_ASSERT(pool_counted::num_live == 1);
+
+                // the most recently freed slot is handed out first
+                pool_counted *c = p.allocate();
+                TEST_ASSERT(c == a);
+                TEST_ASSERT(c != b);
+            } // test_reuse()
+
+
+            void test_many()
+            {
+                pool_counted *objs[100];
+
+                for (int i = 0; i < 100; ++i)
+                {
+                    objs[i] = p.allocate();
+                    objs[i]->value = i;
+                }
+
+                for (int i = 0; i < 100; i += 2)
+                    p.deallocate(objs[i]);
+
+                TEST_ASSERT(p.size() == 50);
+                TEST_ASSERT(pool_counted::num_live == 50);
+
+                for (int i = 1; i < 100; i += 2)
+                    TEST_ASSERT(objs[i]->value == i);
+            } // test_many()
+
+
+            void test_reset()
+            {
+                for (int i = 0; i < 100; ++i)
+                    p.allocate();
+
+                p.reset();
+                TEST_ASSERT(p.size() == 0);
+                TEST_ASSERT(pool_counted::num_live == 0);
+
+                p.allocate();
+                TEST_ASSERT(pool_counted::num_live == 1);
+            } // test_reset()
+
+        }; // class pool_basic
+
+
+        class pool_teardown
+        {
+        public:
+            pool_teardown() {}
+
+            void test_destructor()
+            {
+                pool_counted::num_live = 0;
+
+                {
+                    gsgl::data::pool<pool_counted> p;
+                    pool_counted *objs[100];
+
+                    for (int i = 0; i < 100; ++i)
+                        objs[i] = p.allocate();
+                    for (int i = 0; i < 100; i += 3)
+                        p.deallocate(objs[i]);
+                }
+
+                TEST_ASSERT(pool_counted::num_live == 0);
+            } // test_destructor()
+
+        }; // class pool_teardown
+
+    } // namespace data
+
+} // namespace test
+
+#endif
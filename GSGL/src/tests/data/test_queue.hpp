@@ -35,6 +35,7 @@
 //
 
 #include "data/queue.hpp"
+#include "data/pqueue.hpp"
 
 #include "unit_tester.hpp"
 
@@ -99,6 +100,59 @@ namespace test
 
         }; // class simple_queue_basic
 
+
+        class pqueue_basic
+        {
+            gsgl::data::pqueue<int, float> pq;
+
+        public:
+            pqueue_basic()
+            {
+                for (int i = 0; i < 100; ++i)
+                {
+                    int n = (i * 37) % 100;
+                    pq.push(n, static_cast<float>(n));
+                }
+            } // pqueue_basic()
+
+
+            void test_order()
+            {
+                TEST_ASSERT(pq.size() == 100);
+
+                for (int i = 0; i < 100; ++i)
+                {
+                    TEST_ASSERT(pq[i] == 99 - i);
+                }
+            } // test_order()
+
+
+            void test_pop()
+            {
+                for (int i = 99; i >= 50; --i)
+                {
+                    TEST_ASSERT(pq.front() == i);
+                    pq.pop();
+                }
+
+                pq.push(200, 200.0f);
+                pq.push(-1, -1.0f);
+                TEST_ASSERT(pq.front() == 200);
+                TEST_ASSERT(pq.size() == 52);
+
+                int n = 0;
+                for (gsgl::data::pqueue<int, float>::iterator i = pq.iter(); i.is_valid(); ++i, ++n)
+                {
+                    if (n == 0)
+                        TEST_ASSERT(*i == 200);
+                    else
+                        TEST_ASSERT(*i == 50 - n);
+                }
+                TEST_ASSERT(n == 52);
+            } // test_pop()
+
+        }; // class pqueue_basic
+
     } // namespace data
 
 } // namespace test
@@ -0,0 +1,133 @@
+#ifndef GSGL_TEST_MATH_DVECTOR_H
+#define GSGL_TEST_MATH_DVECTOR_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "math/dvector.hpp"
+#include "math/quaternion.hpp"
+
+#include "unit_tester.hpp"
+
+#include <cmath>
+
+namespace test
+{
+
+    namespace math
+    {
+
+        class dvectors
+        {
+        public:
+
+            void test_arithmetic()
+            {
+                using namespace gsgl::math;
+
+                dvector a(1, 2, 3), b(0.5, -4, 8);
+
+                TEST_ASSERT(a + b == dvector(1.5, -2, 11));
+                TEST_ASSERT(a - b == dvector(0.5, 6, -5));
+                TEST_ASSERT(-a == dvector(-1, -2, -3));
+                TEST_ASSERT(a * 2.0 == dvector(2, 4, 6));
+                TEST_ASSERT(!(a == b));
+
+                dvector c = a;
+                c += b;
+                TEST_ASSERT(c == a + b);
+                c -= b;
+                TEST_ASSERT(c == a);
+
+                TEST_ASSERT(dvector(3, 4, 12).mag2() == 169);
+                TEST_ASSERT(dvector(3, 4, 12).mag() == 13);
+
+                TEST_ASSERT(dvector::interpolate(a, b, 0) == a);
+                TEST_ASSERT(dvector::interpolate(a, b, 1) == b);
+                TEST_ASSERT(dvector::interpolate(a, b, 0.5) == dvector(0.75, -1, 5.5));
+
+                vector v = dvector(vector(1.5f, -2.25f, 3)).to_vector();
+                TEST_ASSERT(v.get_x() == 1.5f && v.get_y() == -2.25f && v.get_z() == 3);
+            } // test_arithmetic()
+
+
+            void test_precision()
+            {
+                using namespace gsgl::math;
+
+                // a quarter of a meter an astronomical unit out is lost in a float, but not in the difference of two dvectors
+                const double au = 1.495978707e11;
+                dvector far_away(au + 0.25, -au, au - 0.5);
+                dvector origin(au, -au, au);
+
+                TEST_ASSERT(far_away.to_vector().get_x() == static_cast<gsgl::real_t>(au));
+
+                vector offset = (far_away - origin).to_vector();
+                TEST_ASSERT(offset.get_x() == 0.25f);
+                TEST_ASSERT(offset.get_y() == 0);
+                TEST_ASSERT(offset.get_z() == -0.5f);
+            } // test_precision()
+
+
+            void test_rotate_by()
+            {
+                using namespace gsgl::math;
+
+                transform r(quaternion(vector(1, 2, 3) / vector(1, 2, 3).mag(), 0.7));
+                vector v(0.5f, -1.25f, 2);
+
+                // matches the float rotation, and ignores any translation
+                vector expected = r.transform_direction(v);
+                dvector rotated = dvector(v).rotate_by(transform::rigid(r, vector(100, 200, 300)));
+
+                TEST_ASSERT(::fabs(rotated.get_x() - expected.get_x()) < 1e-6);
+                TEST_ASSERT(::fabs(rotated.get_y() - expected.get_y()) < 1e-6);
+                TEST_ASSERT(::fabs(rotated.get_z() - expected.get_z()) < 1e-6);
+                TEST_ASSERT(::fabs(rotated.mag() - dvector(v).mag()) < 1e-6);
+
+                // the products are taken in double precision, so an exact quarter turn about z loses nothing
+                const double au = 1.495978707e11;
+                transform quarter(transform::IDENTITY);
+                quarter.set_basis_x(0, 1, 0);
+                quarter.set_basis_y(-1, 0, 0);
+
+                TEST_ASSERT(dvector(au + 0.25, au - 0.5, 3).rotate_by(quarter) == dvector(0.5 - au, au + 0.25, 3));
+            } // test_rotate_by()
+
+        }; // class dvectors
+
+    } // namespace math
+
+} // namespace test
+
+#endif
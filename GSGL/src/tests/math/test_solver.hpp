@@ -0,0 +1,181 @@
+#ifndef GSGL_TEST_MATH_SOLVER_H
+#define GSGL_TEST_MATH_SOLVER_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "math/solver.hpp"
+
+#include "unit_tester.hpp"
+
+#include <cmath>
+
+namespace test
+{
+
+    namespace math
+    {
+
+        /// A unit harmonic oscillator, x'' = -x.
+        struct oscillator_state
+        {
+            double x, p;
+
+            oscillator_state(const double & x = 0, const double & p = 0) : x(x), p(p) {}
+
+            oscillator_state operator+ (const oscillator_state & s) const { return oscillator_state(x + s.x, p + s.p); }
+            oscillator_state operator* (const double & n) const { return oscillator_state(x * n, p * n); }
+            oscillator_state derivative(const double & t) const { return oscillator_state(p, -x); }
+
+            double norm() const { return ::fabs(x) > ::fabs(p) ? ::fabs(x) : ::fabs(p); }
+
+            oscillator_state drift(const double & dt) const { return oscillator_state(x + p*dt, p); }
+            oscillator_state kick(const double & t, const double & dt) const { return oscillator_state(x, p - x*dt); }
+
+            double energy() const { return 0.5 * (x*x + p*p); }
+        }; // struct oscillator_state
+
+
+        /// Two unit harmonic oscillators in a flat array, for the in-place solvers.
+        struct oscillator_system
+        {
+            void derivative(const double & t, const double *x, double *dxdt)
+            {
+                for (int i = 0; i < 4; i += 2)
+                {
+                    dxdt[i] = x[i+1];
+                    dxdt[i+1] = -x[i];
+                }
+            } // derivative()
+        }; // struct oscillator_system
+
+
+        class solvers
+        {
+        public:
+
+            void test_dormand_prince()
+            {
+                using namespace gsgl::math;
+
+                dormand_prince_solver<oscillator_state> dp(1e-9, 1e-9);
+
+                // one long frame, sub-stepped internally
+                oscillator_state s = dp.next(oscillator_state(1, 0), 0, 20.0);
+                TEST_ASSERT(::fabs(s.x - ::cos(20.0)) < 1e-6);
+
+                // dense output within a single step
+                dormand_prince_solver<oscillator_state> coarse(1e-3, 1e-3);
+                s = coarse.next(oscillator_state(1, 0), 0, 0.3);
+                TEST_ASSERT(coarse.get_num_evaluations() == 7);
+                TEST_ASSERT(::fabs(coarse.interpolate(0.15).x - ::cos(0.15)) < 1e-5);
+                TEST_ASSERT(::fabs(coarse.interpolate(0.3).x - s.x) < 1e-12);
+            } // test_dormand_prince()
+
+
+            void test_symplectic()
+            {
+                using namespace gsgl::math;
+
+                substep_solver<oscillator_state> yoshida(new yoshida_solver<oscillator_state>(), 0.05);
+                substep_solver<oscillator_state> leapfrog(new leapfrog_solver<oscillator_state>(), 0.01);
+
+                oscillator_state a(1, 0), b(1, 0);
+                for (int i = 0; i < 100; ++i)
+                {
+                    a = yoshida.next(a, i, 1.0);
+                    b = leapfrog.next(b, i, 1.0);
+                }
+
+                TEST_ASSERT(::fabs(a.x - ::cos(100.0)) < 1e-4);
+                TEST_ASSERT(::fabs(a.energy() - 0.5) < 1e-6);
+                TEST_ASSERT(::fabs(b.energy() - 0.5) < 1e-4);
+            } // test_symplectic()
+
+
+
+            void test_in_place()
+            {
+                using namespace gsgl::math;
+
+                runge_kutta_solver<oscillator_state> rk;
+                in_place_runge_kutta_solver<oscillator_system> in_place;
+                oscillator_system sys;
+
+                oscillator_state s(1, 0);
+                double x[4] = { 1, 0, 0.5, 0.25 };
+
+                for (int i = 0; i < 100; ++i)
+                {
+                    s = rk.next(s, i * 0.1, 0.1);
+                    in_place.step(sys, x, 4, i * 0.1, 0.1);
+                }
+
+                // the same arithmetic, give or take rounding
+                TEST_ASSERT(::fabs(x[0] - s.x) < 1e-12);
+                TEST_ASSERT(::fabs(x[1] - s.p) < 1e-12);
+            } // test_in_place()
+
+
+            void test_in_place_dormand_prince()
+            {
+                using namespace gsgl::math;
+
+                dormand_prince_solver<oscillator_state> dp(1e-9, 1e-9);
+                in_place_dormand_prince_solver<oscillator_system> in_place(1e-9, 1e-9);
+                oscillator_system sys;
+
+                // two copies of the same oscillator have the same norm, so both solvers pick the same sub-steps
+                oscillator_state s(1, 0);
+                double x[4] = { 1, 0, 1, 0 };
+
+                for (int i = 0; i < 10; ++i)
+                {
+                    s = dp.next(s, i * 2.0, 2.0);
+                    in_place.step(sys, x, 4, i * 2.0, 2.0);
+                }
+
+                TEST_ASSERT(in_place.get_num_evaluations() == dp.get_num_evaluations());
+                TEST_ASSERT(::fabs(x[0] - s.x) < 1e-12);
+                TEST_ASSERT(::fabs(x[1] - s.p) < 1e-12);
+                TEST_ASSERT(x[2] == x[0] && x[3] == x[1]);
+                TEST_ASSERT(::fabs(x[0] - ::cos(20.0)) < 1e-6);
+            } // test_in_place_dormand_prince()
+
+        }; // class solvers
+
+    } // namespace math
+
+} // namespace test
+
+#endif
@@ -36,6 +36,7 @@
 
 #include "math/transform.hpp"
 #include "math/quaternion.hpp"
+#include "math/batch.hpp"
 
 #include "unit_tester.hpp"
 
@@ -120,6 +121,149 @@ namespace test
 
         }; // class points
 
+
+        class kernels
+        {
+            static bool close(gsgl::real_t a, gsgl::real_t b)
+            {
+                gsgl::real_t d = a - b;
+                return d < 1e-4f && d > -1e-4f;
+            } // close()
+
+        public:
+
+            void test_multiply()
+            {
+                using namespace gsgl::math;
+
+                gsgl::real_t da[16], db[16];
+                for (int k = 0; k < 16; ++k)
+                {
+                    da[k] = static_cast<gsgl::real_t>(k + 1);
+                    db[k] = static_cast<gsgl::real_t>(16 - k) * 0.5f;
+                }
+
+                transform a(da), b(db);
+                transform c = a * b;
+
+                for (int i = 0; i < 4; ++i)
+                {
+                    for (int j = 0; j < 4; ++j)
+                    {
+                        gsgl::real_t expected = 0;
+                        for (int r = 0; r < 4; ++r)
+                            expected += a.item(i, r) * b.item(r, j);
+                        TEST_ASSERT(close(c.item(i, j), expected));
+                    }
+                }
+
+                // the result may alias an operand
+                gsgl::math::matrix_utils::multiply<4,4,4,4,gsgl::real_t>(a, b, a);
+                TEST_ASSERT(a == c);
+            } // test_multiply()
+
+
+            void test_transpose()
+            {
+                using namespace gsgl::math;
+
+                gsgl::real_t da[16];
+                for (int k = 0; k < 16; ++k)
+                    da[k] = static_cast<gsgl::real_t>(k);
+
+                transform a(da);
+                transform t = a.transpose();
+
+                for (int i = 0; i < 4; ++i)
+                    for (int j = 0; j < 4; ++j)
+                        TEST_ASSERT(t.item(i, j) == a.item(j, i));
+            } // test_transpose()
+
+
+            void test_affine()
+            {
+                using namespace gsgl::math;
+
+                quaternion q(vector::Z_AXIS, static_cast<gsgl::real_t>(30.0 * DEG2RAD));
+                transform t = transform::translation_transform(vector(1, 2, 3)) * transform(q);
+
+                vector p(4, 5, 6);
+                vector general = t * p;
+                vector affine = t.transform_point(p);
+
+                TEST_ASSERT(close(general.get_x(), affine.get_x()));
+                TEST_ASSERT(close(general.get_y(), affine.get_y()));
+                TEST_ASSERT(close(general.get_z(), affine.get_z()));
+                TEST_ASSERT(affine.get_w() == 1);
+
+                vector d = t.transform_direction(vector::X_AXIS);
+                vector r = transform(q) * vector::X_AXIS;
+                TEST_ASSERT(close(d.get_x(), r.get_x()));
+                TEST_ASSERT(close(d.get_y(), r.get_y()));
+                TEST_ASSERT(close(d.get_z(), r.get_z()));
+            } // test_affine()
+
+
+            void test_rigid()
+            {
+                using namespace gsgl::math;
+
+                vector axis(1, 2, 3);
+                axis.normalize();
+
+                transform r(quaternion(axis, static_cast<gsgl::real_t>(40.0 * DEG2RAD)));
+                vector t(5, -6, 7);
+
+                transform m = transform::rigid(r, t);
+                transform expected = transform::translation_transform(t) * r;
+                for (int k = 0; k < 16; ++k)
+                    TEST_ASSERT(close(m[k], expected[k]));
+
+                transform inv = m.rigid_inverse();
+                transform general = m.inverse();
+                for (int k = 0; k < 16; ++k)
+                    TEST_ASSERT(close(inv[k], general[k]));
+
+                transform id = m * inv;
+                for (int k = 0; k < 16; ++k)
+                    TEST_ASSERT(close(id[k], transform::IDENTITY[k]));
+            } // test_rigid()
+
+
+            void test_batch()
+            {
+                using namespace gsgl::math;
+
+                transform t = transform::rigid(transform(quaternion(vector::Y_AXIS, 1.0)), vector(10, 20, 30));
+
+                // an odd count exercises both the 4-wide and the leftover paths
+                const int N = 7;
+                float x[N], y[N], z[N], out_x[N], out_y[N], out_z[N];
+                for (int i = 0; i < N; ++i)
+                {
+                    x[i] = static_cast<float>(i);
+                    y[i] = static_cast<float>(i * 2 - 5);
+                    z[i] = static_cast<float>(3 - i);
+                }
+
+                batch::transform_points(t, N, x, y, z, out_x, out_y, out_z);
+
+                for (int i = 0; i < N; ++i)
+                {
+                    vector expected = t.transform_point(vector(x[i], y[i], z[i]));
+                    TEST_ASSERT(close(out_x[i], expected.get_x()));
+                    TEST_ASSERT(close(out_y[i], expected.get_y()));
+                    TEST_ASSERT(close(out_z[i], expected.get_z()));
+                }
+
+                batch::transform_normals(t, N, x, y, z, x, y, z);
+
+                for (int i = 0; i < N; ++i)
+                    TEST_ASSERT(close(x[i], out_x[i] - 10));
+            } // test_batch()
+
+        }; // class kernels
+
     } // namespace math
 
 } // namespace test
@@ -0,0 +1,115 @@
+#ifndef GSGL_TEST_PHYSICS_RIGID_BODY_H
+#define GSGL_TEST_PHYSICS_RIGID_BODY_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "physics/rigid_body.hpp"
+#include "scenegraph/context.hpp"
+
+#include "unit_tester.hpp"
+
+#include <cmath>
+
+namespace test
+{
+
+    namespace physics
+    {
+
+        /// A free body with unit mass and inertia.
+        class free_body
+            : public gsgl::physics::rigid_body
+        {
+        public:
+            free_body() : gsgl::physics::rigid_body(L"free body", 0) {}
+
+            gsgl::math::transform calculate_inertia_tensor(gsgl::math::vector & center_of_mass)
+            {
+                center_of_mass = gsgl::math::vector::ZERO;
+                return gsgl::math::transform::IDENTITY;
+            } // calculate_inertia_tensor()
+
+            void calculate_force_and_torque(const double & t, gsgl::math::vector & force, gsgl::math::vector & torque)
+            {
+                force = gsgl::math::vector::ZERO;
+                torque = gsgl::math::vector::ZERO;
+            } // calculate_force_and_torque()
+        }; // class free_body
+
+
+        class rigid_body
+        {
+        public:
+
+            void test_long_spin()
+            {
+                using namespace gsgl::math;
+
+                const gsgl::real_t spin = 0.01f;
+                const double dt = 2000;
+
+                free_body body;
+                body.get_angular_velocity() = vector(0, 0, spin);
+                body.init(0);
+
+                // a single tick long enough to turn the body many times over
+                gsgl::scenegraph::simulation_context c;
+                c.cur_time = 0;
+                c.delta_time = dt;
+                body.update(&c);
+
+                transform expected(quaternion(vector::Z_AXIS, spin * dt));
+                const transform & r = body.get_orientation();
+
+                for (int i = 0; i < 3; ++i)
+                {
+                    for (int j = 0; j < 3; ++j)
+                    {
+                        gsgl::real_t value = r.item(i, j);
+                        TEST_ASSERT(value == value);
+                        TEST_ASSERT(::fabs(value - expected.item(i, j)) < 1e-4);
+                    }
+                }
+
+                vector w = body.get_angular_velocity();
+                TEST_ASSERT(::fabs(w.get_z() - spin) < 1e-6);
+            } // test_long_spin()
+
+        }; // class rigid_body
+
+    } // namespace physics
+
+} // namespace test
+
+#endif
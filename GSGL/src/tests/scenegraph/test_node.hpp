@@ -0,0 +1,152 @@
+#ifndef GSGL_TEST_SCENEGRAPH_NODE_H
+#define GSGL_TEST_SCENEGRAPH_NODE_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "scenegraph/node.hpp"
+#include "math/quaternion.hpp"
+
+#include "unit_tester.hpp"
+
+#include <cmath>
+
+namespace test
+{
+
+    namespace scenegraph
+    {
+
+        class draw_frames
+        {
+            gsgl::scenegraph::node *root, *planet, *ship, *camera;
+
+        public:
+            draw_frames()
+            {
+                using namespace gsgl::math;
+                using gsgl::scenegraph::node;
+
+                // a scaled, rotated frame near the origin, with a rotated node and the camera in it
+                root = new node(L"root", 0);
+
+                planet = new node(L"planet", root);
+                planet->get_scale() = 10;
+                planet->set_translation(dvector(3, -2, 1.5));
+                planet->get_orientation() = transform(quaternion(vector(1, 1, 0) / vector(1, 1, 0).mag(), 0.6));
+
+                ship = new node(L"ship", planet);
+                ship->set_translation(dvector(0.5, 0.25, -0.125));
+                ship->get_orientation() = transform(quaternion(vector::X_AXIS, 1.1));
+
+                camera = new node(L"camera", planet);
+                camera->set_translation(dvector(-0.25, 0.5, 0.75));
+                camera->get_orientation() = transform(quaternion(vector::Z_AXIS, -0.4));
+
+                planet->reset_snapshot();
+                ship->reset_snapshot();
+                camera->reset_snapshot();
+            } // draw_frames()
+
+            ~draw_frames()
+            {
+                delete root;
+            } // ~draw_frames()
+
+
+            void test_matches_float_path()
+            {
+                check_modelview(ship);
+                check_modelview(planet);
+                check_modelview(root);
+                check_modelview(camera);
+            } // test_matches_float_path()
+
+        private:
+            /// Compares the floating-origin modelview with the one the single-precision path builds by walking out from the camera.
+            void check_modelview(gsgl::scenegraph::node *n)
+            {
+                using namespace gsgl::math;
+
+                transform floating = gsgl::scenegraph::node::get_floating_modelview(camera, n, 1);
+                transform expected = float_modelview(n);
+
+                for (int i = 0; i < 4; ++i)
+                {
+                    for (int j = 0; j < 4; ++j)
+                        TEST_ASSERT(::fabs(floating.item(i, j) - expected.item(i, j)) < 1e-4);
+                }
+            } // check_modelview()
+
+
+            /// Composes the transforms the way node::build_draw_list() does: up from the camera to the common ancestor, then down to \c n.
+            gsgl::math::transform float_modelview(gsgl::scenegraph::node *n)
+            {
+                using namespace gsgl::math;
+                using gsgl::scenegraph::node;
+
+                transform up = transform::IDENTITY;
+                node *ancestor = camera;
+
+                while (!is_ancestor(ancestor, n))
+                {
+                    up = up * transform::inverse_rigid(ancestor->get_draw_orientation(1), ancestor->get_draw_translation(1) * ancestor->get_parent()->get_scale());
+                    ancestor = ancestor->get_parent();
+                }
+
+                transform down = transform::IDENTITY;
+                for (node *cur = n; cur != ancestor; cur = cur->get_parent())
+                    down = transform::rigid(cur->get_draw_orientation(1), cur->get_draw_translation(1) * cur->get_parent()->get_scale()) * down;
+
+                return up * down;
+            } // float_modelview()
+
+
+            static bool is_ancestor(gsgl::scenegraph::node *a, gsgl::scenegraph::node *n)
+            {
+                for (; n; n = n->get_parent())
+                {
+                    if (n == a)
+                        return true;
+                }
+
+                return false;
+            } // is_ancestor()
+
+        }; // class draw_frames
+
+    } // namespace scenegraph
+
+} // namespace test
+
+#endif
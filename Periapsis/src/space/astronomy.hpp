@@ -44,21 +44,21 @@ namespace periapsis
     namespace space
     {
 
-        extern SPACE_API double J2000; 
+        extern EPHEMERIS_API double J2000; 
 
 
         /// \name Coordinate System Transforms
         /// Note that these are for the usual OpenGL setup where transforms are done by multiplying the matrix by the vector to transform.
         /// @{
 
-        extern SPACE_API gsgl::math::transform EQUATORIAL_WRT_GALACTIC;
-        extern SPACE_API gsgl::math::transform GALACTIC_WRT_EQUATORIAL;
+        extern EPHEMERIS_API gsgl::math::transform EQUATORIAL_WRT_GALACTIC;
+        extern EPHEMERIS_API gsgl::math::transform GALACTIC_WRT_EQUATORIAL;
 
-        extern SPACE_API gsgl::math::transform ECLIPTIC_WRT_EQUATORIAL;
-        extern SPACE_API gsgl::math::transform EQUATORIAL_WRT_ECLIPTIC;
+        extern EPHEMERIS_API gsgl::math::transform ECLIPTIC_WRT_EQUATORIAL;
+        extern EPHEMERIS_API gsgl::math::transform EQUATORIAL_WRT_ECLIPTIC;
 
-        extern SPACE_API gsgl::math::transform ECLIPTIC_WRT_GALACTIC;
-        extern SPACE_API gsgl::math::transform GALACTIC_WRT_ECLIPTIC;
+        extern EPHEMERIS_API gsgl::math::transform ECLIPTIC_WRT_GALACTIC;
+        extern EPHEMERIS_API gsgl::math::transform GALACTIC_WRT_ECLIPTIC;
 
         /// @}
 
@@ -77,9 +77,9 @@ namespace periapsis
         /// \param lat               The resulting geodedic latitude.
         /// \param lon               The resulting geodedic longitude.
         /// \param alt               The altitude above the surface of the earth.
-        void SPACE_API geocentric_to_geographic(const gsgl::real_t & polar_radius, const gsgl::real_t & equatorial_radius,
-                                                const gsgl::real_t & x, const gsgl::real_t & y, const gsgl::real_t & z,
-                                                gsgl::real_t & lat, gsgl::real_t & lon, gsgl::real_t & alt);
+        void EPHEMERIS_API geocentric_to_geographic(const gsgl::real_t & polar_radius, const gsgl::real_t & equatorial_radius,
+                                                    const gsgl::real_t & x, const gsgl::real_t & y, const gsgl::real_t & z,
+                                                    gsgl::real_t & lat, gsgl::real_t & lon, gsgl::real_t & alt);
 
         /// Converts from geographic polar coordinates to geocentric cartesian coordinates.
         ///
@@ -91,9 +91,9 @@ namespace periapsis
         /// \param x                 The resulting x coordinate.
         /// \param y                 The resulting y coordinate.
         /// \param z                 The resulting z coordinate.
-        void SPACE_API geographic_to_geocentric(const gsgl::real_t & polar_radius, const gsgl::real_t & equatorial_radius,
-                                                const gsgl::real_t & lat, const gsgl::real_t & lon, const gsgl::real_t & alt,
-                                                gsgl::real_t & x, gsgl::real_t & y, gsgl::real_t & z);
+        void EPHEMERIS_API geographic_to_geocentric(const gsgl::real_t & polar_radius, const gsgl::real_t & equatorial_radius,
+                                                    const gsgl::real_t & lat, const gsgl::real_t & lon, const gsgl::real_t & alt,
+                                                    gsgl::real_t & x, gsgl::real_t & y, gsgl::real_t & z);
 
         /// @}
 
@@ -1,5 +1,5 @@
-#ifndef GSGL_PLATFORM_BUDGET_H
-#define GSGL_PLATFORM_BUDGET_H
+#ifndef PERIAPSIS_SPACE_BODY_ROTATOR_H
+#define PERIAPSIS_SPACE_BODY_ROTATOR_H
 
 //
 // $Id$
@@ -34,56 +34,40 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //
 
-#include "platform/platform.hpp"
-#include "data/singleton.hpp"
-#include "data/string.hpp"
-#include "data/dictionary.hpp"
+#include "space/space.hpp"
+#include "data/broker.hpp"
+#include "math/vector.hpp"
+#include "math/transform.hpp"
 
-namespace gsgl
+namespace periapsis
 {
 
-    class string;
-
-    namespace platform
+    namespace space
     {
 
-        class PLATFORM_API budget
-            : public platform_object, public gsgl::data::singleton<budget>
+        /// Base class for celestial body rotators.
+        class EPHEMERIS_API body_rotator
+            : public gsgl::data::brokered_object
         {
-            data::dictionary<unsigned int, string> data;
-        public:
-            budget();
-            ~budget();
-
-            data::dictionary<unsigned int, string> & get_data() { return data; }
+            double last_alpha, last_delta, last_W;
 
-            void reset();
-        }; // class budget
+        public:        
+            body_rotator();
+            virtual ~body_rotator();
 
+            virtual void calc_orientation(double jdn, gsgl::math::transform & orientation, gsgl::math::vector & angular_velocity) = 0;
 
-        /// Use a variable of this type to add time to a budget category.
-        class PLATFORM_API budget_record
-        {
-            budget *parent;
-            unsigned int start_tick;
-            string category;
-        public:
-            budget_record(const string & category);
-            ~budget_record();
-        }; // class budget_record
-
+            /// Gets the angles (in degrees) behind the last orientation calculated: the right ascension and declination of the north pole, and the prime meridian.
+            /// W is not reduced to one turn, so it can be fitted across many days.
+            void get_last_angles(double & alpha, double & delta, double & W) const;
 
-    } // namespace platform
+        protected:
+            void calc_orientation_aux(double alpha, double delta, double W, gsgl::math::transform & orientation);
+            void calc_angular_velocity_aux(double ang_diff, double d, const gsgl::math::transform & orientation, gsgl::math::vector & angular_velocity);
+        }; // class body_rotator
 
-} // namespace gsgl
-
-
-#ifdef DEBUG
-/// This is kinda silly, but it's to avoid doing useless string concatenation in a release build.
-#define BUDGET_SCOPE(str) budget_record _br(str)
-#else
-#define BUDGET_SCOPE(str)
-#endif
+    } // namespace space
 
+} // namespace periapsis
 
 #endif
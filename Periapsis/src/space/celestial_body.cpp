@@ -33,6 +33,7 @@
 
 #include "space/celestial_body.hpp"
 #include "space/space_context.hpp"
+#include "space/gravity_field.hpp"
 
 #include "math/units.hpp"
 #include "scenegraph/camera.hpp"
@@ -56,7 +57,7 @@ namespace periapsis
             : orbital_frame(obj_config), 
               mass(1), polar_radius(1), equatorial_radius(1),
               rotating_frame(0), atmo_child(0), litho_child(0), 
-              simple_sphere(0), simple_material(0), simple_height_max(0)
+              simple_sphere(0), simple_material(0), simple_height_max(0), in_field(false)
         {
             mass              = units::parse(obj_config[L"mass"]);              assert(mass > 0);
             polar_radius      = units::parse(obj_config[L"polar_radius"]);      assert(polar_radius > 0);
@@ -86,6 +87,15 @@ namespace periapsis
 
         celestial_body::~celestial_body()
         {
+            if (in_field)
+            {
+                gravity_field *field = gravity_field::global_instance();
+                field->remove(this);
+
+                if (field->size() == 0)
+                    delete field;
+            }
+
             delete simple_material;
             delete simple_sphere;
         } // celestial_body::~celestial_body()
@@ -122,6 +132,15 @@ namespace periapsis
             if (simple_material)
                 simple_material->load();
 
+            if (!in_field)
+            {
+                if (!gravity_field::global_instance())
+                    new gravity_field();
+
+                gravity_field::global_instance()->add(this);
+                in_field = true;
+            }
+
             // the various children will be initialized by the scene drawing function
         } // celestial_body::init()
 
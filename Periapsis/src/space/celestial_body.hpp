@@ -72,6 +72,8 @@ namespace periapsis
             gsgl::math::vector simple_height_offset; ///< Offset (only x and y are used) for the height map of the simple sphere.
             gsgl::real_t       simple_height_max;    ///< Maximum height of the simple sphere heightmap.
 
+            bool in_field; ///< Whether the body has joined the global gravity_field.
+
         public:
             celestial_body(const gsgl::data::config_record & obj_config);
             virtual ~celestial_body();
@@ -0,0 +1,327 @@
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/ephemeris_table.hpp"
+#include "data/config.hpp"
+#include "data/log.hpp"
+#include "math/units.hpp"
+
+#include <cmath>
+#include <cstring>
+
+using namespace gsgl;
+using namespace gsgl::data;
+using namespace gsgl::io;
+using namespace gsgl::math;
+using namespace gsgl::platform;
+
+// global ephemeris table
+periapsis::space::ephemeris_table *periapsis::space::ephemeris_table::instance = 0;
+
+namespace periapsis
+{
+
+    namespace space
+    {
+
+        static config_variable<string> TABLE(L"space/ephemeris/table", L"");   ///< An ephemeris file written by ephemgen; empty for none.
+        static bool table_failed = false;                                       ///< Set when the table couldn't be opened, so that each body doesn't try again.
+
+
+        const char ephemeris_table::COOKIE[] = "Periapsis Ephemeris 1.0";
+        const unsigned int ephemeris_table::FILE_BYTE_ORDER = 0x01020304;
+
+
+        ephemeris_table::ephemeris_table(const string & fname)
+            : singleton<ephemeris_table>(), file(fname), header(0), num_users(0)
+        {
+            header = &file.get_view<const ephemeris_file_header>(0, 1)[0];
+
+            if (::strncmp(header->cookie, COOKIE, sizeof(header->cookie)) != 0)
+                throw io_exception(L"Invalid ephemeris format in %ls (you may need to regenerate it with ephemgen).", fname.w_string());
+            if (header->byte_order != FILE_BYTE_ORDER)
+                throw io_exception(L"The ephemeris %ls was generated on a machine with a different byte order.", fname.w_string());
+
+            series = file.get_view<const ephemeris_series_record>(header->series_offset, header->num_series);
+
+            // check that all the coefficients are in the file, so evaluate() needn't
+            for (gsgl::index_t i = 0; i < series.size(); ++i)
+            {
+                const ephemeris_series_record & s = series[i];
+
+                if (s.name[sizeof(s.name) - 1] != 0 || s.num_components != static_cast<unsigned int>(NUM_COMPONENTS) || s.num_segments == 0 || s.num_coefficients == 0 || s.segment_days <= 0)
+                    throw io_exception(L"Invalid series record %d in %ls.", i, fname.w_string());
+
+                // the file can't hold more coefficients than this, and checking against it first keeps the count from overflowing
+                const unsigned int max_coefficients = file.get_size() / sizeof(double);
+
+                if (s.num_coefficients > max_coefficients / s.num_components / s.num_segments)
+                    throw io_exception(L"Series record %d in %ls has more coefficients than the file.", i, fname.w_string());
+
+                file.get_view<const double>(s.data_offset, static_cast<gsgl::index_t>(s.num_segments * s.num_components * s.num_coefficients));
+            }
+
+            file.advise(mapped_file::ACCESS_RANDOM);
+        } // ephemeris_table::ephemeris_table()
+
+
+        ephemeris_table::~ephemeris_table()
+        {
+        } // ephemeris_table::~ephemeris_table()
+
+
+        ephemeris_table *ephemeris_table::acquire()
+        {
+            if (!instance)
+            {
+                if (TABLE.get_value().is_empty() || table_failed)
+                    return 0;
+
+                // a missing or stale table isn't fatal; the bodies keep their own models
+                try
+                {
+                    new ephemeris_table(TABLE.get_value());
+                }
+                catch (gsgl::exception & e)
+                {
+                    gsgl::log(string::format(L"ephemeris_table: unable to use %ls: %ls", TABLE.get_value().w_string(), e.get_message()));
+                    table_failed = true;
+                    return 0;
+                }
+            }
+
+            ++instance->num_users;
+            return instance;
+        } // ephemeris_table::acquire()
+
+
+        void ephemeris_table::release()
+        {
+            if (--num_users <= 0)
+                delete this;
+        } // ephemeris_table::release()
+
+
+        gsgl::index_t ephemeris_table::find_series(const string & name, const series_kind kind) const
+        {
+            const char *name_chars = name.c_string();
+
+            for (gsgl::index_t i = 0; i < series.size(); ++i)
+            {
+                if (series[i].kind == static_cast<unsigned int>(kind) && ::strcmp(series[i].name, name_chars) == 0)
+                    return i;
+            }
+
+            return -1;
+        } // ephemeris_table::find_series()
+
+
+        bool ephemeris_table::evaluate(const gsgl::index_t series_index, const double jdn, double *values, double *rates) const
+        {
+            const ephemeris_series_record & s = series[series_index];
+
+            // find the segment, and where jdn falls in it (from -1 to 1); the end of the last segment belongs to it
+            double offset = (jdn - s.start_jdn) / s.segment_days;
+            double segment = ::floor(offset);
+
+            if (segment < 0 || segment > s.num_segments || (segment == s.num_segments && offset != segment))
+                return false;
+            if (segment == s.num_segments)
+                segment -= 1;
+
+            const double x = 2.0*(offset - segment) - 1.0;
+            const double x_rate = 2.0 / s.segment_days;
+
+            const unsigned int n = s.num_coefficients;
+            const double *c = reinterpret_cast<const double *>(static_cast<const unsigned char *>(file.get_pointer()) + s.data_offset)
+                            + static_cast<unsigned int>(segment) * s.num_components * n;
+
+            for (unsigned int component = 0; component < s.num_components; ++component, c += n)
+            {
+                // T_k(x) and its derivative by the usual recurrences
+                double t_prev = 1, t = x, dt_prev = 0, dt = 1;
+                double value = c[0], rate = 0;
+
+                if (n > 1)
+                {
+                    value += c[1]*x;
+                    rate += c[1];
+                }
+
+                for (unsigned int k = 2; k < n; ++k)
+                {
+                    double t_next = 2.0*x*t - t_prev;
+                    double dt_next = 2.0*t + 2.0*x*dt - dt_prev;
+
+                    value += c[k]*t_next;
+                    rate += c[k]*dt_next;
+
+                    t_prev = t; t = t_next;
+                    dt_prev = dt; dt = dt_next;
+                }
+
+                values[component] = value;
+                rates[component] = rate * x_rate;
+            }
+
+            return true;
+        } // ephemeris_table::evaluate()
+
+
+        double ephemeris_table::chebyshev_node(const unsigned int k, const unsigned int n)
+        {
+            return ::cos(math::PI * (k + 0.5) / n);
+        } // ephemeris_table::chebyshev_node()
+
+
+        void ephemeris_table::chebyshev_fit(const unsigned int n, const double *samples, double *coefficients)
+        {
+            // interpolating at the nodes is nearly as good as the best polynomial of that degree
+            for (unsigned int j = 0; j < n; ++j)
+            {
+                double sum = 0;
+                for (unsigned int k = 0; k < n; ++k)
+                    sum += samples[k] * ::cos(math::PI * j * (k + 0.5) / n);
+
+                coefficients[j] = sum * (j == 0 ? 1.0 : 2.0) / n;
+            }
+        } // ephemeris_table::chebyshev_fit()
+
+
+        //////////////////////////////////////////////////////////////
+
+        ephemeris_propagator::ephemeris_propagator(ephemeris_table *table, const gsgl::index_t series_index, propagator *fallback)
+            : propagator(config_record()), table(table), series_index(series_index), fallback(fallback)
+        {
+            assert(table);
+        } // ephemeris_propagator::ephemeris_propagator()
+
+
+        ephemeris_propagator::~ephemeris_propagator()
+        {
+            delete fallback;
+            table->release();
+        } // ephemeris_propagator::~ephemeris_propagator()
+
+
+        void ephemeris_propagator::update(const double jdn, dvector & position, vector & velocity)
+        {
+            double values[ephemeris_table::NUM_COMPONENTS], rates[ephemeris_table::NUM_COMPONENTS];
+
+            if (table->evaluate(series_index, jdn, values, rates))
+            {
+                position = dvector(values[0], values[1], values[2]);
+
+                velocity.get_x() = static_cast<gsgl::real_t>(rates[0] / units::SECONDS_PER_DAY);
+                velocity.get_y() = static_cast<gsgl::real_t>(rates[1] / units::SECONDS_PER_DAY);
+                velocity.get_z() = static_cast<gsgl::real_t>(rates[2] / units::SECONDS_PER_DAY);
+                velocity.get_w() = 1;
+            }
+            else if (fallback)
+            {
+                fallback->update(jdn, position, velocity);
+            }
+        } // ephemeris_propagator::update()
+
+
+        propagator *ephemeris_propagator::use_table(const string & name, propagator *prop)
+        {
+            ephemeris_table *table = ephemeris_table::acquire();
+
+            if (table)
+            {
+                gsgl::index_t series_index = table->find_series(name, ephemeris_table::POSITION);
+
+                if (series_index >= 0)
+                    return new ephemeris_propagator(table, series_index, prop);
+
+                table->release();
+            }
+
+            return prop;
+        } // ephemeris_propagator::use_table()
+
+
+        //////////////////////////////////////////////////////////////
+
+        ephemeris_rotator::ephemeris_rotator(ephemeris_table *table, const gsgl::index_t series_index, body_rotator *fallback)
+            : body_rotator(), table(table), series_index(series_index), fallback(fallback)
+        {
+            assert(table);
+        } // ephemeris_rotator::ephemeris_rotator()
+
+
+        ephemeris_rotator::~ephemeris_rotator()
+        {
+            delete fallback;
+            table->release();
+        } // ephemeris_rotator::~ephemeris_rotator()
+
+
+        void ephemeris_rotator::calc_orientation(double jdn, transform & orientation, vector & angular_velocity)
+        {
+            double angles[ephemeris_table::NUM_COMPONENTS], rates[ephemeris_table::NUM_COMPONENTS];
+
+            if (table->evaluate(series_index, jdn, angles, rates))
+            {
+                calc_orientation_aux(angles[0], angles[1], angles[2], orientation);
+                calc_angular_velocity_aux(rates[2], 1.0, orientation, angular_velocity);
+            }
+            else if (fallback)
+            {
+                fallback->calc_orientation(jdn, orientation, angular_velocity);
+            }
+        } // ephemeris_rotator::calc_orientation()
+
+
+        body_rotator *ephemeris_rotator::use_table(const string & name, body_rotator *rotator)
+        {
+            ephemeris_table *table = ephemeris_table::acquire();
+
+            if (table)
+            {
+                gsgl::index_t series_index = table->find_series(name, ephemeris_table::ORIENTATION);
+
+                if (series_index >= 0)
+                    return new ephemeris_rotator(table, series_index, rotator);
+
+                table->release();
+            }
+
+            return rotator;
+        } // ephemeris_rotator::use_table()
+
+
+    } // namespace space
+
+} // namespace periapsis
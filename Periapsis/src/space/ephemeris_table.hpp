@@ -0,0 +1,180 @@
+#ifndef PERIAPSIS_SPACE_EPHEMERIS_TABLE_H
+#define PERIAPSIS_SPACE_EPHEMERIS_TABLE_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/space.hpp"
+#include "space/propagator.hpp"
+#include "space/body_rotator.hpp"
+
+#include "data/singleton.hpp"
+#include "platform/mapped_file.hpp"
+
+namespace periapsis
+{
+
+    namespace space
+    {
+
+        // The ephemeris file layout, written by ephemgen (Utils/src/ephemgen/ephemgen.cpp).
+        // All values are in the byte order of the machine that generated the file.
+
+        /// The start of an ephemeris file.
+        struct ephemeris_file_header
+        {
+            char cookie[32];
+            unsigned int byte_order;
+
+            unsigned int num_series;
+            unsigned int series_offset;     ///< Offset of the series records.
+            unsigned int reserved;
+
+            double start_jdn, end_jdn;      ///< The range covered by every series.
+        }; // struct ephemeris_file_header
+
+
+        /// Describes one body's position or orientation, fitted with Chebyshev polynomials over consecutive segments of equal length.
+        /// Each segment holds \c num_coefficients coefficients for each component in turn.
+        struct ephemeris_series_record
+        {
+            char name[64];                  ///< The body's name, in 8-bit characters with a terminating 0.
+            unsigned int kind;              ///< One of the ephemeris_table::series_kind values.
+            unsigned int num_components;
+            unsigned int num_coefficients;
+            unsigned int num_segments;
+            unsigned int data_offset;       ///< Offset of the coefficients, which are doubles.
+            unsigned int reserved;
+
+            double start_jdn;
+            double segment_days;
+        }; // struct ephemeris_series_record
+
+
+        /// A memory-mapped table of positions and orientations, fitted to the propagators and body rotators by ephemgen.
+        /// Finding a value takes one division to pick the segment and a short Chebyshev sum, at any date in the table's range.
+        ///
+        /// The global table is opened from the file named by space/ephemeris/table the first time it is acquired, and closed when the last user releases it.
+        /// Orbital frames and rotating bodies that find themselves in it are moved by ephemeris_propagator and ephemeris_rotator instead of their own models.
+        class SPACE_API ephemeris_table
+            : public gsgl::data::singleton<ephemeris_table>
+        {
+            gsgl::platform::mapped_file file;
+            const ephemeris_file_header *header;
+            gsgl::platform::mapped_view<const ephemeris_series_record> series;
+
+            int num_users;
+
+        public:
+            enum series_kind
+            {
+                POSITION = 1,       ///< x, y and z relative to the parent frame, in the parent frame's units.
+                ORIENTATION = 2     ///< The right ascension and declination of the north pole and the prime meridian angle W, in degrees.
+            };
+
+            enum { NUM_COMPONENTS = 3 };    ///< The number of components in every series; tables with any other number are rejected.
+
+            static const char COOKIE[];
+            static const unsigned int FILE_BYTE_ORDER;
+
+            explicit ephemeris_table(const gsgl::string & fname);
+            ~ephemeris_table();
+
+            /// \return The global table, opening it if need be, or 0 if space/ephemeris/table is empty or can't be opened.  Each table returned must be given back with release().
+            /// A table that can't be opened is logged, and not tried again.
+            static ephemeris_table *acquire();
+            void release();
+
+            double get_start_jdn() const { return header->start_jdn; }
+            double get_end_jdn() const { return header->end_jdn; }
+
+            /// \return The index of the named body's series of the given kind, or -1 if there is none.
+            gsgl::index_t find_series(const gsgl::string & name, const series_kind kind) const;
+
+            /// Finds the values of a series' NUM_COMPONENTS components, and their rates of change per day, at Julian day \c jdn.
+            /// \return false if \c jdn is outside the series.
+            bool evaluate(const gsgl::index_t series_index, const double jdn, double *values, double *rates) const;
+
+            /// \return The k'th of the \c n points in [-1, 1] at which a segment is sampled to be fitted with \c n coefficients.
+            static double chebyshev_node(const unsigned int k, const unsigned int n);
+
+            /// Finds the \c n Chebyshev coefficients that interpolate one component's samples at the chebyshev_node() points.
+            static void chebyshev_fit(const unsigned int n, const double *samples, double *coefficients);
+        }; // class ephemeris_table
+
+
+        /// Looks positions up in the global ephemeris table, using another propagator outside the table's range.
+        class SPACE_API ephemeris_propagator
+            : public propagator
+        {
+            ephemeris_table *table;
+            gsgl::index_t series_index;
+            propagator *fallback;
+
+        public:
+            /// Takes over the caller's hold on the table, and the fallback propagator (which may be 0).
+            ephemeris_propagator(ephemeris_table *table, const gsgl::index_t series_index, propagator *fallback);
+            virtual ~ephemeris_propagator();
+
+            virtual void update(const double jdn, gsgl::math::dvector & position, gsgl::math::vector & velocity);
+
+            /// \return An ephemeris_propagator that falls back on \c prop, if the global table has positions for the named body; otherwise \c prop itself.
+            static propagator *use_table(const gsgl::string & name, propagator *prop);
+        }; // class ephemeris_propagator
+
+
+        /// Looks orientations up in the global ephemeris table, using another rotator outside the table's range.
+        class SPACE_API ephemeris_rotator
+            : public body_rotator
+        {
+            ephemeris_table *table;
+            gsgl::index_t series_index;
+            body_rotator *fallback;
+
+        public:
+            /// Takes over the caller's hold on the table, and the fallback rotator (which may be 0).
+            ephemeris_rotator(ephemeris_table *table, const gsgl::index_t series_index, body_rotator *fallback);
+            virtual ~ephemeris_rotator();
+
+            virtual void calc_orientation(double jdn, gsgl::math::transform & orientation, gsgl::math::vector & angular_velocity);
+
+            /// \return An ephemeris_rotator that falls back on \c rotator, if the global table has orientations for the named body; otherwise \c rotator itself.
+            static body_rotator *use_table(const gsgl::string & name, body_rotator *rotator);
+        }; // class ephemeris_rotator
+
+
+    } // namespace space
+
+} // namespace periapsis
+
+#endif
@@ -0,0 +1,546 @@
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/gravity_field.hpp"
+#include "space/celestial_body.hpp"
+
+#include "data/config.hpp"
+#include "physics/physics_frame.hpp"
+
+#include <cmath>
+
+using namespace gsgl;
+using namespace gsgl::data;
+using namespace gsgl::math;
+using namespace gsgl::scenegraph;
+
+// global gravity field
+periapsis::space::gravity_field *periapsis::space::gravity_field::instance = 0;
+
+int periapsis::space::gravity_field::num_influence_users = 0;
+
+namespace periapsis
+{
+
+    namespace space
+    {
+
+        static const double GRAVITATIONAL_CONSTANT = 6.67428e-11; // m^3 / (kg s^2)
+
+        static config_variable<gsgl::real_t> SOFTENING(L"space/gravity_field/softening", 1.0f);           ///< Softening length (in meters), which keeps the field finite at a source's center.
+        static config_variable<int> TREE_THRESHOLD(L"space/gravity_field/tree_threshold", 256);          ///< Use the Barnes-Hut octree when there are at least this many sources.
+        static config_variable<gsgl::real_t> OPENING_ANGLE(L"space/gravity_field/opening_angle", 0.5f);   ///< A cell is treated as a point mass when its size over its distance is less than this.
+
+        static const int MAX_TREE_DEPTH = 32;
+
+        /// Components of the cached sources.
+        enum { SOURCE_X = 0, SOURCE_VX = 3, SOURCE_GM = 6, SOURCE_SIZE = 7 };
+
+
+        /// \return A pointer to at least \c n values in the array.
+        template <typename T>
+        static T *get_values(simple_array<T> & a, const gsgl::index_t & n)
+        {
+            if (a.size() < n)
+                a[n - 1] = 0;
+
+            return a.ptr();
+        } // get_values()
+
+
+        /// \return The octant of \c center that source \c i is in: bit 0 is set for +x, bit 1 for +y and bit 2 for +z.
+        static inline int octant(const double *s, const gsgl::index_t & n, const gsgl::index_t & i, const double *center)
+        {
+            return (s[(SOURCE_X + 0)*n + i] >= center[0] ? 1 : 0)
+                 | (s[(SOURCE_X + 1)*n + i] >= center[1] ? 2 : 0)
+                 | (s[(SOURCE_X + 2)*n + i] >= center[2] ? 4 : 0);
+        } // octant()
+
+
+        //
+
+        gravity_field::gravity_field()
+            : singleton<gravity_field>(), num_sources(0), cache_time(0), has_influence(false)
+        {
+            // the cache must be filled before other listeners (e.g. the rigid body system) step their vehicles
+            simulation::add_tick_listener(this, true);
+        } // gravity_field::gravity_field()
+
+
+        gravity_field::~gravity_field()
+        {
+            simulation::remove_tick_listener(this);
+        } // gravity_field::~gravity_field()
+
+
+        void gravity_field::add(celestial_body *body)
+        {
+            assert(body);
+            bodies.append(body);
+        } // gravity_field::add()
+
+
+        void gravity_field::remove(celestial_body *body)
+        {
+            for (gsgl::index_t i = 0; i < bodies.size(); ++i)
+            {
+                if (bodies[i] == body)
+                {
+                    bodies.remove(i);
+                    return;
+                }
+            }
+        } // gravity_field::remove()
+
+
+        void gravity_field::pre_update(const simulation_context *c)
+        {
+            const gsgl::index_t n = bodies.size();
+            double *s = get_values(sources, SOURCE_SIZE * n);
+            celestial_body **b = get_values(source_bodies, n);
+
+            dvector pos, vel;
+            transform rot;
+
+            for (gsgl::index_t i = 0; i < n; ++i)
+            {
+                get_world_motion(bodies[i], pos, vel, rot);
+
+                s[(SOURCE_X + 0)*n + i] = pos.get_x();
+                s[(SOURCE_X + 1)*n + i] = pos.get_y();
+                s[(SOURCE_X + 2)*n + i] = pos.get_z();
+                s[(SOURCE_VX + 0)*n + i] = vel.get_x();
+                s[(SOURCE_VX + 1)*n + i] = vel.get_y();
+                s[(SOURCE_VX + 2)*n + i] = vel.get_z();
+                s[SOURCE_GM*n + i] = get_gm(bodies[i]);
+                b[i] = bodies[i];
+            }
+
+            num_sources = n;
+            cache_time = c->cur_time - c->delta_time;
+
+            if (n > 0 && n >= static_cast<gsgl::index_t>(TREE_THRESHOLD))
+                build_tree();
+            else
+                cells.clear();
+
+            // found here rather than when first asked for, because the nodes that ask may be updated concurrently
+            if (num_influence_users > 0)
+                find_influence();
+            else
+                has_influence = false;
+        } // gravity_field::pre_update()
+
+
+        dvector gravity_field::acceleration(const dvector & position, const double & t) const
+        {
+            double p[3] = { position.get_x(), position.get_y(), position.get_z() };
+            double a[3] = { 0, 0, 0 };
+
+            if (cells.size())
+                tree_acceleration(p, t - cache_time, a);
+            else
+                direct_acceleration(p, t - cache_time, a);
+
+            return dvector(a[0], a[1], a[2]);
+        } // gravity_field::acceleration()
+
+
+        void gravity_field::accelerations(const gsgl::index_t & n, const double *x, const double *y, const double *z, const double & t, double *ax, double *ay, double *az) const
+        {
+            const double dt = t - cache_time;
+            const bool use_tree = cells.size() != 0;
+
+            for (gsgl::index_t i = 0; i < n; ++i)
+            {
+                double p[3] = { x[i], y[i], z[i] };
+                double a[3] = { 0, 0, 0 };
+
+                if (use_tree)
+                    tree_acceleration(p, dt, a);
+                else
+                    direct_acceleration(p, dt, a);
+
+                ax[i] = a[0];
+                ay[i] = a[1];
+                az[i] = a[2];
+            }
+        } // gravity_field::accelerations()
+
+
+        celestial_body *gravity_field::get_dominant_body(const dvector & position) const
+        {
+            const gsgl::index_t n = num_sources;
+
+            if (!has_influence)
+                return 0;
+
+            const double *x = sources.ptr() + SOURCE_X*n, *y = x + n, *z = y + n;
+            const double *radius = influence.ptr();
+
+            celestial_body *result = 0;
+            double result_radius = -1;
+
+            for (gsgl::index_t i = 0; i < n; ++i)
+            {
+                double dx = x[i] - position.get_x();
+                double dy = y[i] - position.get_y();
+                double dz = z[i] - position.get_z();
+
+                // an unbounded sphere has a negative radius
+                if (radius[i] < 0)
+                {
+                    if (!result)
+                        result = source_bodies[i];
+                }
+                else if (dx*dx + dy*dy + dz*dz < radius[i]*radius[i] && (result_radius < 0 || radius[i] < result_radius))
+                {
+                    result = source_bodies[i];
+                    result_radius = radius[i];
+                }
+            }
+
+            return result;
+        } // gravity_field::get_dominant_body()
+
+
+        bool gravity_field::get_source_motion(const celestial_body *body, const double & t, dvector & pos, dvector & vel) const
+        {
+            const gsgl::index_t n = num_sources;
+            const double *s = sources.ptr();
+            celestial_body * const *b = source_bodies.ptr();
+            const double dt = t - cache_time;
+
+            for (gsgl::index_t i = 0; i < n; ++i)
+            {
+                if (b[i] == body)
+                {
+                    vel = dvector(s[(SOURCE_VX + 0)*n + i], s[(SOURCE_VX + 1)*n + i], s[(SOURCE_VX + 2)*n + i]);
+                    pos = dvector(s[(SOURCE_X + 0)*n + i], s[(SOURCE_X + 1)*n + i], s[(SOURCE_X + 2)*n + i]) + vel * dt;
+                    return true;
+                }
+            }
+
+            return false;
+        } // gravity_field::get_source_motion()
+
+
+        void gravity_field::add_influence_user()
+        {
+            ++num_influence_users;
+        } // gravity_field::add_influence_user()
+
+
+        void gravity_field::remove_influence_user()
+        {
+            assert(num_influence_users > 0);
+            --num_influence_users;
+        } // gravity_field::remove_influence_user()
+
+
+        double gravity_field::get_gm(const celestial_body *body)
+        {
+            return GRAVITATIONAL_CONSTANT * body->get_mass();
+        } // gravity_field::get_gm()
+
+
+        void gravity_field::get_world_motion(node *n, dvector & pos, dvector & vel, transform & rot)
+        {
+            node *parent = n->get_parent();
+
+            if (!parent)
+            {
+                pos = dvector();
+                vel = dvector();
+                rot = transform::IDENTITY;
+                return;
+            }
+
+            dvector parent_pos, parent_vel;
+            transform parent_rot;
+            get_world_motion(parent, parent_pos, parent_vel, parent_rot);
+
+            const double scale = parent->get_scale();
+
+            pos = parent_pos + (n->get_precise_translation() * scale).rotate_by(parent_rot);
+            vel = parent_vel;
+            rot = parent_rot * n->get_orientation();
+
+            physics::physics_frame *frame = dynamic_cast<physics::physics_frame *>(n);
+            if (frame)
+                vel += (dvector(frame->get_linear_velocity()) * scale).rotate_by(parent_rot);
+        } // gravity_field::get_world_motion()
+
+
+        //
+
+        void gravity_field::direct_acceleration(const double *p, const double & dt, double *a) const
+        {
+            const gsgl::index_t n = num_sources;
+            const double *x = sources.ptr() + SOURCE_X*n,  *y = x + n,  *z = y + n;
+            const double *vx = sources.ptr() + SOURCE_VX*n, *vy = vx + n, *vz = vy + n;
+            const double *gm = sources.ptr() + SOURCE_GM*n;
+            const double eps2 = static_cast<double>(SOFTENING) * static_cast<double>(SOFTENING);
+
+            for (gsgl::index_t i = 0; i < n; ++i)
+            {
+                double dx = x[i] + vx[i]*dt - p[0];
+                double dy = y[i] + vy[i]*dt - p[1];
+                double dz = z[i] + vz[i]*dt - p[2];
+                double r2 = dx*dx + dy*dy + dz*dz + eps2;
+                double f = gm[i] / (r2 * ::sqrt(r2));
+
+                a[0] += dx * f;
+                a[1] += dy * f;
+                a[2] += dz * f;
+            }
+        } // gravity_field::direct_acceleration()
+
+
+        void gravity_field::tree_acceleration(const double *p, const double & dt, double *a) const
+        {
+            const double theta2 = static_cast<double>(OPENING_ANGLE) * static_cast<double>(OPENING_ANGLE);
+            const double eps2 = static_cast<double>(SOFTENING) * static_cast<double>(SOFTENING);
+            const cell *cells_ptr = cells.ptr();
+
+            // each opened cell replaces itself with at most 8 children, one level down
+            int stack[8 * (MAX_TREE_DEPTH + 1)];
+            int top = 0;
+            stack[top++] = 0;
+
+            while (top)
+            {
+                const cell & c = cells_ptr[stack[--top]];
+
+                double dx = c.com[0] + c.vel[0]*dt - p[0];
+                double dy = c.com[1] + c.vel[1]*dt - p[1];
+                double dz = c.com[2] + c.vel[2]*dt - p[2];
+                double r2 = dx*dx + dy*dy + dz*dz;
+
+                if (c.first_child < 0 || c.size*c.size < theta2*r2)
+                {
+                    r2 += eps2;
+                    double f = c.gm / (r2 * ::sqrt(r2));
+
+                    a[0] += dx * f;
+                    a[1] += dy * f;
+                    a[2] += dz * f;
+                }
+                else
+                {
+                    for (int k = 0; k < c.num_children; ++k)
+                        stack[top++] = c.first_child + k;
+                }
+            }
+        } // gravity_field::tree_acceleration()
+
+
+        void gravity_field::find_influence()
+        {
+            const gsgl::index_t n = num_sources;
+            const double *x = sources.ptr() + SOURCE_X*n, *y = x + n, *z = y + n;
+            const double *gm = sources.ptr() + SOURCE_GM*n;
+            double *radius = get_values(influence, n);
+
+            // sort the sources by decreasing mass
+            gsgl::index_t *ord = get_values(order, n);
+            gsgl::index_t i, j, k;
+
+            for (i = 0; i < n; ++i)
+            {
+                for (j = i; j > 0 && gm[ord[j - 1]] < gm[i]; --j)
+                    ord[j] = ord[j - 1];
+                ord[j] = i;
+            }
+
+            // each body's sphere is the smallest one given by a heavier body whose sphere contains it
+            for (k = 0; k < n; ++k)
+            {
+                i = ord[k];
+                radius[i] = -1;
+
+                for (gsgl::index_t m = 0; m < k; ++m)
+                {
+                    j = ord[m];
+
+                    double dx = x[i] - x[j];
+                    double dy = y[i] - y[j];
+                    double dz = z[i] - z[j];
+                    double r2 = dx*dx + dy*dy + dz*dz;
+
+                    if (radius[j] < 0 || r2 < radius[j]*radius[j])
+                    {
+                        double r = ::sqrt(r2);
+                        double candidate = r * ::pow(gm[i] / gm[j], 0.4);
+
+                        if (radius[i] < 0 || candidate < radius[i])
+                            radius[i] = candidate;
+                    }
+                }
+            }
+
+            has_influence = true;
+        } // gravity_field::find_influence()
+
+
+        void gravity_field::build_tree()
+        {
+            const gsgl::index_t n = num_sources;
+            const double *x = sources.ptr() + SOURCE_X*n, *y = x + n, *z = y + n;
+
+            gsgl::index_t *ord = get_values(order, n);
+            get_values(order_scratch, n);
+
+            double lo[3] = { x[0], y[0], z[0] };
+            double hi[3] = { x[0], y[0], z[0] };
+
+            for (gsgl::index_t i = 0; i < n; ++i)
+            {
+                ord[i] = i;
+
+                lo[0] = gsgl::min_val(lo[0], x[i]);   hi[0] = gsgl::max_val(hi[0], x[i]);
+                lo[1] = gsgl::min_val(lo[1], y[i]);   hi[1] = gsgl::max_val(hi[1], y[i]);
+                lo[2] = gsgl::min_val(lo[2], z[i]);   hi[2] = gsgl::max_val(hi[2], z[i]);
+            }
+
+            cell root;
+            root.size = gsgl::max_val(gsgl::max_val(hi[0] - lo[0], hi[1] - lo[1]), gsgl::max_val(hi[2] - lo[2], 1.0));
+            for (int c = 0; c < 3; ++c)
+                root.center[c] = 0.5 * (lo[c] + hi[c]);
+
+            cells.clear();
+            cells.append(root);
+            build_cell(0, 0, n, 0);
+        } // gravity_field::build_tree()
+
+
+        void gravity_field::build_cell(const gsgl::index_t & cell_index, const gsgl::index_t & begin, const gsgl::index_t & end, const int depth)
+        {
+            const gsgl::index_t n = num_sources;
+            const double *s = sources.ptr();
+            gsgl::index_t *ord = order.ptr();
+            gsgl::index_t k;
+            int c, o;
+
+            // moments
+            double gm = 0, com[3] = { 0, 0, 0 }, vel[3] = { 0, 0, 0 };
+
+            for (k = begin; k < end; ++k)
+            {
+                gsgl::index_t i = ord[k];
+                double g = s[SOURCE_GM*n + i];
+
+                gm += g;
+                for (c = 0; c < 3; ++c)
+                {
+                    com[c] += g * s[(SOURCE_X + c)*n + i];
+                    vel[c] += g * s[(SOURCE_VX + c)*n + i];
+                }
+            }
+
+            cell & cur = cells[cell_index];
+            cur.gm = gm;
+            for (c = 0; c < 3; ++c)
+            {
+                cur.com[c] = gm > 0 ? com[c] / gm : cur.center[c];
+                cur.vel[c] = gm > 0 ? vel[c] / gm : 0;
+            }
+            cur.first_child = -1;
+            cur.num_children = 0;
+
+            // coincident sources would split forever, so they share a leaf at the bottom
+            if (end - begin < 2 || depth >= MAX_TREE_DEPTH)
+                return;
+
+            const double center[3] = { cur.center[0], cur.center[1], cur.center[2] };
+            const double quarter = cur.size * 0.25;
+
+            // sort the sources by octant
+            gsgl::index_t counts[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+            for (k = begin; k < end; ++k)
+                ++counts[octant(s, n, ord[k], center)];
+
+            gsgl::index_t starts[9], next[8];
+            starts[0] = begin;
+            for (o = 0; o < 8; ++o)
+            {
+                next[o] = starts[o];
+                starts[o + 1] = starts[o] + counts[o];
+            }
+
+            gsgl::index_t *scratch = order_scratch.ptr();
+            for (k = begin; k < end; ++k)
+            {
+                gsgl::index_t i = ord[k];
+                scratch[next[octant(s, n, i, center)]++] = i;
+            }
+
+
+            for (k = begin; k < end; ++k)
+                ord[k] = scratch[k];
+
+            // the children are added together, then filled in
+            const gsgl::index_t first = cells.size();
+            int num_children = 0;
+
+            for (o = 0; o < 8; ++o)
+            {
+                if (counts[o])
+                {
+                    cell child;
+                    child.center[0] = center[0] + ((o & 1) ? quarter : -quarter);
+                    child.center[1] = center[1] + ((o & 2) ? quarter : -quarter);
+                    child.center[2] = center[2] + ((o & 4) ? quarter : -quarter);
+                    child.size = quarter * 2;
+
+                    cells.append(child);
+                    ++num_children;
+                }
+            }
+
+            cells[cell_index].first_child = static_cast<int>(first);
+            cells[cell_index].num_children = num_children;
+
+            int child_index = 0;
+            for (o = 0; o < 8; ++o)
+            {
+                if (counts[o])
+                    build_cell(first + child_index++, starts[o], starts[o + 1], depth + 1);
+            }
+        } // gravity_field::build_cell()
+
+
+    } // namespace space
+
+} // namespace periapsis
@@ -0,0 +1,152 @@
+#ifndef PERIAPSIS_SPACE_GRAVITY_FIELD_H
+#define PERIAPSIS_SPACE_GRAVITY_FIELD_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/space.hpp"
+
+#include "data/singleton.hpp"
+#include "data/array.hpp"
+#include "math/dvector.hpp"
+#include "math/transform.hpp"
+#include "scenegraph/simulation.hpp"
+
+namespace periapsis
+{
+
+    namespace space
+    {
+
+        class celestial_body;
+
+
+        /// Sums the gravitational accelerations of the celestial bodies at points in space.
+        /// Positions are in meters, relative to the scene graph root's origin and axes.
+        /// The bodies' positions and velocities are cached at the start of each tick, so that queries during the tick (e.g. at each stage of a vehicle's step) do not walk the scene graph;
+        /// each body is moved along its cached velocity to the time of the query.
+        /// The sum is direct for a solar system's worth of bodies, and approximated with a Barnes-Hut octree when there are many (e.g. an asteroid or debris field).
+        /// Celestial bodies join the global instance as they are initialized, creating it if need be, and it is deleted when the last one leaves.
+        class SPACE_API gravity_field
+            : public gsgl::data::singleton<gravity_field>, public gsgl::scenegraph::tick_listener
+        {
+            gsgl::data::simple_array<celestial_body *> bodies;
+
+            /// The cached sources, structure-of-arrays: component \c c of source \c i is at <tt>[c * n + i]</tt>, where \c n is the number of sources.
+            /// The components are the position, the velocity, and the mass times the gravitational constant.
+            gsgl::data::simple_array<double> sources;
+            gsgl::data::simple_array<celestial_body *> source_bodies;
+            gsgl::index_t num_sources;
+            double cache_time;
+
+            /// The radii of the sources' spheres of influence, found with the cache while anything uses them.
+            gsgl::data::simple_array<double> influence;
+            bool has_influence;
+
+            static int num_influence_users;
+
+            /// A cube of the Barnes-Hut octree.  The children of a cell are stored together.
+            struct cell
+            {
+                double center[3];
+                double size;        ///< The length of the cube's edges.
+                double com[3];      ///< The center of mass of the sources in the cell.
+                double vel[3];      ///< The mass-weighted velocity of the sources in the cell.
+                double gm;
+                int first_child;    ///< The index of the cell's first child, or -1 if the cell is a leaf.
+                int num_children;
+            }; // struct cell
+
+            gsgl::data::simple_array<cell> cells;
+            gsgl::data::simple_array<gsgl::index_t> order, order_scratch;
+
+        public:
+            gravity_field();
+            virtual ~gravity_field();
+
+            void add(celestial_body *body);
+            void remove(celestial_body *body);
+            gsgl::index_t size() const { return bodies.size(); }
+
+            /// \return The time (in seconds) at which the bodies' positions were cached.
+            const double & get_cache_time() const { return cache_time; }
+
+            /// Caches the bodies' positions, which are still those of the end of the last tick.
+            virtual void pre_update(const gsgl::scenegraph::simulation_context *c);
+
+            /// \return The gravitational acceleration (in m/s^2) at \c position at time \c t.
+            gsgl::math::dvector acceleration(const gsgl::math::dvector & position, const double & t) const;
+
+            /// Finds the accelerations at \c n points at once.  Each array holds \c n values; the outputs may not alias the inputs.
+            void accelerations(const gsgl::index_t & n, const double *x, const double *y, const double *z, const double & t, double *ax, double *ay, double *az) const;
+
+            /// \return The body whose sphere of influence is the smallest one containing \c position at the cache time, or 0 if there are no bodies or no influence users.
+            /// The heaviest body's sphere is unbounded.  Each other body's has radius r (m / M)^(2/5), for the heavier body of mass M at distance r, among those whose spheres contain it, 
+            /// that gives the smallest radius.
+            celestial_body *get_dominant_body(const gsgl::math::dvector & position) const;
+
+            /// Finds a source's cached position (in meters) and velocity (in meters per second), moved along the velocity to time \c t, as acceleration() sees it.
+            /// \return False if the body was not cached.
+            bool get_source_motion(const celestial_body *body, const double & t, gsgl::math::dvector & pos, gsgl::math::dvector & vel) const;
+
+            /// \name Influence Users.
+            /// Finding the spheres of influence takes time quadratic in the number of sources, so pre_update() only finds them while something will call get_dominant_body().
+            /// Add and remove users while the scene graph is not being updated (e.g. from node::init() or a node's destructor).
+            /// @{
+            static void add_influence_user();
+            static void remove_influence_user();
+            /// @}
+
+            /// \return The body's mass times the gravitational constant (m^3 / s^2).
+            static double get_gm(const celestial_body *body);
+
+            /// Finds a node's position, velocity and orientation relative to the root, from its current (not its drawing) state.
+            /// The position is in meters and the velocity in meters per second.  The rotation of rotating frames is not included in the velocity.
+            static void get_world_motion(gsgl::scenegraph::node *n, gsgl::math::dvector & pos, gsgl::math::dvector & vel, gsgl::math::transform & rot);
+
+        private:
+            void find_influence();
+
+            void build_tree();
+            void build_cell(const gsgl::index_t & cell_index, const gsgl::index_t & begin, const gsgl::index_t & end, const int depth);
+
+            void direct_acceleration(const double *p, const double & dt, double *a) const;
+            void tree_acceleration(const double *p, const double & dt, double *a) const;
+        }; // class gravity_field
+
+
+    } // namespace space
+
+} // namespace periapsis
+
+#endif
@@ -0,0 +1,155 @@
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/kepler_equation.hpp"
+#include "math/math.hpp"
+
+#include <cmath>
+
+using namespace gsgl;
+using namespace gsgl::math;
+
+namespace periapsis
+{
+
+    namespace space
+    {
+
+        namespace kepler_equation
+        {
+
+            /// Bounds the corrections of the hyperbolic solver.  The starters below are within a few percent, so this is only reached for wild inputs.
+            static const int MAX_HYPERBOLIC_ITERATIONS = 8;
+            static const double TOLERANCE = 1.0e-15;
+
+
+            /// Markley's method (Celestial Mechanics 63, 1995): a cubic starter that is good to about 1e-4 everywhere, then one fifth-order correction.
+            /// \c M must be in <tt>[-pi, pi]</tt>.
+            static inline double elliptic_in_range(const double M, const double e)
+            {
+                const double m = ::fabs(M);
+
+                const double alpha = (3.0*PI*PI + 1.6*PI*(PI - m)/(1.0 + e)) / (PI*PI - 6.0);
+                const double d = 3.0*(1.0 - e) + alpha*e;
+                const double q = 2.0*alpha*d*(1.0 - e) - m*m;
+                const double r = 3.0*alpha*d*(d - 1.0 + e)*m + m*m*m;
+                const double w = ::pow(::fabs(r) + ::sqrt(q*q*q + r*r), 2.0/3.0);
+
+                double E = (2.0*r*w / (w*w + w*q + q*q) + m) / d;
+
+                const double f2 = e*::sin(E);
+                const double f3 = e*::cos(E);
+                const double f0 = E - f2 - m;
+                const double f1 = 1.0 - f3;
+
+                const double d3 = -f0 / (f1 - 0.5*f0*f2/f1);
+                const double d4 = -f0 / (f1 + 0.5*d3*f2 + d3*d3*f3/6.0);
+                const double d5 = -f0 / (f1 + 0.5*d4*f2 + d4*d4*f3/6.0 - d4*d4*d4*f2/24.0);
+
+                E += d5;
+
+                return M < 0 ? -E : E;
+            } // elliptic_in_range()
+
+
+            double solve_elliptic(const double M, const double e)
+            {
+                double revs = ::floor((M + PI) / PI_TIMES_2);
+                return elliptic_in_range(M - revs*PI_TIMES_2, e) + revs*PI_TIMES_2;
+            } // solve_elliptic()
+
+
+            void solve_elliptic(const gsgl::index_t count, const double *M, const double *e, double *E)
+            {
+                for (gsgl::index_t i = 0; i < count; ++i)
+                {
+                    double revs = ::floor((M[i] + PI) / PI_TIMES_2);
+                    E[i] = elliptic_in_range(M[i] - revs*PI_TIMES_2, e[i]) + revs*PI_TIMES_2;
+                }
+            } // solve_elliptic()
+
+
+            /// Near the periapsis, Mikkola's cubic in <tt>s = sinh(H/3)</tt> (Celestial Mechanics 40, 1987); far from it, <tt>e sinh H</tt> dominates.
+            /// Then Halley's corrections, which at least triple the correct digits each time.
+            double solve_hyperbolic(const double M, const double e)
+            {
+                const double m = ::fabs(M);
+                double H;
+
+                if (m < 6.0*e)
+                {
+                    const double alpha = (e - 1.0) / (4.0*e + 0.5);
+                    const double beta = 0.5*m / (4.0*e + 0.5);
+                    const double z = ::pow(beta + ::sqrt(beta*beta + alpha*alpha*alpha), 1.0/3.0);
+
+                    double s = z - alpha/z;
+                    s += 0.071*s*s*s*s*s / ((1.0 + 0.45*s*s) * (1.0 + 4.0*s*s) * e);
+
+                    H = 3.0 * ::log(s + ::sqrt(1.0 + s*s));
+                }
+                else
+                {
+                    H = ::log(2.0*m/e);
+                    H = ::log(2.0*(m + H)/e);
+                }
+
+                for (int i = 0; i < MAX_HYPERBOLIC_ITERATIONS; ++i)
+                {
+                    const double f2 = e*::sinh(H);
+                    const double f0 = f2 - H - m;
+                    const double f1 = e*::cosh(H) - 1.0;
+                    const double delta = -f0 / (f1 - 0.5*f0*f2/f1);
+
+                    H += delta;
+
+                    if (::fabs(delta) <= TOLERANCE * (H > 1.0 ? H : 1.0))
+                        break;
+                }
+
+                return M < 0 ? -H : H;
+            } // solve_hyperbolic()
+
+
+            void solve_hyperbolic(const gsgl::index_t count, const double *M, const double *e, double *H)
+            {
+                for (gsgl::index_t i = 0; i < count; ++i)
+                    H[i] = solve_hyperbolic(M[i], e[i]);
+            } // solve_hyperbolic()
+
+
+        } // namespace kepler_equation
+
+
+    } // namespace space
+
+} // namespace periapsis
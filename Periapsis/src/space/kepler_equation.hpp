@@ -0,0 +1,72 @@
+#ifndef PERIAPSIS_SPACE_KEPLER_EQUATION_H
+#define PERIAPSIS_SPACE_KEPLER_EQUATION_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/space.hpp"
+#include "data/data.hpp"
+
+namespace periapsis
+{
+
+    namespace space
+    {
+
+        /// Solvers for Kepler's equation, shared by the propagators.
+        /// Each one starts from a cubic approximation that is already close for any eccentricity, and then takes a bounded number of high-order corrections, so the cost of a solution does not depend on the orbit.
+        namespace kepler_equation
+        {
+
+            /// \return The eccentric anomaly E (in radians) such that <tt>M = E - e sin E</tt>, for any mean anomaly \c M and an eccentricity <tt>0 <= e < 1</tt>.
+            /// E is in the same revolution as M.
+            EPHEMERIS_API double solve_elliptic(const double M, const double e);
+
+            /// \return The hyperbolic anomaly H such that <tt>M = e sinh H - H</tt>, for an eccentricity <tt>e > 1</tt>.
+            EPHEMERIS_API double solve_hyperbolic(const double M, const double e);
+
+
+            /// Solves the elliptic equation for \c count pairs of mean anomaly and eccentricity.  The output array may be the same as \c M.
+            EPHEMERIS_API void solve_elliptic(const gsgl::index_t count, const double *M, const double *e, double *E);
+
+            /// Solves the hyperbolic equation for \c count pairs of mean anomaly and eccentricity.  The output array may be the same as \c M.
+            EPHEMERIS_API void solve_hyperbolic(const gsgl::index_t count, const double *M, const double *e, double *H);
+
+        } // namespace kepler_equation
+
+
+    } // namespace space
+
+} // namespace periapsis
+
+#endif
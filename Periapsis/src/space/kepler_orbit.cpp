@@ -0,0 +1,143 @@
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/kepler_orbit.hpp"
+#include "space/kepler_equation.hpp"
+#include "math/math.hpp"
+
+#include <cmath>
+
+using namespace gsgl;
+using namespace gsgl::math;
+
+namespace periapsis
+{
+
+    namespace space
+    {
+
+        static double dot(const dvector & u, const dvector & v)
+        {
+            return u.get_x()*v.get_x() + u.get_y()*v.get_y() + u.get_z()*v.get_z();
+        } // dot()
+
+
+        //
+
+        kepler_orbit::kepler_orbit()
+            : mu(1), epoch(0), a(1), e(0), n(1), anomaly0(0), mean_anomaly0(0)
+        {
+        } // kepler_orbit::kepler_orbit()
+
+
+        kepler_orbit::kepler_orbit(const dvector & position, const dvector & velocity, const double & mu, const double & epoch)
+            : mu(mu), epoch(epoch), r0(position), v0(velocity)
+        {
+            const double r = r0.mag();
+            const double rv = dot(r0, v0);
+
+            a = 1.0 / (2.0/r - v0.mag2()/mu);
+
+            if (a > 0)
+            {
+                // e cos E = 1 - r/a, e sin E = r.v / sqrt(mu a)
+                double e_cos = 1.0 - r/a;
+                double e_sin = rv / ::sqrt(mu * a);
+
+                e = ::sqrt(e_cos*e_cos + e_sin*e_sin);
+                n = ::sqrt(mu / (a*a*a));
+                anomaly0 = ::atan2(e_sin, e_cos);
+                mean_anomaly0 = anomaly0 - e_sin;
+            }
+            else
+            {
+                // e cosh H = 1 - r/a, e sinh H = r.v / sqrt(-mu a)
+                double e_cosh = 1.0 - r/a;
+                double e_sinh = rv / ::sqrt(-mu * a);
+
+                e = ::sqrt(e_cosh*e_cosh - e_sinh*e_sinh);
+                n = ::sqrt(mu / -(a*a*a));
+                anomaly0 = ::log((e_cosh + e_sinh) / e);
+                mean_anomaly0 = e_sinh - anomaly0;
+            }
+        } // kepler_orbit::kepler_orbit()
+
+
+        /// Uses the f and g functions of the change in anomaly, which stay well-conditioned for circular orbits.
+        void kepler_orbit::evaluate(const double & t, dvector & position, dvector & velocity) const
+        {
+            double dt = t - epoch;
+            double r = r0.mag();
+            double f, g, f_dot, g_dot, r_t;
+
+            if (a > 0)
+            {
+                // reduce the mean anomaly to one revolution, and the elapsed time with it
+                double M = mean_anomaly0 + n*dt;
+                double revs = ::floor((M + math::PI) / math::PI_TIMES_2);
+                M -= revs * math::PI_TIMES_2;
+                dt -= revs * math::PI_TIMES_2 / n;
+
+                double E = kepler_equation::solve_elliptic(M, e);
+                double dE = E - anomaly0;
+                double cos_dE = ::cos(dE), sin_dE = ::sin(dE);
+
+                r_t = a * (1.0 - e*::cos(E));
+
+                f = 1.0 - a/r * (1.0 - cos_dE);
+                g = dt - (dE - sin_dE) / n;
+                f_dot = -::sqrt(mu * a) * sin_dE / (r * r_t);
+                g_dot = 1.0 - a/r_t * (1.0 - cos_dE);
+            }
+            else
+            {
+                double H = kepler_equation::solve_hyperbolic(mean_anomaly0 + n*dt, e);
+                double dH = H - anomaly0;
+                double cosh_dH = ::cosh(dH), sinh_dH = ::sinh(dH);
+
+                r_t = a * (1.0 - e*::cosh(H));
+
+                f = 1.0 - a/r * (1.0 - cosh_dH);
+                g = dt - (sinh_dH - dH) / n;
+                f_dot = -::sqrt(-mu * a) * sinh_dH / (r * r_t);
+                g_dot = 1.0 - a/r_t * (1.0 - cosh_dH);
+            }
+
+            position = r0*f + v0*g;
+            velocity = r0*f_dot + v0*g_dot;
+        } // kepler_orbit::evaluate()
+
+
+    } // namespace space
+
+} // namespace periapsis
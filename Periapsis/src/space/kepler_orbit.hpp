@@ -0,0 +1,78 @@
+#ifndef PERIAPSIS_SPACE_KEPLER_ORBIT_H
+#define PERIAPSIS_SPACE_KEPLER_ORBIT_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/space.hpp"
+#include "math/dvector.hpp"
+
+namespace periapsis
+{
+
+    namespace space
+    {
+
+        /// A two-body orbit, found from a position and velocity relative to the central body, that can be evaluated at any time in constant time.
+        /// Both elliptic and hyperbolic orbits are supported; a parabolic orbit is treated as a very long ellipse or a very slow hyperbola.
+        /// Positions are in meters and velocities in meters per second, in any fixed axes.
+        class SPACE_API kepler_orbit
+        {
+            double mu;              ///< The central body's mass times the gravitational constant (m^3 / s^2).
+            double epoch;           ///< The time (in seconds) of the initial state.
+            gsgl::math::dvector r0, v0;
+
+            double a;               ///< Semi-major axis (negative for a hyperbola).
+            double e;               ///< Eccentricity.
+            double n;               ///< Mean motion (radians / second).
+            double anomaly0;        ///< The eccentric (or hyperbolic) anomaly at the epoch.
+            double mean_anomaly0;   ///< The mean anomaly at the epoch.
+
+        public:
+            kepler_orbit();
+            kepler_orbit(const gsgl::math::dvector & position, const gsgl::math::dvector & velocity, const double & mu, const double & epoch);
+
+            const double & get_semi_major_axis() const { return a; }
+            const double & get_eccentricity() const { return e; }
+            bool is_hyperbolic() const { return a < 0; }
+
+            /// Finds the position and velocity at time \c t (in seconds).
+            void evaluate(const double & t, gsgl::math::dvector & position, gsgl::math::dvector & velocity) const;
+        }; // class kepler_orbit
+
+
+    } // namespace space
+
+} // namespace periapsis
+
+#endif
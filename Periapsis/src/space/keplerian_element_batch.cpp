@@ -0,0 +1,181 @@
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/keplerian_element_batch.hpp"
+#include "space/kepler_equation.hpp"
+#include "math/units.hpp"
+
+#include <cmath>
+
+using namespace gsgl;
+using namespace gsgl::data;
+using namespace gsgl::math;
+
+namespace periapsis
+{
+
+    namespace space
+    {
+
+        enum { ELEMENTS = 0, RATES = 6, AUX = 12 };
+        enum { SEMI_MAJOR_AXIS = 0, ECCENTRICITY, INCLINATION, MEAN_LONGITUDE, PERIHELION, ASCENDING_NODE };
+
+        /// The number of orbits in each block, which is small enough for the block's temporaries to stay in the cache.
+        static const int BLOCK_SIZE = 256;
+
+
+        keplerian_element_batch::keplerian_element_batch()
+            : num_orbits(0)
+        {
+        } // keplerian_element_batch::keplerian_element_batch()
+
+
+        keplerian_element_batch::~keplerian_element_batch()
+        {
+        } // keplerian_element_batch::~keplerian_element_batch()
+
+
+        gsgl::index_t keplerian_element_batch::add(const keplerian_element_propagator *prop)
+        {
+            if (!prop || !prop->has_elements())
+                throw internal_exception(__FILE__, __LINE__, L"Only propagators with elements can be batched.");
+
+            const double *elements = prop->get_elements();
+            const double *rates = prop->get_rates();
+            const double *aux = prop->get_aux();
+
+            int c;
+            for (c = 0; c < 6; ++c)
+            {
+                components[ELEMENTS + c].append(elements[c]);
+                components[RATES + c].append(rates[c]);
+            }
+
+            for (c = 0; c < 4; ++c)
+                components[AUX + c].append(aux ? aux[c] : 0);
+
+            return num_orbits++;
+        } // keplerian_element_batch::add()
+
+
+        void keplerian_element_batch::clear()
+        {
+            for (int c = 0; c < NUM_COMPONENTS; ++c)
+                components[c].clear();
+
+            num_orbits = 0;
+        } // keplerian_element_batch::clear()
+
+
+        void keplerian_element_batch::evaluate(const double jdn, const gsgl::index_t begin, const gsgl::index_t end, double *x, double *y, double *z, double *vx, double *vy, double *vz) const
+        {
+            const double T = (jdn - 2451545.0) / 36525.0;
+            const double seconds_per_century = units::SECONDS_PER_YEAR * 100.0;
+
+            const double *el[6], *rt[6], *aux[4];
+            int c;
+
+            for (c = 0; c < 6; ++c)
+            {
+                el[c] = components[ELEMENTS + c].ptr();
+                rt[c] = components[RATES + c].ptr();
+            }
+
+            for (c = 0; c < 4; ++c)
+                aux[c] = components[AUX + c].ptr();
+
+            double a[BLOCK_SIZE], e[BLOCK_SIZE], M[BLOCK_SIZE], EA[BLOCK_SIZE];
+
+            for (gsgl::index_t block = begin; block < end; block += BLOCK_SIZE)
+            {
+                const int m = static_cast<int>(end - block < BLOCK_SIZE ? end - block : BLOCK_SIZE);
+                int k;
+
+                // current semi-major axis, eccentricity and mean anomaly, reduced to [-pi, pi)
+                for (k = 0; k < m; ++k)
+                {
+                    const gsgl::index_t i = block + k;
+
+                    a[k] = el[SEMI_MAJOR_AXIS][i] + rt[SEMI_MAJOR_AXIS][i] * T;
+                    e[k] = el[ECCENTRICITY][i] + rt[ECCENTRICITY][i] * T;
+
+                    double mean = (el[MEAN_LONGITUDE][i] + rt[MEAN_LONGITUDE][i] * T) - (el[PERIHELION][i] + rt[PERIHELION][i] * T)
+                                + aux[0][i]*T*T + aux[1][i]*::cos(aux[3][i]*T) + aux[2][i]*::sin(aux[3][i]*T);
+
+                    M[k] = mean - math::PI_TIMES_2 * ::floor((mean + math::PI) / math::PI_TIMES_2);
+                }
+
+                kepler_equation::solve_elliptic(m, M, e, EA);
+
+                // positions and velocities in the orbital plane, rotated into the reference plane
+                for (k = 0; k < m; ++k)
+                {
+                    const gsgl::index_t i = block + k;
+
+                    double I_cur = el[INCLINATION][i] + rt[INCLINATION][i] * T;
+                    double W_cur = el[PERIHELION][i] + rt[PERIHELION][i] * T;
+                    double O_cur = el[ASCENDING_NODE][i] + rt[ASCENDING_NODE][i] * T;
+                    double omega = W_cur - O_cur;
+
+                    double cos_E = ::cos(EA[k]), sin_E = ::sin(EA[k]);
+                    double root = ::sqrt(1.0 - e[k]*e[k]);
+                    double E_dot = rt[MEAN_LONGITUDE][i] / (1.0 - e[k]*cos_E);
+
+                    double x_prime = a[k] * (cos_E - e[k]);
+                    double y_prime = a[k] * root * sin_E;
+                    double x_dot_prime = -a[k] * sin_E * E_dot;
+                    double y_dot_prime = a[k] * root * cos_E * E_dot;
+
+                    double cos_o = ::cos(omega), sin_o = ::sin(omega);
+                    double cos_O = ::cos(O_cur), sin_O = ::sin(O_cur);
+                    double cos_I = ::cos(I_cur), sin_I = ::sin(I_cur);
+
+                    double r11 = cos_o*cos_O - sin_o*sin_O*cos_I, r12 = -sin_o*cos_O - cos_o*sin_O*cos_I;
+                    double r21 = cos_o*sin_O + sin_o*cos_O*cos_I, r22 = -sin_o*sin_O + cos_o*cos_O*cos_I;
+                    double r31 = sin_o*sin_I,                     r32 = cos_o*sin_I;
+
+                    x[i] = r11*x_prime + r12*y_prime;
+                    y[i] = r21*x_prime + r22*y_prime;
+                    z[i] = r31*x_prime + r32*y_prime;
+
+                    vx[i] = (r11*x_dot_prime + r12*y_dot_prime) / seconds_per_century;
+                    vy[i] = (r21*x_dot_prime + r22*y_dot_prime) / seconds_per_century;
+                    vz[i] = (r31*x_dot_prime + r32*y_dot_prime) / seconds_per_century;
+                }
+            }
+        } // keplerian_element_batch::evaluate()
+
+
+    } // namespace space
+
+} // namespace periapsis
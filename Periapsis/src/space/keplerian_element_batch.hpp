@@ -0,0 +1,94 @@
+#ifndef PERIAPSIS_SPACE_KEPLERIAN_ELEMENT_BATCH_H
+#define PERIAPSIS_SPACE_KEPLERIAN_ELEMENT_BATCH_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/space.hpp"
+#include "space/keplerian_element_propagator.hpp"
+#include "data/array.hpp"
+
+namespace periapsis
+{
+
+    namespace space
+    {
+
+        /// Evaluates many keplerian_element_propagator orbits at once.
+        /// The elements and rates are stored as structure-of-arrays, and the orbits are evaluated in blocks, each stage of which is a branch-free loop over the block.
+        /// Kepler's equation is solved for the whole block at once by kepler_equation::solve_elliptic(), which costs the same for every orbit.
+        class EPHEMERIS_API keplerian_element_batch
+        {
+        public:
+            /// The elements, then their rates, then the extra mean anomaly terms.
+            enum { NUM_COMPONENTS = 16 };
+
+        private:
+            gsgl::data::simple_array<double> components[NUM_COMPONENTS];
+            gsgl::index_t num_orbits;
+
+        public:
+            keplerian_element_batch();
+            ~keplerian_element_batch();
+
+            /// Adds a propagator's orbit.  It must have elements.
+            /// \return The orbit's index in the batch.
+            gsgl::index_t add(const keplerian_element_propagator *prop);
+            void clear();
+            gsgl::index_t size() const { return num_orbits; }
+
+            /// Finds the positions (relative to the parent frames, in their units) and velocities (in units / second) of the orbits in <tt>[begin, end)</tt> at Julian day \c jdn.
+            /// The output arrays are indexed by orbit.  Disjoint ranges may be evaluated concurrently.
+            void evaluate(const double jdn, const gsgl::index_t begin, const gsgl::index_t end, double *x, double *y, double *z, double *vx, double *vy, double *vz) const;
+        }; // class keplerian_element_batch
+
+
+        /// Lets parallel_for() evaluate a batch in chunks.
+        struct keplerian_element_range
+        {
+            const keplerian_element_batch *batch;
+            double jdn;
+            double *x, *y, *z, *vx, *vy, *vz;
+
+            void operator() (const gsgl::index_t begin, const gsgl::index_t end) const
+            {
+                batch->evaluate(jdn, begin, end, x, y, z, vx, vy, vz);
+            }
+        }; // struct keplerian_element_range
+
+
+    } // namespace space
+
+} // namespace periapsis
+
+#endif
@@ -32,6 +32,7 @@
 //
 
 #include "space/keplerian_element_propagator.hpp"
+#include "space/kepler_equation.hpp"
 #include "data/list.hpp"
 #include "math/units.hpp"
 
@@ -87,30 +88,7 @@ namespace periapsis
         } // keplerian_element_propagator::~keplerian_element_propagator()
 
 
-        static double calc_E(const double M, const double e_star, const double e)
-        {
-            double E_zero = M + e_star * ::sin(M);
-
-            double delta_M;
-            double delta_E;
-            double E_old;
-            double E_new = E_zero;
-            double tol = 1.0e-6;
-
-            do
-            {
-                E_old = E_new;
-                delta_M = M - (E_old - e_star * ::sin(E_old));
-                delta_E = delta_M / (1.0 - e * ::cos(E_old));
-                E_new = E_old + delta_E;
-            }
-            while (delta_E > tol);
-
-            return E_new;
-        } // calc_E()
-
-
-        void keplerian_element_propagator::update(const double jdn, vector & position, vector & velocity)
+        void keplerian_element_propagator::update(const double jdn, dvector & position, vector & velocity)
         {
             if (!has_data)
                 return;
@@ -129,20 +107,11 @@ namespace periapsis
             if (has_aux)
                 M += aux[0]*T*T + aux[1]*::cos(aux[3]*T) + aux[2]*::sin(aux[3]*T);
 
-            double M_plus = M + math::PI;
-            
-            while (M_plus < 0.0)
-                M_plus += math::PI * 2.0;
-            while (M_plus > math::PI * 2.0)
-                M_plus -= math::PI * 2.0;
-
-            M = M_plus - math::PI;
-
             // calculate mean motion
             double n = (cur_elements[3] - elements[3]) / T;
 
             // calculate the eccentric anomaly
-            double E = calc_E(M, cur_elements[1] * math::DEG2RAD, cur_elements[1]);
+            double E = kepler_equation::solve_elliptic(M, cur_elements[1]);
 
             // calculate the derivative of the eccentric anomaly
             double E_dot = n / (1.0f - cur_elements[1] * ::cos(E));
@@ -179,10 +148,7 @@ namespace periapsis
             z_dot /= units::SECONDS_PER_YEAR * 100.0;
 
             // set position and velocity
-            position.get_x() = static_cast<gsgl::real_t>(x);
-            position.get_y() = static_cast<gsgl::real_t>(y);
-            position.get_z() = static_cast<gsgl::real_t>(z);
-            position.get_w() = 1;
+            position = dvector(x, y, z);
 
             velocity.get_x() = static_cast<gsgl::real_t>(x_dot);
             velocity.get_y() = static_cast<gsgl::real_t>(y_dot);
@@ -54,7 +54,7 @@ namespace periapsis
         ///
         /// In order to work correctly, the parent node's scale must be set to AU.
 
-        class SPACE_API keplerian_element_propagator
+        class EPHEMERIS_API keplerian_element_propagator
             : public propagator
         {
             double elements[6];
@@ -66,7 +66,12 @@ namespace periapsis
             keplerian_element_propagator(const gsgl::data::config_record & obj_config);
             virtual ~keplerian_element_propagator();
 
-            virtual void update(const double jdn, gsgl::math::vector & position, gsgl::math::vector & velocity);
+            virtual void update(const double jdn, gsgl::math::dvector & position, gsgl::math::vector & velocity);
+
+            bool has_elements() const { return has_data; }
+            const double *get_elements() const { return elements; }        ///< a, e, I, L, W, O, with the angles in radians.
+            const double *get_rates() const { return rates; }              ///< The elements' rates per century, with the angles in radians.
+            const double *get_aux() const { return has_aux ? aux : 0; }    ///< The extra mean anomaly terms b, c, s, f (in radians), or 0 if there are none.
 
             BROKER_DECLARE_CREATOR(periapsis::space::keplerian_element_propagator);
 
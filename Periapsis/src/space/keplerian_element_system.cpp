@@ -0,0 +1,173 @@
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/keplerian_element_system.hpp"
+#include "platform/job_scheduler.hpp"
+
+using namespace gsgl;
+using namespace gsgl::data;
+using namespace gsgl::math;
+using namespace gsgl::platform;
+using namespace gsgl::scenegraph;
+
+// global keplerian element system
+periapsis::space::keplerian_element_system *periapsis::space::keplerian_element_system::instance = 0;
+
+namespace periapsis
+{
+
+    namespace space
+    {
+
+        /// Below this many orbits, evaluating them on the calling thread is quicker than handing them to the job scheduler.
+        static const gsgl::index_t MIN_PARALLEL_ORBITS = 4096;
+
+
+        keplerian_element_system::keplerian_element_system()
+            : singleton<keplerian_element_system>(), batch_valid(false)
+        {
+            simulation::add_tick_listener(this);
+        } // keplerian_element_system::keplerian_element_system()
+
+
+        keplerian_element_system::~keplerian_element_system()
+        {
+            simulation::remove_tick_listener(this);
+        } // keplerian_element_system::~keplerian_element_system()
+
+
+        bool keplerian_element_system::can_move(const propagator *prop)
+        {
+            const keplerian_element_propagator *kep = dynamic_cast<const keplerian_element_propagator *>(prop);
+            const satellite_element_propagator *sat = dynamic_cast<const satellite_element_propagator *>(prop);
+
+            return (kep && kep->has_elements()) || (sat && sat->has_elements());
+        } // keplerian_element_system::can_move()
+
+
+        void keplerian_element_system::add(orbital_frame *frame)
+        {
+            assert(frame && can_move(frame->get_propagator()));
+
+            if (dynamic_cast<const satellite_element_propagator *>(frame->get_propagator()))
+                satellite_frames.append(frame);
+            else
+                frames.append(frame);
+
+            batch_valid = false;
+        } // keplerian_element_system::add()
+
+
+        static bool remove_frame(simple_array<orbital_frame *> & frames, orbital_frame *frame)
+        {
+            for (gsgl::index_t i = 0; i < frames.size(); ++i)
+            {
+                if (frames[i] == frame)
+                {
+                    frames.remove(i);
+                    return true;
+                }
+            }
+
+            return false;
+        } // remove_frame()
+
+
+        void keplerian_element_system::remove(orbital_frame *frame)
+        {
+            if (remove_frame(frames, frame) || remove_frame(satellite_frames, frame))
+                batch_valid = false;
+        } // keplerian_element_system::remove()
+
+
+        void keplerian_element_system::pre_update(const simulation_context *c)
+        {
+            update(c->julian_cur);
+        } // keplerian_element_system::pre_update()
+
+
+        /// Evaluates a batch (in parallel, if it is large) and moves its frames to the results.
+        template <typename B, typename R>
+        static void move_frames(simple_array<orbital_frame *> & frames, const B & batch, simple_array<double> & results, const double jdn)
+        {
+            const gsgl::index_t n = frames.size();
+
+            if (n == 0)
+                return;
+
+            // writing past the end grows the array
+            if (results.size() < 6 * n)
+                results[6 * n - 1] = 0;
+
+            double *r = results.ptr();
+            R range = { &batch, jdn, r, r + n, r + 2*n, r + 3*n, r + 4*n, r + 5*n };
+
+            job_scheduler *jobs = job_scheduler::global_instance();
+            if (jobs && n >= MIN_PARALLEL_ORBITS)
+                parallel_for(*jobs, 0, n, range);
+            else
+                range(0, n);
+
+            for (gsgl::index_t i = 0; i < n; ++i)
+            {
+                frames[i]->set_translation(dvector(range.x[i], range.y[i], range.z[i]));
+                frames[i]->get_linear_velocity() = vector(static_cast<gsgl::real_t>(range.vx[i]), static_cast<gsgl::real_t>(range.vy[i]), static_cast<gsgl::real_t>(range.vz[i]));
+            }
+        } // move_frames()
+
+
+        void keplerian_element_system::update(const double jdn)
+        {
+            gsgl::index_t i;
+
+            if (!batch_valid)
+            {
+                batch.clear();
+                for (i = 0; i < frames.size(); ++i)
+                    batch.add(dynamic_cast<const keplerian_element_propagator *>(frames[i]->get_propagator()));
+
+                satellite_batch.clear();
+                for (i = 0; i < satellite_frames.size(); ++i)
+                    satellite_batch.add(dynamic_cast<const satellite_element_propagator *>(satellite_frames[i]->get_propagator()));
+
+                batch_valid = true;
+            }
+
+            move_frames<keplerian_element_batch, keplerian_element_range>(frames, batch, results, jdn);
+            move_frames<satellite_element_batch, satellite_element_range>(satellite_frames, satellite_batch, results, jdn);
+        } // keplerian_element_system::update()
+
+
+    } // namespace space
+
+} // namespace periapsis
@@ -0,0 +1,90 @@
+#ifndef PERIAPSIS_SPACE_KEPLERIAN_ELEMENT_SYSTEM_H
+#define PERIAPSIS_SPACE_KEPLERIAN_ELEMENT_SYSTEM_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/space.hpp"
+#include "space/orbital_frame.hpp"
+#include "space/keplerian_element_batch.hpp"
+#include "space/satellite_element_batch.hpp"
+
+#include "data/singleton.hpp"
+#include "data/array.hpp"
+#include "scenegraph/simulation.hpp"
+
+namespace periapsis
+{
+
+    namespace space
+    {
+
+        /// Moves all the orbital frames whose propagators are Keplerian or satellite elements together.
+        /// Their elements are gathered into a keplerian_element_batch and a satellite_element_batch, which are evaluated once per tick (in parallel, if there are many), and the results are scattered back to the frames.
+        /// When space/orbital_frame/batch is set, such frames join the global instance as they are initialized, creating it if need be, and it is deleted when the last one leaves.
+        class SPACE_API keplerian_element_system
+            : public gsgl::data::singleton<keplerian_element_system>, public gsgl::scenegraph::tick_listener
+        {
+            gsgl::data::simple_array<orbital_frame *> frames;
+            gsgl::data::simple_array<orbital_frame *> satellite_frames;
+
+            keplerian_element_batch batch;
+            satellite_element_batch satellite_batch;
+            bool batch_valid;   ///< Whether the batches hold the current frames' elements.
+
+            gsgl::data::simple_array<double> results;   ///< The frames' positions, then their velocities, structure-of-arrays.
+
+        public:
+            keplerian_element_system();
+            virtual ~keplerian_element_system();
+
+            /// \return Whether the system can move a frame with this propagator.
+            static bool can_move(const propagator *prop);
+
+            void add(orbital_frame *frame);
+            void remove(orbital_frame *frame);
+            gsgl::index_t size() const { return frames.size() + satellite_frames.size(); }
+
+            /// Moves the frames to the context's Julian day.
+            virtual void pre_update(const gsgl::scenegraph::simulation_context *c);
+
+            /// Moves the frames to their positions at Julian day \c jdn.
+            void update(const double jdn);
+        }; // class keplerian_element_system
+
+
+    } // namespace space
+
+} // namespace periapsis
+
+#endif
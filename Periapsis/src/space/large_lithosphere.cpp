@@ -338,6 +338,13 @@ namespace periapsis
         } // large_lithosphere::draw()
 
 
+        /// Splitting and merging the quadtree creates and deletes vertex buffers, which has to happen on the thread that owns the OpenGL context.
+        node::node_update_mode large_lithosphere::get_update_mode() const
+        {
+            return NODE_UPDATE_SERIAL;
+        } // large_lithosphere::get_update_mode()
+
+
         void large_lithosphere::update(const simulation_context *c)
         {
             // rotate into the right position
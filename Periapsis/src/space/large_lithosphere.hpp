@@ -68,6 +68,8 @@ namespace periapsis
             virtual void draw(const gsgl::scenegraph::simulation_context *, const gsgl::scenegraph::drawing_context *);
             virtual void update(const gsgl::scenegraph::simulation_context *);
             virtual void cleanup(const gsgl::scenegraph::simulation_context *);
+
+            virtual node_update_mode get_update_mode() const;
         }; // class large_lithosphere
 
 
@@ -32,7 +32,10 @@
 //
 
 #include "orbital_frame.hpp"
+#include "space/keplerian_element_system.hpp"
+#include "space/ephemeris_table.hpp"
 #include "data/broker.hpp"
+#include "data/config.hpp"
 #include "math/units.hpp"
 #include "scenegraph/utils.hpp"
 
@@ -50,8 +53,11 @@ namespace periapsis
     namespace space
     {
 
+        static config_variable<int> BATCH(L"space/orbital_frame/batch", 1);   ///< Move the frames with keplerian or satellite elements together, in a keplerian_element_system.
+
+
         orbital_frame::orbital_frame(const config_record & obj_config)
-            : physics_frame(obj_config), prop(0)
+            : physics_frame(obj_config), prop(0), in_system(false)
         {
             if (!obj_config[L"propagator"].is_empty())
             {
@@ -59,12 +65,23 @@ namespace periapsis
                 
                 if (!prop)
                     throw runtime_exception(L"Unable to create propagator %ls", obj_config[L"propagator"].w_string());
+
+                prop = ephemeris_propagator::use_table(get_name(), prop);
             }
         } // orbital_frame::~orbital_frame()
 
 
         orbital_frame::~orbital_frame()
         {
+            if (in_system)
+            {
+                keplerian_element_system *system = keplerian_element_system::global_instance();
+                system->remove(this);
+
+                if (system->size() == 0)
+                    delete system;
+            }
+
             delete prop;
         } // orbital_frame::~orbital_frame()
 
@@ -74,7 +91,21 @@ namespace periapsis
         void orbital_frame::init(const simulation_context *c)
         {
             if (prop)
-                prop->update(c->julian_cur, get_translation(), get_linear_velocity());
+            {
+                // a propagator without elements, or outside its table, leaves the frame where it is
+                dvector position = get_precise_translation();
+                prop->update(c->julian_cur, position, get_linear_velocity());
+                set_translation(position);
+
+                if (BATCH && !in_system && keplerian_element_system::can_move(prop))
+                {
+                    if (!keplerian_element_system::global_instance())
+                        new keplerian_element_system();
+
+                    keplerian_element_system::global_instance()->add(this);
+                    in_system = true;
+                }
+            }
 
             assert(get_angular_velocity().mag() == 0);
         } // orbital_frame::init()
@@ -82,8 +113,13 @@ namespace periapsis
 
         void orbital_frame::update(const simulation_context *c)
         {
-            if (prop)
-                prop->update(c->julian_cur, get_translation(), get_linear_velocity());
+            // the system has already moved us this tick
+            if (prop && !in_system)
+            {
+                dvector position = get_precise_translation();
+                prop->update(c->julian_cur, position, get_linear_velocity());
+                set_translation(position);
+            }
 
             assert(get_angular_velocity().mag() == 0);
         } // orbital_frame::update()
@@ -50,11 +50,14 @@ namespace periapsis
             : public gsgl::physics::physics_frame
         {
             propagator *prop;
+            bool in_system; ///< Whether the frame is moved by the global keplerian_element_system, rather than by its own propagator.
 
         public:
             orbital_frame(const gsgl::data::config_record & obj_config);
             virtual ~orbital_frame();
 
+            propagator *get_propagator() { return prop; }
+
             virtual void init(const gsgl::scenegraph::simulation_context *);
             virtual void update(const gsgl::scenegraph::simulation_context *);
         }; // class orbital_frame
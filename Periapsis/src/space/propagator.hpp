@@ -38,6 +38,7 @@
 #include "data/broker.hpp"
 #include "data/config.hpp"
 #include "math/vector.hpp"
+#include "math/dvector.hpp"
 
 namespace periapsis
 {
@@ -47,14 +48,15 @@ namespace periapsis
 
 
         /// Base class for orbital propagators.
-        class SPACE_API propagator
+        /// Positions are returned in double precision; they are relative to the parent frame, which may be far from the origin of the scene.
+        class EPHEMERIS_API propagator
             : public gsgl::data::brokered_object
         {
         public:
             propagator(const gsgl::data::config_record & obj_config);
             virtual ~propagator();
 
-            virtual void update(const double jdn, gsgl::math::vector & position, gsgl::math::vector & velocity) = 0;
+            virtual void update(const double jdn, gsgl::math::dvector & position, gsgl::math::vector & velocity) = 0;
         }; // class propagator
 
     } // namespace space
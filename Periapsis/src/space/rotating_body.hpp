@@ -35,7 +35,7 @@
 //
 
 #include "space/space.hpp"
-#include "data/broker.hpp"
+#include "space/body_rotator.hpp"
 #include "scenegraph/node.hpp"
 #include "physics/physics_frame.hpp"
 
@@ -45,19 +45,6 @@ namespace periapsis
     namespace space
     {
 
-        /// Base class for celestial body rotators.
-        class SPACE_API body_rotator
-            : public gsgl::data::brokered_object
-        {
-        public:        
-            virtual void calc_orientation(double jdn, gsgl::math::transform & orientation, gsgl::math::vector & angular_velocity) = 0;
-
-        protected:
-            void calc_orientation_aux(double alpha, double delta, double W, gsgl::math::transform & orientation);
-            void calc_angular_velocity_aux(double ang_diff, double d, const gsgl::math::transform & orientation, gsgl::math::vector & angular_velocity);
-        }; // class body_rotator
-
-
         /// Implements bodies that are rotated using a body_rotator.
         class SPACE_API rotating_body
             : public gsgl::physics::physics_frame
@@ -0,0 +1,111 @@
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/satellite_element_batch.hpp"
+
+#include <cmath>
+
+using namespace gsgl;
+using namespace gsgl::data;
+
+namespace periapsis
+{
+
+    namespace space
+    {
+
+        typedef satellite_element_propagator prop_t;
+
+
+        satellite_element_batch::satellite_element_batch()
+            : num_orbits(0)
+        {
+        } // satellite_element_batch::satellite_element_batch()
+
+
+        satellite_element_batch::~satellite_element_batch()
+        {
+        } // satellite_element_batch::~satellite_element_batch()
+
+
+        gsgl::index_t satellite_element_batch::add(const satellite_element_propagator *prop)
+        {
+            if (!prop || !prop->has_elements())
+                throw internal_exception(__FILE__, __LINE__, L"Only propagators with elements can be batched.");
+
+            const double *prop_terms = prop->get_terms();
+
+            for (int c = 0; c < prop_t::NUM_TERMS; ++c)
+                terms[c].append(prop_terms[c]);
+
+            return num_orbits++;
+        } // satellite_element_batch::add()
+
+
+        void satellite_element_batch::clear()
+        {
+            for (int c = 0; c < prop_t::NUM_TERMS; ++c)
+                terms[c].clear();
+
+            num_orbits = 0;
+        } // satellite_element_batch::clear()
+
+
+        void satellite_element_batch::evaluate(const double jdn, const gsgl::index_t begin, const gsgl::index_t end, double *x, double *y, double *z, double *vx, double *vy, double *vz) const
+        {
+            const double d = jdn - 2451545.0;
+
+            const double *node = terms[prop_t::NODE].ptr(), *node_rate = terms[prop_t::NODE_RATE].ptr();
+            const double *px = terms[prop_t::POSITION_X].ptr(), *py = terms[prop_t::POSITION_Y].ptr(), *pz = terms[prop_t::POSITION_Z].ptr();
+            const double *vx0 = terms[prop_t::VELOCITY_X].ptr(), *vy0 = terms[prop_t::VELOCITY_Y].ptr(), *vz0 = terms[prop_t::VELOCITY_Z].ptr();
+
+            // turn each orbit about the pole to its current node
+            for (gsgl::index_t i = begin; i < end; ++i)
+            {
+                double cur_node = node[i] + node_rate[i] * d;
+                double cos_O = ::cos(cur_node), sin_O = ::sin(cur_node);
+
+                x[i] = cos_O*px[i] - sin_O*py[i];
+                y[i] = sin_O*px[i] + cos_O*py[i];
+                z[i] = pz[i];
+
+                vx[i] = cos_O*vx0[i] - sin_O*vy0[i];
+                vy[i] = sin_O*vx0[i] + cos_O*vy0[i];
+                vz[i] = vz0[i];
+            }
+        } // satellite_element_batch::evaluate()
+
+
+    } // namespace space
+
+} // namespace periapsis
@@ -32,6 +32,7 @@
 //
 
 #include "space/satellite_element_propagator.hpp"
+#include "space/kepler_equation.hpp"
 #include "data/list.hpp"
 #include "math/units.hpp"
 
@@ -86,31 +87,10 @@ namespace periapsis
                 {
                     data[i] *= math::DEG2RAD;
                 }
-            }
-        } // satellite_element_propagator::get_elements()
-
-
-        static double calc_E(const double M, const double e_star, const double e)
-        {
-            double E_zero = M + e_star * ::sin(M);
-
-            double delta_M;
-            double delta_E;
-            double E_old;
-            double E_new = E_zero;
-            double tol = 1.0e-6;
 
-            do
-            {
-                E_old = E_new;
-                delta_M = M - (E_old - e_star * ::sin(E_old));
-                delta_E = delta_M / (1.0 - e * ::cos(E_old));
-                E_new = E_old + delta_E;
+                calc_terms();
             }
-            while (delta_E > tol);
-
-            return E_new;
-        } // calc_E()
+        } // satellite_element_propagator::get_elements()
 
 
         // planetary elements
@@ -139,101 +119,59 @@ namespace periapsis
         // 12 tlit: tilt of the laplace plane
 
 
+        /// The mean anomaly is held at M, and the body is carried around by the node moving at the longitude rate, so only the node changes with time.
         /// \todo Handle precession.
         /// \todo Handle Laplace Planes.
-        void satellite_element_propagator::update(const double jdn, vector & position, vector & velocity)
+        void satellite_element_propagator::calc_terms()
+        {
+            const double a = data[0], e = data[1], w = data[2], M = data[3], I = data[4], n = data[6];
+
+            // calculate the eccentric anomaly and its derivative
+            double E = kepler_equation::solve_elliptic(M, e);
+            double cos_E = ::cos(E), sin_E = ::sin(E);
+            double root = ::sqrt(1.0 - e*e);
+            double E_dot = n / (1.0 - e*cos_E);
+
+            // compute the body's coordinates and velocity in its orbital plane (km and km/day)
+            double x_prime = a * (cos_E - e);
+            double y_prime = a * root * sin_E;
+            double x_dot_prime = -a * sin_E * E_dot;
+            double y_dot_prime = a * root * cos_E * E_dot;
+
+            // turn them by the argument of periapsis and tilt them by the inclination, leaving the node at 0, and convert them to meters and meters/second
+            double cos_w = ::cos(w), sin_w = ::sin(w);
+            double cos_I = ::cos(I), sin_I = ::sin(I);
+
+            const double to_meters = units::METERS_PER_KILOMETER;
+            const double to_meters_per_second = units::METERS_PER_KILOMETER / units::SECONDS_PER_DAY;
+
+            terms[NODE] = data[5];
+            terms[NODE_RATE] = n;
+
+            terms[POSITION_X] = (cos_w*x_prime - sin_w*y_prime) * to_meters;
+            terms[POSITION_Y] = (sin_w*x_prime + cos_w*y_prime) * cos_I * to_meters;
+            terms[POSITION_Z] = (sin_w*x_prime + cos_w*y_prime) * sin_I * to_meters;
+
+            terms[VELOCITY_X] = (cos_w*x_dot_prime - sin_w*y_dot_prime) * to_meters_per_second;
+            terms[VELOCITY_Y] = (sin_w*x_dot_prime + cos_w*y_dot_prime) * cos_I * to_meters_per_second;
+            terms[VELOCITY_Z] = (sin_w*x_dot_prime + cos_w*y_dot_prime) * sin_I * to_meters_per_second;
+        } // satellite_element_propagator::calc_terms()
+
+
+        void satellite_element_propagator::update(const double jdn, dvector & position, vector & velocity)
         {
             if (!has_data)
                 return;
 
-            // get current sat elements
-            double sats[6];
-            double days_since_epoch = jdn - 2451545.0;
-
-            for (int i = 0; i < 6; ++i)
-                sats[i] = data[i];
-
-            sats[5] += data[6] * days_since_epoch;
-
-            // get keplerian elements from those 
-            double cur_elements[6];
-
-            cur_elements[0] = sats[0];                     // semi-major axis (km)
-            cur_elements[1] = sats[1];                     // eccentricity
-            cur_elements[2] = sats[4];                     // inclination (degrees)
-            cur_elements[3] = sats[3] + sats[5] + sats[2]; // mean longitude (M + O + w)
-            cur_elements[4] = sats[5] + sats[2];           // longitude of periapsis (O + w)
-            cur_elements[5] = sats[5];                     // longitude of the ascending node
-
-            // solve
-
-            // calculate argument of perihelion and mean anomaly
-            double omega = sats[2]; // cur_elements[4] - cur_elements[5];
-            double M = sats[3]; // cur_elements[3] - cur_elements[4];
-
-            double M_plus = M + math::PI;
-            
-            while (M_plus < 0.0)
-                M_plus += math::PI * 2.0;
-            while (M_plus > math::PI * 2.0)
-                M_plus -= math::PI * 2.0;
-
-            M = M_plus - math::PI;
-
-            // calculate mean motion
-            double n = (cur_elements[3] - (data[3] + data[5] + data[2])) / days_since_epoch;
-
-            // calculate the eccentric anomaly
-            double E = calc_E(M, cur_elements[1] * math::DEG2RAD, cur_elements[1]);
-
-            // calculate the derivative of the eccentric anomaly
-            double E_dot = n / (1.0f - cur_elements[1] * ::cos(E));
-
-            // compute the planet's coordinates in its orbital plane
-            double x_prime = cur_elements[0] * (::cos(E) - cur_elements[1]);
-            double y_prime = cur_elements[0] * (::sqrt(1.0f - cur_elements[1]*cur_elements[1]) * ::sin(E));
-            double z_prime = 0.0f;
-
-            // compute the planet's velocity in its orbital plane
-            double x_dot_prime = cur_elements[0] * ( -::sin(E) * E_dot );
-            double y_dot_prime = cur_elements[0] * (::sqrt(1.0f - cur_elements[1]*cur_elements[1]) * ::cos(E) * E_dot);
-
-            // compute the planet's coordinates in the ecliptic plane
-            double cos_o = ::cos(omega);
-            double cos_O = ::cos(cur_elements[5]);
-            double cos_I = ::cos(cur_elements[2]);
-            double sin_o = ::sin(omega);
-            double sin_O = ::sin(cur_elements[5]);
-            double sin_I = ::sin(cur_elements[2]);
-
-            double x = (cos_o*cos_O - sin_o*sin_O*cos_I) * x_prime + (-sin_o*cos_O - cos_o*sin_O*cos_I) * y_prime;
-            double y = (cos_o*sin_O + sin_o*cos_O*cos_I) * x_prime + (-sin_o*sin_O + cos_o*cos_O*cos_I) * y_prime;
-            double z = (sin_o*sin_I)*x_prime + (cos_o*sin_I)*y_prime;
-
-            // compute the planet's velocity in the ecliptic plane
-            double x_dot = (cos_o*cos_O - sin_o*sin_O*cos_I) * x_dot_prime + (-sin_o*cos_O - cos_o*sin_O*cos_I) * y_dot_prime;
-            double y_dot = (cos_o*sin_O + sin_o*cos_O*cos_I) * x_dot_prime + (-sin_o*sin_O + cos_o*cos_O*cos_I) * y_dot_prime;
-            double z_dot = (sin_o*sin_I)*x_dot_prime + (cos_o*sin_I)*y_dot_prime;
-
-            // convert position into meters
-            x *= units::METERS_PER_KILOMETER;
-            y *= units::METERS_PER_KILOMETER;
-            z *= units::METERS_PER_KILOMETER;
-
-            // convert velocity into meters/second
-            x_dot *= units::METERS_PER_KILOMETER / units::SECONDS_PER_DAY;
-            y_dot *= units::METERS_PER_KILOMETER / units::SECONDS_PER_DAY;
-            z_dot *= units::METERS_PER_KILOMETER / units::SECONDS_PER_DAY;
-
-            // set position and velocity
-            position.get_x() = static_cast<gsgl::real_t>(x);
-            position.get_y() = static_cast<gsgl::real_t>(y);
-            position.get_z() = static_cast<gsgl::real_t>(z);
-            position.get_w() = 1;
-
-            velocity.get_x() = static_cast<gsgl::real_t>(x_dot);
-            velocity.get_y() = static_cast<gsgl::real_t>(y_dot);
-            velocity.get_z() = static_cast<gsgl::real_t>(z_dot);
+            // turn the orbit about the pole to the current node
+            double node = terms[NODE] + terms[NODE_RATE] * (jdn - 2451545.0);
+            double cos_O = ::cos(node), sin_O = ::sin(node);
+
+            position = dvector(cos_O*terms[POSITION_X] - sin_O*terms[POSITION_Y], sin_O*terms[POSITION_X] + cos_O*terms[POSITION_Y], terms[POSITION_Z]);
+
+            velocity.get_x() = static_cast<gsgl::real_t>(cos_O*terms[VELOCITY_X] - sin_O*terms[VELOCITY_Y]);
+            velocity.get_y() = static_cast<gsgl::real_t>(sin_O*terms[VELOCITY_X] + cos_O*terms[VELOCITY_Y]);
+            velocity.get_z() = static_cast<gsgl::real_t>(terms[VELOCITY_Z]);
             velocity.get_w() = 1;
         } // satellite_element_propagator::update()
 
@@ -61,22 +61,35 @@ namespace periapsis
         ///
         /// Note that this transforms from kilometers/days to meters/seconds.
         
-        class SPACE_API satellite_element_propagator
+        class EPHEMERIS_API satellite_element_propagator
             : public propagator
         {
+        public:
+            /// The terms of the orbit that don't change with time; see get_terms().
+            enum { NODE, NODE_RATE, POSITION_X, POSITION_Y, POSITION_Z, VELOCITY_X, VELOCITY_Y, VELOCITY_Z, NUM_TERMS };
+
+        private:
             double data[13];
+            double terms[NUM_TERMS];
             bool has_data;
 
         public:
             satellite_element_propagator(const gsgl::data::config_record & obj_config);
             virtual ~satellite_element_propagator();
 
-            virtual void update(const double jdn, gsgl::math::vector & position, gsgl::math::vector & velocity);
+            virtual void update(const double jdn, gsgl::math::dvector & position, gsgl::math::vector & velocity);
+
+            bool has_elements() const { return has_data; }
+
+            /// The terms found once when the elements are read, so that update() need only turn them about the pole: the longitude of the ascending node at J2000 (radians) and its rate (radians/day),
+            /// then the position (m) and velocity (m/s) that the body would have if the node were at 0.
+            const double *get_terms() const { return terms; }
 
             BROKER_DECLARE_CREATOR(periapsis::space::satellite_element_propagator);
 
         private:
             void get_elements(const gsgl::string & str);
+            void calc_terms();
         }; // class satellite_element_propagator
 
     } // namespace space
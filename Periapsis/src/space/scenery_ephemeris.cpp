@@ -0,0 +1,408 @@
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/scenery_ephemeris.hpp"
+#include "data/config.hpp"
+#include "data/broker.hpp"
+#include "math/units.hpp"
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+using namespace gsgl;
+using namespace gsgl::data;
+using namespace gsgl::math;
+
+namespace periapsis
+{
+
+    namespace space
+    {
+
+        struct scenery_ephemeris::body_info
+        {
+            string name;
+            gsgl::index_t parent;           ///< -1 for a root.
+
+            double scale;                   ///< Meters per unit of the body's frame.
+            dvector position;               ///< The position in the parent's frame, if there is no propagator.
+            transform frame_orientation;    ///< The orientation of the body's frame, relative to its root.
+
+            propagator *prop;
+            body_rotator *rotator;
+        }; // struct scenery_ephemeris::body_info
+
+
+        //////////////////////////////////////////////////////////////
+
+        // Queries are split into shares, one for each thread.  The job scheduler needs SDL, so this library starts its own threads.
+
+        typedef void (*share_function)(void *query, const gsgl::index_t begin, const gsgl::index_t end);
+
+        struct query_share
+        {
+            share_function fn;
+            void *query;
+            gsgl::index_t begin, end;
+
+            bool started;
+#ifdef WIN32
+            HANDLE thread;
+#else
+            pthread_t thread;
+#endif
+        }; // struct query_share
+
+
+#ifdef WIN32
+        static DWORD WINAPI run_share(LPVOID data)
+#else
+        static void *run_share(void *data)
+#endif
+        {
+            query_share *share = static_cast<query_share *>(data);
+            share->fn(share->query, share->begin, share->end);
+            return 0;
+        } // run_share()
+
+
+        static void run_shares(share_function fn, void *query, const gsgl::index_t count, int num_threads)
+        {
+            if (num_threads > count)
+                num_threads = static_cast<int>(count);
+
+            if (num_threads <= 1)
+            {
+                if (count > 0)
+                    fn(query, 0, count);
+                return;
+            }
+
+            simple_array<query_share> shares;
+
+            for (int i = 0; i < num_threads; ++i)
+            {
+                query_share & share = shares[i];
+
+                share.fn = fn;
+                share.query = query;
+                share.begin = i * (count / num_threads) + gsgl::min_val<gsgl::index_t>(i, count % num_threads);
+                share.end = share.begin + count / num_threads + (i < count % num_threads ? 1 : 0);
+            }
+
+            // the first share is done on this thread; a share whose thread won't start is done here as well
+            for (int i = 1; i < num_threads; ++i)
+            {
+#ifdef WIN32
+                shares[i].thread = ::CreateThread(0, 0, run_share, &shares[i], 0, 0);
+                shares[i].started = shares[i].thread != 0;
+#else
+                shares[i].started = ::pthread_create(&shares[i].thread, 0, run_share, &shares[i]) == 0;
+#endif
+            }
+
+            for (int i = 0; i < num_threads; ++i)
+            {
+                if (i == 0 || !shares[i].started)
+                    run_share(&shares[i]);
+            }
+
+            for (int i = 1; i < num_threads; ++i)
+            {
+                if (shares[i].started)
+                {
+#ifdef WIN32
+                    ::WaitForSingleObject(shares[i].thread, INFINITE);
+                    ::CloseHandle(shares[i].thread);
+#else
+                    ::pthread_join(shares[i].thread, 0);
+#endif
+                }
+            }
+        } // run_shares()
+
+
+        struct position_query
+        {
+            const scenery_ephemeris *ephemeris;
+            const gsgl::index_t *body_indices;
+            gsgl::index_t num_times;
+            const double *jdns;
+            dvector *positions;
+        }; // struct position_query
+
+
+        struct orientation_query
+        {
+            scenery_ephemeris *ephemeris;
+            const gsgl::index_t *body_indices;
+            gsgl::index_t num_times;
+            const double *jdns;
+            transform *orientations;
+        }; // struct orientation_query
+
+
+        //////////////////////////////////////////////////////////////
+
+        scenery_ephemeris::scenery_ephemeris(const string & fname)
+            : num_threads(0)
+        {
+            config_record scn_config(fname);
+
+            if (scn_config.get_name() != L"scenery")
+                throw runtime_exception(L"Invalid scenery specification in %ls.", fname.w_string());
+
+            try
+            {
+                for (list<config_record>::const_iterator i = scn_config.get_children().iter(); i.is_valid(); ++i)
+                {
+                    if (i->get_name() != L"description")
+                        add_body(*i, -1);
+                }
+            }
+            catch (...)
+            {
+                free_bodies();
+                throw;
+            }
+        } // scenery_ephemeris::scenery_ephemeris()
+
+
+        scenery_ephemeris::~scenery_ephemeris()
+        {
+            free_bodies();
+        } // scenery_ephemeris::~scenery_ephemeris()
+
+
+        void scenery_ephemeris::free_bodies()
+        {
+            for (simple_array<body_info *>::iterator i = bodies.iter(); i.is_valid(); ++i)
+            {
+                delete (*i)->prop;
+                delete (*i)->rotator;
+                delete *i;
+            }
+
+            bodies.clear();
+        } // scenery_ephemeris::free_bodies()
+
+
+        void scenery_ephemeris::add_body(const config_record & obj_config, const gsgl::index_t parent)
+        {
+            // the body is in the list before anything that can throw, so the constructor can free it
+            gsgl::index_t index = bodies.size();
+            body_info *body = new body_info();
+            body->prop = 0;
+            body->rotator = 0;
+            bodies.append(body);
+
+            body->name = obj_config[L"name"];
+            body->parent = parent;
+            body->scale = obj_config[L"scale"].is_empty() ? 1.0 : units::parse(obj_config[L"scale"]);
+            body->position = obj_config[L"position"].is_empty() ? dvector() : dvector(vector::parse(obj_config[L"position"]));
+
+            // a root's own position and orientation are relative to things that aren't in the file
+            if (parent == -1)
+                body->frame_orientation = transform::IDENTITY;
+            else if (obj_config[L"orientation"].is_empty())
+                body->frame_orientation = bodies[parent]->frame_orientation;
+            else
+                body->frame_orientation = bodies[parent]->frame_orientation * transform::parse(obj_config[L"orientation"]);
+
+            if (!obj_config[L"propagator"].is_empty())
+            {
+                brokered_object *obj = broker::global_instance()->create_object(obj_config[L"propagator"], obj_config);
+                body->prop = dynamic_cast<propagator *>(obj);
+
+                if (!body->prop)
+                {
+                    delete obj;
+                    throw runtime_exception(L"Unable to create propagator %ls", obj_config[L"propagator"].w_string());
+                }
+            }
+
+            if (!obj_config[L"rotator"].is_empty())
+            {
+                brokered_object *obj = broker::global_instance()->create_object(obj_config[L"rotator"], obj_config);
+                body->rotator = dynamic_cast<body_rotator *>(obj);
+
+                if (!body->rotator)
+                {
+                    delete obj;
+                    throw runtime_exception(L"Unable to create rotator %ls", obj_config[L"rotator"].w_string());
+                }
+            }
+
+            for (list<config_record>::const_iterator i = obj_config.get_children().iter(); i.is_valid(); ++i)
+            {
+                if (i->get_name() != L"property")
+                    add_body(*i, index);
+            }
+        } // scenery_ephemeris::add_body()
+
+
+        const string & scenery_ephemeris::get_body_name(const gsgl::index_t body) const
+        {
+            return bodies[body]->name;
+        } // scenery_ephemeris::get_body_name()
+
+
+        gsgl::index_t scenery_ephemeris::find_body(const string & name) const
+        {
+            for (gsgl::index_t i = 0; i < bodies.size(); ++i)
+            {
+                if (bodies[i]->name == name)
+                    return i;
+            }
+
+            return -1;
+        } // scenery_ephemeris::find_body()
+
+
+        int scenery_ephemeris::get_num_threads() const
+        {
+            if (num_threads > 0)
+                return num_threads;
+
+#ifdef WIN32
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            return static_cast<int>(info.dwNumberOfProcessors);
+#else
+            long num = ::sysconf(_SC_NPROCESSORS_ONLN);
+            return num > 0 ? static_cast<int>(num) : 1;
+#endif
+        } // scenery_ephemeris::get_num_threads()
+
+
+        //
+
+        void scenery_ephemeris::get_position(const gsgl::index_t body, const double jdn, dvector & position) const
+        {
+            dvector translation;
+            vector velocity;
+
+            position = dvector();
+
+            for (gsgl::index_t i = body; bodies[i]->parent != -1; i = bodies[i]->parent)
+            {
+                const body_info *child = bodies[i];
+                const body_info *parent = bodies[child->parent];
+
+                if (child->prop)
+                    child->prop->update(jdn, translation, velocity);
+                else
+                    translation = child->position;
+
+                position += (translation * parent->scale).rotate_by(parent->frame_orientation);
+            }
+        } // scenery_ephemeris::get_position()
+
+
+        void scenery_ephemeris::find_positions(void *data, const gsgl::index_t begin, const gsgl::index_t end)
+        {
+            position_query *query = static_cast<position_query *>(data);
+
+            for (gsgl::index_t i = begin; i < end; ++i)
+                query->ephemeris->get_position(query->body_indices[i / query->num_times], query->jdns[i % query->num_times], query->positions[i]);
+        } // scenery_ephemeris::find_positions()
+
+
+        void scenery_ephemeris::get_positions(const gsgl::index_t num_bodies, const gsgl::index_t *body_indices, const gsgl::index_t num_times, const double *jdns, 
+                                              dvector *positions) const
+        {
+            for (gsgl::index_t i = 0; i < num_bodies; ++i)
+            {
+                if (body_indices[i] < 0 || body_indices[i] >= bodies.size())
+                    throw runtime_exception(L"Invalid body index %d in an ephemeris query.", body_indices[i]);
+            }
+
+            // the propagators work from their elements alone, so the same body can be found at different times on different threads
+            position_query query = { this, body_indices, num_times, jdns, positions };
+            run_shares(find_positions, &query, num_bodies * num_times, get_num_threads());
+        } // scenery_ephemeris::get_positions()
+
+
+        void scenery_ephemeris::find_orientations(void *data, const gsgl::index_t begin, const gsgl::index_t end)
+        {
+            orientation_query *query = static_cast<orientation_query *>(data);
+            vector angular_velocity;
+
+            for (gsgl::index_t i = begin; i < end; ++i)
+            {
+                body_info *body = query->ephemeris->bodies[query->body_indices[i]];
+                transform *orientations = query->orientations + i * query->num_times;
+
+                for (gsgl::index_t j = 0; j < query->num_times; ++j)
+                {
+                    if (body->rotator)
+                    {
+                        body->rotator->calc_orientation(query->jdns[j], orientations[j], angular_velocity);
+                        orientations[j] = body->frame_orientation * orientations[j];
+                    }
+                    else
+                    {
+                        orientations[j] = body->frame_orientation;
+                    }
+                }
+            }
+        } // scenery_ephemeris::find_orientations()
+
+
+        void scenery_ephemeris::get_orientations(const gsgl::index_t num_bodies, const gsgl::index_t *body_indices, const gsgl::index_t num_times, const double *jdns, 
+                                                 transform *orientations)
+        {
+            for (gsgl::index_t i = 0; i < num_bodies; ++i)
+            {
+                if (body_indices[i] < 0 || body_indices[i] >= bodies.size())
+                    throw runtime_exception(L"Invalid body index %d in an ephemeris query.", body_indices[i]);
+
+                for (gsgl::index_t j = 0; j < i; ++j)
+                {
+                    if (body_indices[j] == body_indices[i])
+                        throw runtime_exception(L"Body %d appears twice in an ephemeris query.", body_indices[i]);
+                }
+            }
+
+            orientation_query query = { this, body_indices, num_times, jdns, orientations };
+            run_shares(find_orientations, &query, num_bodies, get_num_threads());
+        } // scenery_ephemeris::get_orientations()
+
+
+    } // namespace space
+
+} // namespace periapsis
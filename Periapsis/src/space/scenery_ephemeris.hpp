@@ -0,0 +1,99 @@
+#ifndef PERIAPSIS_SPACE_SCENERY_EPHEMERIS_H
+#define PERIAPSIS_SPACE_SCENERY_EPHEMERIS_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/space.hpp"
+#include "space/propagator.hpp"
+#include "space/body_rotator.hpp"
+#include "data/array.hpp"
+#include "math/transform.hpp"
+
+namespace periapsis
+{
+
+    namespace space
+    {
+
+        /// Finds where the bodies in a scenery file are, and how they are turned, at any dates, without loading the scenery into a scenegraph.
+        /// This needs only the propagators and rotators, so it can be used by tools that have no display.
+        ///
+        /// The bodies' frames are nested as the scenegraph nests them: a body is placed in its parent's frame, at the position given by its propagator
+        /// (or its position attribute), in units of the parent's scale.  Each top-level object in the file is a root, at the origin.
+        /// Positions are in meters, and orientations are relative to the axes of the root that contains the body.
+        class EPHEMERIS_API scenery_ephemeris
+        {
+            struct body_info;
+            gsgl::data::simple_array<body_info *> bodies;
+
+            int num_threads;
+
+        public:
+            explicit scenery_ephemeris(const gsgl::string & fname);
+            ~scenery_ephemeris();
+
+            gsgl::index_t get_num_bodies() const { return bodies.size(); }
+            const gsgl::string & get_body_name(const gsgl::index_t body) const;
+
+            /// \return The index of the named body, or -1 if there is none.
+            gsgl::index_t find_body(const gsgl::string & name) const;
+
+            /// Sets the number of threads that answer a query; 0 uses one for each processor.
+            void set_num_threads(const int num) { num_threads = num; }
+
+            /// Finds the positions of the bodies numbered in \c body_indices at each of the Julian days in \c jdns.
+            /// The position of body_indices[i] at jdns[j] is put in positions[i*num_times + j].
+            void get_positions(const gsgl::index_t num_bodies, const gsgl::index_t *body_indices, const gsgl::index_t num_times, const double *jdns, 
+                               gsgl::math::dvector *positions) const;
+
+            /// Finds the orientations of the bodies, laid out as in get_positions().  A body without a rotator has the orientation of its frame.
+            /// Rotators keep some state, so each body is done by only one thread.
+            void get_orientations(const gsgl::index_t num_bodies, const gsgl::index_t *body_indices, const gsgl::index_t num_times, const double *jdns, 
+                                  gsgl::math::transform *orientations);
+
+        private:
+            void add_body(const gsgl::data::config_record & obj_config, const gsgl::index_t parent);
+            void free_bodies();
+            int get_num_threads() const;
+            void get_position(const gsgl::index_t body, const double jdn, gsgl::math::dvector & position) const;
+
+            static void find_positions(void *query, const gsgl::index_t begin, const gsgl::index_t end);
+            static void find_orientations(void *query, const gsgl::index_t begin, const gsgl::index_t end);
+        }; // class scenery_ephemeris
+
+    } // namespace space
+
+} // namespace periapsis
+
+#endif
@@ -43,8 +43,16 @@
 #else
 #define SPACE_API __declspec(dllimport)
 #endif
+
+// the orbits and rotations of the celestial bodies need no scenegraph, so they are built separately, into PeriapsisEphemeris
+#ifdef PERIAPSIS_EPHEMERIS_EXPORTS
+#define EPHEMERIS_API __declspec(dllexport)
+#else
+#define EPHEMERIS_API __declspec(dllimport)
+#endif
 #else
 #define SPACE_API
+#define EPHEMERIS_API
 #endif
 
 
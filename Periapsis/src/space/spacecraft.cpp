@@ -32,6 +32,11 @@
 //
 
 #include "space/spacecraft.hpp"
+#include "space/gravity_field.hpp"
+#include "space/celestial_body.hpp"
+#include "physics/rigid_body_system.hpp"
+
+#include "data/config.hpp"
 
 using namespace gsgl;
 using namespace gsgl::data;
@@ -48,6 +53,11 @@ namespace periapsis
         BROKER_DEFINE_CREATOR(periapsis::space::spacecraft);
 
 
+        static config_variable<int> GRAVITY(L"space/spacecraft/gravity", 1);   ///< Whether spacecraft feel the celestial bodies' gravity.
+        static config_variable<int> ON_RAILS(L"space/spacecraft/on_rails", 1); ///< Whether coasting spacecraft follow two-body orbits instead of being integrated.
+        static config_variable<gsgl::real_t> ON_RAILS_TIME_SCALE(L"space/spacecraft/on_rails_time_scale", 0.0f); ///< The lowest time scale at which coasting spacecraft go on rails.
+
+
         spacecraft_module::spacecraft_module(const config_record & obj_config)
             : vehicle_module(obj_config)
         {
@@ -59,22 +69,80 @@ namespace periapsis
         } // spacecraft_module::~spacecraft_module()
 
 
+        //
+
+        /// Moves spacecraft into and out of the rigid body system after they have left or gone on rails.
+        /// Spacecraft may be updated concurrently, so they can't change the shared system themselves; this is done at the start of the next tick instead, before the system steps.
+        class spacecraft_rails_listener
+            : public tick_listener
+        {
+        public:
+            simple_array<spacecraft *> vehicles;
+
+            spacecraft_rails_listener() { simulation::add_tick_listener(this, true); }
+            virtual ~spacecraft_rails_listener() { simulation::remove_tick_listener(this); }
+
+            virtual void pre_update(const simulation_context *)
+            {
+                for (gsgl::index_t i = 0; i < vehicles.size(); ++i)
+                    vehicles[i]->apply_rails_transition();
+            }
+        }; // class spacecraft_rails_listener
+
+
+        static spacecraft_rails_listener *rails_listener = 0;
+
+
         //
 
         spacecraft::spacecraft(const config_record & obj_config)
-            : vehicle(obj_config)
+            : vehicle(obj_config), frame_node(0), frame_time(0), 
+              on_rails(false), rails_left_system(false), rails_listening(false), rails_body(0)
         {
         } // spacecraft::spacecraft()
 
 
         spacecraft::~spacecraft()
         {
+            if (rails_listening)
+            {
+                gravity_field::remove_influence_user();
+
+                simple_array<spacecraft *>::iterator i = rails_listener->vehicles.find_value(this);
+                if (i.is_valid())
+                    rails_listener->vehicles.remove(i);
+
+                if (rails_listener->vehicles.size() == 0)
+                {
+                    delete rails_listener;
+                    rails_listener = 0;
+                }
+            }
+
+            // the system is left in place by apply_rails_transition(), even if it empties
+            if (rails_left_system)
+            {
+                rigid_body_system *system = rigid_body_system::global_instance();
+                if (system && system->size() == 0)
+                    delete system;
+            }
         } // spacecraft::~spacecraft()
 
 
         void spacecraft::init(const simulation_context *c)
         {
             vehicle::init(c);
+            find_frame(c->cur_time);
+
+            if (!rails_listening)
+            {
+                if (!rails_listener)
+                    rails_listener = new spacecraft_rails_listener();
+
+                rails_listener->vehicles.append(this);
+                gravity_field::add_influence_user();
+                rails_listening = true;
+            }
         } // spacecraft::init()
 
 
@@ -87,9 +155,37 @@ namespace periapsis
         static int accel = 0;
 
 
+        bool spacecraft::is_coasting() const
+        {
+            return accel == 0;
+        } // spacecraft::is_coasting()
+
+
         void spacecraft::update(const simulation_context *c)
         {
-            vehicle::update(c);
+            find_frame(c->cur_time);
+
+            gravity_field *field = gravity_field::global_instance();
+            celestial_body *dominant = 0;
+
+            if (ON_RAILS && GRAVITY && field && frame_node && is_coasting() && c->time_scale >= ON_RAILS_TIME_SCALE)
+                dominant = field->get_dominant_body(get_world_position());
+
+            if (dominant)
+            {
+                // the orbit is restarted on crossing into another body's sphere of influence
+                if (!on_rails || dominant != rails_body)
+                    enter_rails(c, dominant);
+
+                update_on_rails(c);
+            }
+            else
+            {
+                if (on_rails)
+                    leave_rails();
+
+                vehicle::update(c);
+            }
 
             double delta = c->cur_time - c->start_time;
 
@@ -132,9 +228,133 @@ namespace periapsis
                 torque = vector::ZERO;
                 break;
             }
+
+            if (GRAVITY)
+                force += calculate_gravity(t);
         } // spacecraft::calculate_force_and_torque()
 
 
+        vector spacecraft::calculate_gravity(const double & t)
+        {
+            gravity_field *field = gravity_field::global_instance();
+            node *frame = get_parent();
+
+            // this is called at every stage of a step, so the frame is only found once per tick
+            if (!field || !frame || frame != frame_node)
+                return vector::ZERO;
+
+            const double scale = frame->get_scale();
+
+            dvector origin = frame_position + frame_velocity * (t - frame_time);
+            dvector position = origin + (dvector(stage_position) * scale).rotate_by(frame_rotation);
+            dvector a = field->acceleration(position, t) - field->acceleration(origin, t);
+
+            return (a.rotate_by(frame_rotation_inverse) * (get_total_mass() / scale)).to_vector();
+        } // spacecraft::calculate_gravity()
+
+
+        void spacecraft::find_frame(const double & t)
+        {
+            frame_node = get_parent();
+            frame_time = t;
+
+            if (frame_node)
+            {
+                gravity_field::get_world_motion(frame_node, frame_position, frame_velocity, frame_rotation);
+                frame_rotation_inverse = frame_rotation.transpose();
+            }
+        } // spacecraft::find_frame()
+
+
+        dvector spacecraft::get_world_position()
+        {
+            return frame_position + (get_precise_translation() * frame_node->get_scale()).rotate_by(frame_rotation);
+        } // spacecraft::get_world_position()
+
+
+        /// The rails listener takes the vehicle out of the rigid body system before the next tick.
+        void spacecraft::enter_rails(const simulation_context *c, celestial_body *body)
+        {
+            // the body may be being updated concurrently, so its motion comes from the gravity field's cache, which it was just found in
+            dvector body_position, body_velocity;
+            gravity_field::global_instance()->get_source_motion(body, c->cur_time, body_position, body_velocity);
+
+            dvector position = get_world_position();
+            dvector velocity = frame_velocity + (dvector(v) * frame_node->get_scale()).rotate_by(frame_rotation);
+
+            rails_orbit = kepler_orbit(position - body_position, velocity - body_velocity, gravity_field::get_gm(body), c->cur_time);
+            rails_body = body;
+            on_rails = true;
+        } // spacecraft::enter_rails()
+
+
+        /// Until the rails listener puts the vehicle back in the rigid body system, rigid_body::update() integrates it.
+        void spacecraft::leave_rails()
+        {
+            on_rails = false;
+            rails_body = 0;
+        } // spacecraft::leave_rails()
+
+
+        /// Called between ticks, when nothing else is using the rigid body system.
+        void spacecraft::apply_rails_transition()
+        {
+            rigid_body_system *system = rigid_body_system::global_instance();
+
+            if (on_rails && in_system)
+            {
+                // the system would go on integrating us; it is not deleted if it empties, since the tick is going through the listeners
+                system->remove(this);
+                in_system = false;
+                rails_left_system = true;
+            }
+            else if (!on_rails && rails_left_system)
+            {
+                if (!system)
+                    system = new rigid_body_system();
+
+                system->add(this);
+                in_system = true;
+                rails_left_system = false;
+            }
+        } // spacecraft::apply_rails_transition()
+
+
+        /// Moves the vehicle to the end of the tick, as the integrator would have.
+        void spacecraft::update_on_rails(const simulation_context *c)
+        {
+            const double t = c->cur_time + c->delta_time;
+            const double scale = frame_node->get_scale();
+
+            // as in enter_rails(), the body's motion comes from the gravity field's cache
+            dvector body_position, body_velocity;
+            gravity_field::global_instance()->get_source_motion(rails_body, t, body_position, body_velocity);
+
+            dvector position, velocity;
+            rails_orbit.evaluate(t, position, velocity);
+
+            // the frame was found from the scene graph as it is now, so it is carried forward to the end of the tick
+            dvector offset = body_position - (frame_position + frame_velocity * (t - frame_time));
+
+            dvector x = (offset + position).rotate_by(frame_rotation_inverse) * (1.0 / scale);
+            dvector vel = (body_velocity - frame_velocity + velocity).rotate_by(frame_rotation_inverse) * (1.0 / scale);
+
+            cur_state.x = x.to_vector();
+            cur_state.p = vel.to_vector() * mass;
+
+            // with no torque the angular momentum is constant, so the vehicle keeps turning at its current angular velocity
+            gsgl::real_t w_mag = w.mag();
+            if (w_mag > 0)
+            {
+                cur_state.q = quaternion(w / w_mag, static_cast<gsgl::real_t>(w_mag * c->delta_time)) * cur_state.q;
+                cur_state.q.normalize();
+            }
+
+            apply_state();
+            set_translation(x);
+        } // spacecraft::update_on_rails()
+
+
     } // namespace space
 
 } // namespace periapsis
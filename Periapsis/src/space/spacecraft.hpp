@@ -35,9 +35,11 @@
 //
 
 #include "space/space.hpp"
+#include "space/kepler_orbit.hpp"
 #include "data/broker.hpp"
 #include "physics/vehicle.hpp"
 #include "physics/vehicle_module.hpp"
+#include "math/dvector.hpp"
 
 namespace periapsis
 {
@@ -45,6 +47,10 @@ namespace periapsis
     namespace space
     {
 
+        class celestial_body;
+        class spacecraft_rails_listener;
+
+
         class SPACE_API spacecraft_module
             : public gsgl::physics::vehicle_module
         {
@@ -57,6 +63,25 @@ namespace periapsis
         class SPACE_API spacecraft
             : public gsgl::physics::vehicle
         {
+            /// \name The parent frame's motion relative to the root, found once per tick.
+            /// @{
+            gsgl::scenegraph::node *frame_node;
+            double                 frame_time;             ///< The simulation time when the frame was found.
+            gsgl::math::dvector    frame_position;         ///< In meters.
+            gsgl::math::dvector    frame_velocity;         ///< In meters per second.
+            gsgl::math::transform  frame_rotation;         ///< Rotates from the frame's axes to the root's.
+            gsgl::math::transform  frame_rotation_inverse;
+            /// @}
+
+            /// \name While coasting, the vehicle may follow a two-body orbit around its dominant body instead of being integrated.
+            /// @{
+            bool            on_rails;
+            bool            rails_left_system;  ///< Whether the vehicle left the rigid body system to go on rails.
+            bool            rails_listening;    ///< Whether the vehicle is in the list that moves vehicles into and out of the rigid body system between ticks.
+            celestial_body *rails_body;
+            kepler_orbit    rails_orbit;        ///< Relative to the rails body, in the root's axes.
+            /// @}
+
         public:
             spacecraft(const gsgl::data::config_record & obj_config);
             virtual ~spacecraft();
@@ -74,7 +99,27 @@ namespace periapsis
             virtual void calculate_force_and_torque(const double & t, gsgl::math::vector & force, gsgl::math::vector & torque);
             /// @}
 
+            /// \return The gravitational force at the position being integrated, in the parent frame's coordinates.
+            /// The frame is assumed to fall freely, so this is the difference between the field at the vehicle and at the frame's origin; a rotating frame's fictitious forces are not included.
+            gsgl::math::vector calculate_gravity(const double & t);
+
+            /// \return Whether no force except gravity acts on the vehicle, so that it may go on rails.
+            virtual bool is_coasting() const;
+
+            bool is_on_rails() const { return on_rails; }
+
             BROKER_DECLARE_CREATOR(periapsis::space::spacecraft);
+
+        private:
+            void find_frame(const double & t);
+            gsgl::math::dvector get_world_position();
+
+            void enter_rails(const gsgl::scenegraph::simulation_context *c, celestial_body *body);
+            void leave_rails();
+            void update_on_rails(const gsgl::scenegraph::simulation_context *c);
+            void apply_rails_transition();
+
+            friend class spacecraft_rails_listener;
         }; // class spacecraft
 
 
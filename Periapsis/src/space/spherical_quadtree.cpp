@@ -36,6 +36,7 @@
 
 #include "scenegraph/camera.hpp"
 #include "scenegraph/utils.hpp"
+#include "math/batch.hpp"
 #include "platform/texture.hpp"
 #include "platform/heightmap.hpp"
 
@@ -421,11 +422,8 @@ namespace periapsis
         {
             gsgl::real_t result;
 
-            vector normal_pos_in_world_space = get_vector(global_vertices, qtn->vertex_indices[12]) + get_vector(global_normals, qtn->vertex_indices[12]) * 1000.0;
-            vector normal_pos_in_eye_space   = modelview * normal_pos_in_world_space;
-            
-            vector center_pos_in_eye_space   = modelview * get_vector(global_vertices, qtn->vertex_indices[12]);            
-            vector normal_in_eye_space       = normal_pos_in_eye_space - center_pos_in_eye_space;                 
+            // the modelview is affine, so the normal can be rotated directly instead of differencing two transformed points
+            vector normal_in_eye_space = modelview.transform_direction(get_vector(global_normals, qtn->vertex_indices[12]));
             normal_in_eye_space.normalize();
 
             result = vector::Z_AXIS.dot(normal_in_eye_space);
@@ -438,22 +436,31 @@ namespace periapsis
         {
             if (qtn->last_radius_frame != sim_context->frame)
             {
-                gsgl::real_t radius   = (get_vector(global_vertices, qtn->vertex_indices[0]) - get_vector(global_vertices, qtn->vertex_indices[12])).mag();
-                gsgl::real_t distance = (parent_sg_node->get_modelview() * get_vector(global_vertices, qtn->vertex_indices[12])).mag();  if (distance < 1.0f) distance = 1.0f;
-                gsgl::real_t angle    = ::atan(radius / distance);
-
-                gsgl::real_t pct_screen_angle = static_cast<gsgl::real_t>(angle / (last_field_of_view * math::DEG2RAD));
-                gsgl::real_t pixel_radius = pct_screen_angle * last_screen_height;
-
-                qtn->radius_in_world_space = radius;
-                qtn->radius_in_screen_space = pixel_radius;
-                qtn->last_radius_frame = sim_context->frame;
+                gsgl::real_t distance = parent_sg_node->get_modelview().transform_point(get_vector(global_vertices, qtn->vertex_indices[12])).mag();
+                set_node_radius(qtn, distance, sim_context);
             }
 
             return qtn->radius_in_screen_space;
         } // spherical_quadtree::node_radius()
 
 
+        void spherical_quadtree::set_node_radius(sph_qt_node *qtn, gsgl::real_t distance, const simulation_context *sim_context)
+        {
+            if (distance < 1.0f) 
+                distance = 1.0f;
+
+            gsgl::real_t radius   = (get_vector(global_vertices, qtn->vertex_indices[0]) - get_vector(global_vertices, qtn->vertex_indices[12])).mag();
+            gsgl::real_t angle    = ::atan(radius / distance);
+
+            gsgl::real_t pct_screen_angle = static_cast<gsgl::real_t>(angle / (last_field_of_view * math::DEG2RAD));
+            gsgl::real_t pixel_radius = pct_screen_angle * last_screen_height;
+
+            qtn->radius_in_world_space = radius;
+            qtn->radius_in_screen_space = pixel_radius;
+            qtn->last_radius_frame = sim_context->frame;
+        } // spherical_quadtree::set_node_radius()
+
+
 #ifdef DEBUG_SPLITS_AND_MERGES
         static int get_ptr_num(sph_qt_node **adjacent_nodes, sph_qt_node *child)
         {
@@ -1246,16 +1253,62 @@ namespace periapsis
         static const bool allow_split = true;
         static const int NUM_TO_PROCESS = 16;
 
+
+        /// Takes up to NUM_TO_PROCESS nodes off the front of a queue.
+        static int pop_batch(simple_queue<sph_qt_node *> & q, sph_qt_node **nodes)
+        {
+            int num = 0;
+            while (num < NUM_TO_PROCESS && q.size())
+            {
+                nodes[num++] = q.front();
+                q.pop();
+            }
+            return num;
+        } // pop_batch()
+
+
+        /// Works out the screen radii of a batch of nodes at once, so that split_node() and merge_node() find them already cached.
+        void spherical_quadtree::calc_node_radii(sph_qt_node **nodes, const int num_nodes, const simulation_context *sim_context)
+        {
+            float x[NUM_TO_PROCESS], y[NUM_TO_PROCESS], z[NUM_TO_PROCESS];
+            sph_qt_node *todo[NUM_TO_PROCESS];
+            int num_todo = 0;
+
+            for (int i = 0; i < num_nodes; ++i)
+            {
+                sph_qt_node *qtn = nodes[i];
+                if (qtn->delete_me || qtn->last_radius_frame == sim_context->frame)
+                    continue;
+
+                const gsgl::index_t center = qtn->vertex_indices[12];
+                x[num_todo] = global_vertices[center*3+0];
+                y[num_todo] = global_vertices[center*3+1];
+                z[num_todo] = global_vertices[center*3+2];
+                todo[num_todo++] = qtn;
+            }
+
+            batch::transform_points(parent_sg_node->get_modelview(), num_todo, x, y, z, x, y, z);
+
+            for (int i = 0; i < num_todo; ++i)
+                set_node_radius(todo[i], ::sqrt(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]), sim_context);
+        } // spherical_quadtree::calc_node_radii()
+
+
         void spherical_quadtree::update(const simulation_context *c, const bool not_visible)
         {
             // only update if the view has changed
-            vector eye_pos = parent_sg_node->get_modelview().inverse() * vector::ZERO;
+            vector eye_pos = parent_sg_node->get_modelview().rigid_inverse().translation_part();
+
+            sph_qt_node *to_process[NUM_TO_PROCESS];
+            int num_to_process;
 
             // split nodes
-            for (int i = 0; i < NUM_TO_PROCESS && leaf_nodes.size(); ++i) 
+            num_to_process = pop_batch(leaf_nodes, to_process);
+            calc_node_radii(to_process, num_to_process, c);
+
+            for (int i = 0; i < num_to_process; ++i) 
             {
-                sph_qt_node *qtn = leaf_nodes.front();
-                leaf_nodes.pop();
+                sph_qt_node *qtn = to_process[i];
 
                 if (qtn->delete_me)
                 {
@@ -1274,10 +1327,12 @@ namespace periapsis
             }
 
             // merge nodes
-            for (int i = 0; i < NUM_TO_PROCESS && merge_nodes.size(); ++i)
+            num_to_process = pop_batch(merge_nodes, to_process);
+            calc_node_radii(to_process, num_to_process, c);
+
+            for (int i = 0; i < num_to_process; ++i)
             {
-                sph_qt_node *qtn = merge_nodes.front();
-                merge_nodes.pop();
+                sph_qt_node *qtn = to_process[i];
 
                 if (qtn->delete_me)
                 {
@@ -167,6 +167,8 @@ namespace periapsis
 
             gsgl::real_t node_cos_angle(sph_qt_node *qtn, const gsgl::math::transform & modelview);
             gsgl::real_t node_radius(sph_qt_node *qtn, const gsgl::scenegraph::simulation_context *);
+            void set_node_radius(sph_qt_node *qtn, gsgl::real_t distance, const gsgl::scenegraph::simulation_context *);
+            void calc_node_radii(sph_qt_node **nodes, const int num_nodes, const gsgl::scenegraph::simulation_context *);
             sph_qt_node *get_adjacent(sph_qt_node *candidate, const gsgl::platform::vbuffer::index_t & index0, const gsgl::platform::vbuffer::index_t & index1, 
                                       sph_qt_node ***peer_handle, gsgl::platform::vbuffer::index_t *side0 = 0, gsgl::platform::vbuffer::index_t *side1 = 0);
 
@@ -38,6 +38,7 @@
 #include "data/fstream.hpp"
 #include "platform/font.hpp"
 #include "platform/shader.hpp"
+#include "platform/mapped_file.hpp"
 
 #include "scenegraph/context.hpp"
 #include "scenegraph/camera.hpp"
@@ -48,6 +49,7 @@
 
 #include <cmath>
 #include <float.h>
+#include <cstring>
 
 
 using namespace gsgl;
@@ -105,114 +107,72 @@ namespace periapsis
 
         //
 
-        static const string STAR_DB_COOKIE = L"Periapsis Stellar Database 2.0";
+        // The binary catalog written by hygdbgen; this must match Utils/src/hygdbgen/hygdbgen.cpp.
 
-        void stellar_db::load_db(const string & fname)
+        static const char STAR_DB_COOKIE[] = "Periapsis Stellar Database 3.0";
+        static const unsigned int STAR_DB_BYTE_ORDER = 0x01020304;
+
+        struct star_db_header
         {
-            fd_stream f(fname);
+            char cookie[32];
+            unsigned int byte_order;
 
-            string cookie;
-            f >> cookie;
-            if (cookie != STAR_DB_COOKIE)
-                throw io_exception(L"Invalid stellar database format in %ls.", fname.w_string());
+            unsigned int num_stars;
+            unsigned int vertex_offset;
+            unsigned int vertex_stride;
 
-            f >> num_stars;
+            unsigned int num_names;
+            unsigned int names_offset;
+            unsigned int names_size;
 
-            // read data
-            smart_pointer<float, true> magnitudes(new float[num_stars]);
+            float nearest_distance, farthest_distance;
+        }; // struct star_db_header
 
-            float max_magnitude = 0.0f;
-            float min_magnitude = 0.0f;
 
-            for (int i = 0; i < num_stars; ++i)
-            {
-                int hyg_id;
-                f >> hyg_id;
-
-                // calculate position
-                float right_ascension, declination, distance, abs_magnitude;
-
-                f >> right_ascension;
-                f >> declination;
-                f >> distance;
-                f >> abs_magnitude;
-
-                float theta = static_cast<float>(right_ascension * (360.0f / 24.0f) * math::DEG2RAD);
-                float phi = static_cast<float>(declination * math::DEG2RAD);
-
-                float x_eq = distance * ::cos(theta) * ::cos(phi);
-                float y_eq = distance * ::sin(theta) * ::cos(phi);
-                float z_eq = distance * ::sin(phi);
-
-                vector equatorial_pos(x_eq, y_eq, z_eq);
-                vector galactic_pos = EQUATORIAL_WRT_GALACTIC * equatorial_pos;
-
-                if (distance< nearest_distance)
-                    nearest_distance = distance;
-                if (distance > farthest_distance)
-                    farthest_distance = distance;
-
-                magnitudes[i] = abs_magnitude;
-                if (abs_magnitude > max_magnitude)
-                    max_magnitude = abs_magnitude;
-                if (abs_magnitude < min_magnitude)
-                    min_magnitude = abs_magnitude;
-
-                // get color
-                unsigned char r, g, b, a;
-
-                f >> r;
-                f >> g;
-                f >> b;
-                f >> a;
-
-                // record coordinates and colors
-                float temp_color;
-                unsigned char *color_ptr = reinterpret_cast<unsigned char *>(&temp_color);
-                color_ptr[0] = r;
-                color_ptr[1] = g;
-                color_ptr[2] = b;
-                color_ptr[3] = 255;
-
-                vertices[i*4+0] = temp_color;
-                vertices[i*4+1] = galactic_pos.get_x();
-                vertices[i*4+2] = galactic_pos.get_y();
-                vertices[i*4+3] = galactic_pos.get_z();
-            }
+        /// The star vertices are stored in the exact GL_C4UB_V3F layout of the vertex buffer, so loading is a map and a copy.
+        void stellar_db::load_db(const string & fname)
+        {
+            mapped_file mf(fname);
 
-            // store absolute magnitude in alpha channel
-            float magnitude_range = max_magnitude - min_magnitude;
-            for (int i = 0; i < num_stars; ++i)
-            {
-                float mag_diff = math::clamp(magnitudes[i] - min_magnitude, 0.0f, 5.0f);
-                float mag_pct = 1.0f - (mag_diff / 5.0f);
+            const star_db_header & header = mf.get_view<const star_db_header>(0, 1)[0];
 
-                unsigned char *color_ptr = reinterpret_cast<unsigned char *>(&vertices[i*4+0]);
-                color_ptr[3] = static_cast<unsigned char>(mag_pct * 255.0f);
+            if (::strncmp(header.cookie, STAR_DB_COOKIE, sizeof(header.cookie)) != 0)
+                throw io_exception(L"Invalid stellar database format in %ls (you may need to regenerate it with hygdbgen).", fname.w_string());
+            if (header.byte_order != STAR_DB_BYTE_ORDER)
+                throw io_exception(L"The stellar database %ls was generated on a machine with a different byte order.", fname.w_string());
+            if (header.vertex_stride != 4 * sizeof(vbuffer::real_t))
+                throw io_exception(L"Invalid vertex size in stellar database %ls.", fname.w_string());
 
-                //float r = color_scale * static_cast<float>(color_ptr[0]);
-                //float g = color_scale * static_cast<float>(color_ptr[1]);
-                //float b = color_scale * static_cast<float>(color_ptr[2]);
+            num_stars = header.num_stars;
+            nearest_distance = header.nearest_distance;
+            farthest_distance = header.farthest_distance;
 
-                //color_ptr[0] = static_cast<unsigned char>(r);
-                //color_ptr[1] = static_cast<unsigned char>(g);
-                //color_ptr[2] = static_cast<unsigned char>(b);
-            }
+            // copy vertices
+            mf.advise(mapped_file::ACCESS_SEQUENTIAL, header.vertex_offset, header.num_stars * header.vertex_stride);
+
+            mapped_view<const vbuffer::real_t> star_vertices = mf.get_view<const vbuffer::real_t>(header.vertex_offset, num_stars * 4);
+            vertices.assign(star_vertices.ptr(), star_vertices.size());
 
             // get names
-            int num_star_names;
-            f >> num_star_names;
+            mapped_view<const unsigned char> names = mf.get_view<const unsigned char>(header.names_offset, header.names_size);
+            gsgl::index_t pos = 0;
 
-            for (int i = 0; i < num_star_names; ++i)
+            for (unsigned int i = 0; i < header.num_names; ++i)
             {
-                int star_id;
-                f >> star_id;
+                mapped_view<const unsigned int> name_header = mf.get_view<const unsigned int>(header.names_offset + pos, 2);
+                unsigned int star_index = name_header[0];
+                unsigned int name_len = name_header[1];
+                gsgl::index_t padded_len = (name_len + 1 + 3) & ~3u;
 
-                string star_name;
-                f >> star_name;
+                mapped_view<const unsigned char> name_chars = names.subview(pos + 2 * sizeof(unsigned int), padded_len);
 
-                vector pos(vertices[(star_id-1)*4+1], vertices[(star_id-1)*4+2], vertices[(star_id-1)*4+3]);                
-                add_star_name(pos, star_name);
+                if (star_index >= header.num_stars || name_chars[name_len] != 0)
+                    throw io_exception(L"Invalid star name record in %ls.", fname.w_string());
+
+                vector star_pos(star_vertices[star_index*4+1], star_vertices[star_index*4+2], star_vertices[star_index*4+3]);
+                add_star_name(star_pos, string(reinterpret_cast<const char *>(name_chars.ptr())));
+
+                pos += 2 * sizeof(unsigned int) + padded_len;
             }
 
             // some signposts
@@ -231,9 +191,9 @@ namespace periapsis
 
         void stellar_db::add_star_name(const vector & pos, const string & name)
         {
-            star_name_vertices.append(pos.get_x());
-            star_name_vertices.append(pos.get_y());
-            star_name_vertices.append(pos.get_z());
+            star_name_x.append(pos.get_x());
+            star_name_y.append(pos.get_y());
+            star_name_z.append(pos.get_z());
             star_names.append(new string(name));
         } // stellar_db::add_star_name()
 
@@ -292,15 +252,14 @@ namespace periapsis
 
                 if (label_font)
                 {
+                    // the labels pick up the star scale from the modelview, so the positions can be projected as they are
+                    display::scoped_modelview mv(*draw_context->screen);
+                    mv.scale(star_scale, star_scale, star_scale);
+
                     display::scoped_state state(*draw_context->screen, display::ENABLE_ORTHO_2D);
                     display::scoped_text labels(*draw_context->screen);
 
-                    int i, len = star_names.size();
-                    for (i = 0; i < len; ++i)
-                    {
-                        vector pos(star_name_vertices[i*3+0]*star_scale, star_name_vertices[i*3+1]*star_scale, star_name_vertices[i*3+2]*star_scale);
-                        labels.draw_3d(pos, label_font, *star_names[i], 4, -8);
-                    }
+                    labels.draw_3d(star_names.size(), star_name_x.ptr(), star_name_y.ptr(), star_name_z.ptr(), label_font, star_names.ptr(), 4, -8);
                 }
             }
         } // stellar_db::draw()
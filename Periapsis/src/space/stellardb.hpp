@@ -59,7 +59,7 @@ namespace periapsis
             gsgl::platform::shader_program star_shader;
             gsgl::platform::shader_uniform<float> *uniform_farthest_distance;
 
-            gsgl::data::simple_array<gsgl::real_t> star_name_vertices;
+            gsgl::data::simple_array<gsgl::real_t> star_name_x, star_name_y, star_name_z; ///< Label positions, kept apart so they can be projected as a batch.
             gsgl::data::simple_array<gsgl::string *> star_names;
 
         public:
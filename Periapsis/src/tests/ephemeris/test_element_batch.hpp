@@ -0,0 +1,122 @@
+#ifndef PERIAPSIS_TEST_EPHEMERIS_ELEMENT_BATCH_H
+#define PERIAPSIS_TEST_EPHEMERIS_ELEMENT_BATCH_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/keplerian_element_batch.hpp"
+#include "data/config.hpp"
+#include "data/pointer.hpp"
+
+#include "unit_tester.hpp"
+
+#include <cmath>
+
+namespace test
+{
+
+    namespace ephemeris
+    {
+
+        class keplerian_batch
+        {
+        public:
+
+            /// The batch should put each orbit where its own propagator does, from circular orbits to nearly parabolic ones.
+            void test_matches_propagator()
+            {
+                using namespace gsgl;
+                using namespace gsgl::data;
+                using namespace gsgl::math;
+                using namespace periapsis::space;
+
+                const int NUM_ORBITS = 6;
+                const wchar_t *elements[NUM_ORBITS] = 
+                {
+                    L"1.5 0.0 7.0 100.0 100.01 48.0",
+                    L"1.5 0.000000001 7.0 100.0 100.01 48.0",
+                    L"5.2 0.048 1.3 34.4 14.7 100.5",
+                    L"1.5 0.5 7.0 100.0 100.01 48.0",
+                    L"1.5 0.999 7.0 100.0 100.01 48.0",
+                    L"1.5 0.99999 7.0 100.0 100.01 48.0"
+                };
+                const wchar_t *rates = L"0.0 0.0 -0.01 36000.0 0.3 -0.2";
+
+                config_record configs[NUM_ORBITS];
+                shared_pointer<keplerian_element_propagator> props[NUM_ORBITS];
+                keplerian_element_batch batch;
+
+                for (int i = 0; i < NUM_ORBITS; ++i)
+                {
+                    configs[i][L"keplerian_elements"] = elements[i];
+                    configs[i][L"keplerian_rates"] = rates;
+                    if (i == 2)
+                        configs[i][L"keplerian_elements_aux"] = L"-0.00012452 0.06064060 -0.35635438 38.35125000";
+
+                    props[i] = new keplerian_element_propagator(configs[i]);
+                    TEST_ASSERT(batch.add(props[i].ptr()) == i);
+                }
+
+                // not J2000 itself, where the propagator's mean motion is 0/0; the times near it are near the perihelia
+                const int NUM_TIMES = 5;
+                const double jdns[NUM_TIMES] = { 2451545.001, 2451545.5, 2455000.5, 2440000.5, 2462502.5 };
+
+                double x[NUM_ORBITS], y[NUM_ORBITS], z[NUM_ORBITS], vx[NUM_ORBITS], vy[NUM_ORBITS], vz[NUM_ORBITS];
+
+                for (int t = 0; t < NUM_TIMES; ++t)
+                {
+                    batch.evaluate(jdns[t], 0, batch.size(), x, y, z, vx, vy, vz);
+
+                    for (int i = 0; i < NUM_ORBITS; ++i)
+                    {
+                        dvector position;
+                        vector velocity;
+                        props[i]->update(jdns[t], position, velocity);
+
+                        double a = props[i]->get_elements()[0];
+                        TEST_ASSERT((dvector(x[i], y[i], z[i]) - position).mag() < 1e-12 * a);
+
+                        // the propagator's velocity is single precision
+                        dvector v(vx[i], vy[i], vz[i]);
+                        TEST_ASSERT((v - dvector(velocity)).mag() < 1e-6 * v.mag());
+                    }
+                }
+            } // test_matches_propagator()
+
+        }; // class keplerian_batch
+
+    } // namespace ephemeris
+
+} // namespace test
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef PERIAPSIS_TEST_EPHEMERIS_TABLE_H
+#define PERIAPSIS_TEST_EPHEMERIS_TABLE_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/ephemeris_table.hpp"
+#include "data/fstream.hpp"
+
+#include "unit_tester.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace test
+{
+
+    namespace ephemeris
+    {
+
+        /// Fits a table to cubics, which the Chebyshev series should reproduce to rounding, and writes it as ephemgen does.
+        class chebyshev_table
+        {
+            enum { NUM_COEFFICIENTS = 6, NUM_SEGMENTS = 3 };
+
+            static const double START_JDN;
+            static const double SEGMENT_DAYS;
+            static const double CUBICS[periapsis::space::ephemeris_table::NUM_COMPONENTS][4];
+
+            gsgl::string fname;
+
+        public:
+            chebyshev_table()
+                : fname(L"test_ephemeris.eph")
+            {
+                using namespace periapsis::space;
+
+                ephemeris_file_header header;
+                ::memset(&header, 0, sizeof(header));
+                ::strncpy(header.cookie, ephemeris_table::COOKIE, sizeof(header.cookie));
+                header.byte_order = ephemeris_table::FILE_BYTE_ORDER;
+                header.num_series = 1;
+                header.series_offset = sizeof(header);
+                header.start_jdn = START_JDN;
+                header.end_jdn = START_JDN + NUM_SEGMENTS * SEGMENT_DAYS;
+
+                ephemeris_series_record rec;
+                ::memset(&rec, 0, sizeof(rec));
+                ::strncpy(rec.name, "Test", sizeof(rec.name) - 1);
+                rec.kind = ephemeris_table::POSITION;
+                rec.num_components = ephemeris_table::NUM_COMPONENTS;
+                rec.num_coefficients = NUM_COEFFICIENTS;
+                rec.num_segments = NUM_SEGMENTS;
+                rec.data_offset = (sizeof(header) + sizeof(rec) + 7) & ~7u;
+                rec.start_jdn = START_JDN;
+                rec.segment_days = SEGMENT_DAYS;
+
+                double coefficients[NUM_SEGMENTS][ephemeris_table::NUM_COMPONENTS][NUM_COEFFICIENTS];
+
+                for (int segment = 0; segment < NUM_SEGMENTS; ++segment)
+                {
+                    for (int c = 0; c < ephemeris_table::NUM_COMPONENTS; ++c)
+                    {
+                        double samples[NUM_COEFFICIENTS];
+
+                        for (int k = 0; k < NUM_COEFFICIENTS; ++k)
+                        {
+                            double x = ephemeris_table::chebyshev_node(k, NUM_COEFFICIENTS);
+                            samples[k] = cubic(c, (segment + 0.5 * (x + 1.0)) * SEGMENT_DAYS);
+                        }
+
+                        ephemeris_table::chebyshev_fit(NUM_COEFFICIENTS, samples, coefficients[segment][c]);
+                    }
+                }
+
+                static const unsigned char zeros[8] = { 0 };
+
+                gsgl::io::fd_stream f(fname, gsgl::io::FILE_OPEN_WRITE);
+                f.write(reinterpret_cast<const unsigned char *>(&header), sizeof(header));
+                f.write(reinterpret_cast<const unsigned char *>(&rec), sizeof(rec));
+                f.write(zeros, rec.data_offset - sizeof(header) - sizeof(rec));
+                f.write(reinterpret_cast<const unsigned char *>(coefficients), sizeof(coefficients));
+            } // chebyshev_table()
+
+
+            void test_values_and_rates()
+            {
+                using namespace periapsis::space;
+
+                ephemeris_table table(fname);
+
+                gsgl::index_t series_index = table.find_series(L"Test", ephemeris_table::POSITION);
+                TEST_ASSERT(series_index == 0);
+                TEST_ASSERT(table.find_series(L"Test", ephemeris_table::ORIENTATION) == -1);
+
+                // inside the first and second segments, on the boundary between them, and at the very end of the table
+                const int NUM_DAYS = 5;
+                const double days[NUM_DAYS] = { 0.0, 1.3, SEGMENT_DAYS, SEGMENT_DAYS + 2.75, NUM_SEGMENTS * SEGMENT_DAYS };
+
+                for (int i = 0; i < NUM_DAYS; ++i)
+                {
+                    double values[ephemeris_table::NUM_COMPONENTS], rates[ephemeris_table::NUM_COMPONENTS];
+                    TEST_ASSERT(table.evaluate(series_index, START_JDN + days[i], values, rates));
+
+                    // a Julian day near J2000 is only good to about 5e-10 days, so the values are only good to about that times the rates
+                    for (int c = 0; c < ephemeris_table::NUM_COMPONENTS; ++c)
+                    {
+                        TEST_ASSERT(::fabs(values[c] - cubic(c, days[i])) < 1e-8);
+                        TEST_ASSERT(::fabs(rates[c] - cubic_rate(c, days[i])) < 1e-10);
+                    }
+                }
+            } // test_values_and_rates()
+
+
+            void test_out_of_range()
+            {
+                using namespace periapsis::space;
+
+                ephemeris_table table(fname);
+                double values[ephemeris_table::NUM_COMPONENTS], rates[ephemeris_table::NUM_COMPONENTS];
+
+                TEST_ASSERT(!table.evaluate(0, START_JDN - 0.01, values, rates));
+                TEST_ASSERT(!table.evaluate(0, START_JDN + NUM_SEGMENTS * SEGMENT_DAYS + 0.01, values, rates));
+                TEST_ASSERT(!table.evaluate(0, START_JDN + (NUM_SEGMENTS + 1) * SEGMENT_DAYS, values, rates));
+            } // test_out_of_range()
+
+        private:
+            static double cubic(const int c, const double t)
+            {
+                return CUBICS[c][0] + t*(CUBICS[c][1] + t*(CUBICS[c][2] + t*CUBICS[c][3]));
+            } // cubic()
+
+            static double cubic_rate(const int c, const double t)
+            {
+                return CUBICS[c][1] + t*(2.0*CUBICS[c][2] + t*3.0*CUBICS[c][3]);
+            } // cubic_rate()
+
+        }; // class chebyshev_table
+
+
+        const double chebyshev_table::START_JDN = 2451545.0;
+        const double chebyshev_table::SEGMENT_DAYS = 4.0;
+
+        const double chebyshev_table::CUBICS[periapsis::space::ephemeris_table::NUM_COMPONENTS][4] = 
+        {
+            {  1.5, -0.25,  0.01,  0.002  },
+            { -3.0,  0.5,  -0.02,  0.0005 },
+            {  0.0,  1.0,   0.0,  -0.001  }
+        };
+
+    } // namespace ephemeris
+
+} // namespace test
+
+#endif
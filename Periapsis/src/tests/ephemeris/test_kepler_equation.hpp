@@ -0,0 +1,135 @@
+#ifndef PERIAPSIS_TEST_EPHEMERIS_KEPLER_EQUATION_H
+#define PERIAPSIS_TEST_EPHEMERIS_KEPLER_EQUATION_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/kepler_equation.hpp"
+#include "math/math.hpp"
+
+#include "unit_tester.hpp"
+
+#include <cmath>
+
+namespace test
+{
+
+    namespace ephemeris
+    {
+
+        class kepler_solver
+        {
+        public:
+
+            void test_elliptic_residuals()
+            {
+                using namespace periapsis::space;
+
+                const int NUM_ECCENTRICITIES = 8;
+                const double es[NUM_ECCENTRICITIES] = { 0.0, 1e-9, 0.0167, 0.5, 0.9, 0.999, 0.999999, 0.9999999999 };
+                const int NUM_STEPS = 2000;
+
+                for (int j = 0; j < NUM_ECCENTRICITIES; ++j)
+                {
+                    for (int i = 0; i <= NUM_STEPS; ++i)
+                    {
+                        double M = -gsgl::math::PI + gsgl::math::PI_TIMES_2 * i / NUM_STEPS;
+                        double E = kepler_equation::solve_elliptic(M, es[j]);
+
+                        TEST_ASSERT(::fabs(E - es[j]*::sin(E) - M) < 1e-12);
+                    }
+
+                    // close to the periapsis, where the nearly parabolic orbits are hardest
+                    for (double M = 1e-12; M < 1.0; M *= 10.0)
+                    {
+                        double E = kepler_equation::solve_elliptic(M, es[j]);
+                        TEST_ASSERT(::fabs(E - es[j]*::sin(E) - M) < 1e-15);
+                    }
+                }
+
+                // other revolutions
+                double E = kepler_equation::solve_elliptic(100.3, 0.3);
+                TEST_ASSERT(::fabs(E - 0.3*::sin(E) - 100.3) < 1e-12);
+                TEST_ASSERT(::fabs(E - 100.3) < gsgl::math::PI);
+            } // test_elliptic_residuals()
+
+
+            void test_hyperbolic_residuals()
+            {
+                using namespace periapsis::space;
+
+                const int NUM_ECCENTRICITIES = 5;
+                const double es[NUM_ECCENTRICITIES] = { 1.000001, 1.01, 1.5, 3.0, 10.0 };
+                const int NUM_STEPS = 2000;
+
+                for (int j = 0; j < NUM_ECCENTRICITIES; ++j)
+                {
+                    for (int i = 0; i <= NUM_STEPS; ++i)
+                    {
+                        double M = -50.0 + 100.0 * i / NUM_STEPS;
+                        double H = kepler_equation::solve_hyperbolic(M, es[j]);
+
+                        TEST_ASSERT(::fabs(es[j]*::sinh(H) - H - M) < 1e-12 * (::fabs(M) > 1.0 ? ::fabs(M) : 1.0));
+                    }
+                }
+            } // test_hyperbolic_residuals()
+
+
+            /// The array solvers should give what the single ones do, give or take the rounding of a fast floating point model.
+            void test_arrays()
+            {
+                using namespace periapsis::space;
+
+                const int COUNT = 6;
+                const double M[COUNT] = { -3.0, -0.5, 0.0, 1e-6, 2.5, 40.0 };
+                const double e[COUNT] = { 0.1, 0.999, 0.5, 0.999999, 0.0, 0.7 };
+                const double eh[COUNT] = { 1.1, 1.000001, 2.0, 1.5, 5.0, 1.2 };
+
+                double E[COUNT], H[COUNT];
+                kepler_equation::solve_elliptic(COUNT, M, e, E);
+                kepler_equation::solve_hyperbolic(COUNT, M, eh, H);
+
+                for (int i = 0; i < COUNT; ++i)
+                {
+                    TEST_ASSERT(::fabs(E[i] - kepler_equation::solve_elliptic(M[i], e[i])) < 1e-13);
+                    TEST_ASSERT(::fabs(H[i] - kepler_equation::solve_hyperbolic(M[i], eh[i])) < 1e-13);
+                }
+            } // test_arrays()
+
+        }; // class kepler_solver
+
+    } // namespace ephemeris
+
+} // namespace test
+
+#endif
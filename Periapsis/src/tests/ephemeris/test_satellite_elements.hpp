@@ -0,0 +1,199 @@
+#ifndef PERIAPSIS_TEST_EPHEMERIS_SATELLITE_ELEMENTS_H
+#define PERIAPSIS_TEST_EPHEMERIS_SATELLITE_ELEMENTS_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/satellite_element_propagator.hpp"
+#include "space/satellite_element_batch.hpp"
+#include "data/config.hpp"
+#include "data/pointer.hpp"
+#include "math/units.hpp"
+
+#include "unit_tester.hpp"
+
+#include <cmath>
+
+namespace test
+{
+
+    namespace ephemeris
+    {
+
+        /// Checks the cached terms of satellite_element_propagator, and the batch built from them, against the full rotation by w, I and the node that the propagator used to do on every update.
+        class satellite_elements
+        {
+            enum { NUM_ORBITS = 3, NUM_ELEMENTS = 10, NUM_TIMES = 4 };
+
+            static const double ELEMENTS[NUM_ORBITS][NUM_ELEMENTS];
+            static const wchar_t * const ELEMENT_STRINGS[NUM_ORBITS];
+            static const double JDNS[NUM_TIMES];
+
+            gsgl::data::config_record configs[NUM_ORBITS];
+            gsgl::data::shared_pointer<periapsis::space::satellite_element_propagator> props[NUM_ORBITS];
+
+        public:
+            satellite_elements()
+            {
+                for (int i = 0; i < NUM_ORBITS; ++i)
+                {
+                    configs[i][L"satellite_elements"] = ELEMENT_STRINGS[i];
+                    props[i] = new periapsis::space::satellite_element_propagator(configs[i]);
+                }
+            } // satellite_elements()
+
+
+            void test_propagator()
+            {
+                using namespace gsgl::math;
+
+                for (int i = 0; i < NUM_ORBITS; ++i)
+                {
+                    TEST_ASSERT(props[i]->has_elements());
+
+                    for (int t = 0; t < NUM_TIMES; ++t)
+                    {
+                        dvector position, expected_position, expected_velocity;
+                        vector velocity;
+
+                        props[i]->update(JDNS[t], position, velocity);
+                        reference(ELEMENTS[i], JDNS[t], expected_position, expected_velocity);
+
+                        TEST_ASSERT((position - expected_position).mag() < 1e-9 * expected_position.mag());
+
+                        // the velocity is single precision, and at J2000 it used to be 0/0
+                        dvector v(velocity);
+                        TEST_ASSERT(v.mag() == v.mag());
+                        TEST_ASSERT((v - expected_velocity).mag() < 1e-6 * expected_velocity.mag());
+                    }
+                }
+            } // test_propagator()
+
+
+            void test_batch()
+            {
+                using namespace gsgl::math;
+                using namespace periapsis::space;
+
+                satellite_element_batch batch;
+
+                for (int i = 0; i < NUM_ORBITS; ++i)
+                    TEST_ASSERT(batch.add(props[i].ptr()) == i);
+
+                double x[NUM_ORBITS], y[NUM_ORBITS], z[NUM_ORBITS], vx[NUM_ORBITS], vy[NUM_ORBITS], vz[NUM_ORBITS];
+
+                for (int t = 0; t < NUM_TIMES; ++t)
+                {
+                    batch.evaluate(JDNS[t], 0, batch.size(), x, y, z, vx, vy, vz);
+
+                    for (int i = 0; i < NUM_ORBITS; ++i)
+                    {
+                        dvector expected_position, expected_velocity;
+                        reference(ELEMENTS[i], JDNS[t], expected_position, expected_velocity);
+
+                        TEST_ASSERT((dvector(x[i], y[i], z[i]) - expected_position).mag() < 1e-9 * expected_position.mag());
+                        TEST_ASSERT((dvector(vx[i], vy[i], vz[i]) - expected_velocity).mag() < 1e-9 * expected_velocity.mag());
+                    }
+                }
+            } // test_batch()
+
+        private:
+            /// The position (m) and velocity (m/s) from the elements, turned by the argument of periapsis, the inclination and the current node all at once.
+            /// Kepler's equation is solved here by plain Newton's method, which converges from E = pi for any elliptic orbit.
+            static void reference(const double *elements, const double jdn, gsgl::math::dvector & position, gsgl::math::dvector & velocity)
+            {
+                using namespace gsgl::math;
+
+                const double a = elements[0], e = elements[1];
+                const double w = elements[2] * DEG2RAD, M = elements[3] * DEG2RAD, I = elements[4] * DEG2RAD;
+                const double n = elements[6] * DEG2RAD;
+                const double O = elements[5] * DEG2RAD + n * (jdn - 2451545.0);
+
+                double E = PI;
+                for (int i = 0; i < 100; ++i)
+                {
+                    double delta = (E - e*::sin(E) - M) / (1.0 - e*::cos(E));
+                    E -= delta;
+
+                    if (::fabs(delta) < 1e-15)
+                        break;
+                }
+
+                const double E_dot = n / (1.0 - e*::cos(E));
+                const double root = ::sqrt(1.0 - e*e);
+
+                const double x_prime = a * (::cos(E) - e);
+                const double y_prime = a * root * ::sin(E);
+                const double x_dot_prime = -a * ::sin(E) * E_dot;
+                const double y_dot_prime = a * root * ::cos(E) * E_dot;
+
+                const double cos_w = ::cos(w), sin_w = ::sin(w);
+                const double cos_O = ::cos(O), sin_O = ::sin(O);
+                const double cos_I = ::cos(I), sin_I = ::sin(I);
+
+                const double r11 = cos_w*cos_O - sin_w*sin_O*cos_I, r12 = -sin_w*cos_O - cos_w*sin_O*cos_I;
+                const double r21 = cos_w*sin_O + sin_w*cos_O*cos_I, r22 = -sin_w*sin_O + cos_w*cos_O*cos_I;
+                const double r31 = sin_w*sin_I,                     r32 = cos_w*sin_I;
+
+                const double to_meters = units::METERS_PER_KILOMETER;
+                const double to_meters_per_second = units::METERS_PER_KILOMETER / units::SECONDS_PER_DAY;
+
+                position = dvector(r11*x_prime + r12*y_prime, r21*x_prime + r22*y_prime, r31*x_prime + r32*y_prime) * to_meters;
+                velocity = dvector(r11*x_dot_prime + r12*y_dot_prime, r21*x_dot_prime + r22*y_dot_prime, r31*x_dot_prime + r32*y_dot_prime) * to_meters_per_second;
+            } // reference()
+
+        }; // class satellite_elements
+
+
+        // the Moon, a circular orbit, and a nearly parabolic one that starts near its periapsis
+        const double satellite_elements::ELEMENTS[NUM_ORBITS][NUM_ELEMENTS] = 
+        {
+            { 384400.0, 0.0554, 318.15, 135.27, 5.16, 125.08, 13.176358, 27.322, 5.997, 18.600 },
+            { 9376.0, 0.0, 150.06, 91.0, 1.08, 164.9, 1128.8444155, 0.3189, 1.131, 1.131 },
+            { 1000000.0, 0.999, 10.0, 0.01, 30.0, 80.0, 0.5, 720.0, 10.0, 20.0 }
+        };
+
+        const wchar_t * const satellite_elements::ELEMENT_STRINGS[NUM_ORBITS] = 
+        {
+            L"384400.0 0.0554 318.15 135.27 5.16 125.08 13.176358 27.322 5.997 18.600",
+            L"9376.0 0.0 150.06 91.0 1.08 164.9 1128.8444155 0.3189 1.131 1.131",
+            L"1000000.0 0.999 10.0 0.01 30.0 80.0 0.5 720.0 10.0 20.0"
+        };
+
+        const double satellite_elements::JDNS[NUM_TIMES] = { 2451545.0, 2451545.5, 2455000.5, 2440000.5 };
+
+    } // namespace ephemeris
+
+} // namespace test
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef PERIAPSIS_TEST_EPHEMERIS_SCENERY_H
+#define PERIAPSIS_TEST_EPHEMERIS_SCENERY_H
+
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "space/scenery_ephemeris.hpp"
+#include "space/keplerian_element_propagator.hpp"
+#include "space/satellite_element_propagator.hpp"
+#include "data/config.hpp"
+#include "data/fstream.hpp"
+#include "math/units.hpp"
+
+#include "unit_tester.hpp"
+
+namespace test
+{
+
+    namespace ephemeris
+    {
+
+        class scenery
+        {
+        public:
+
+            /// The Moon is two frames down, so its position is the sum of its own orbit and its barysystem's orbit (in AU).
+            void test_nested_positions()
+            {
+                using namespace gsgl;
+                using namespace gsgl::data;
+                using namespace gsgl::math;
+                using namespace periapsis::space;
+
+                const wchar_t *BARY_ELEMENTS = L"1.00000018 0.01673163 -0.00054346 100.46691572 102.93005885 -5.11260389";
+                const wchar_t *BARY_RATES = L"-0.00000003 -0.00003661 -0.01337178 35999.37306329 0.31795260 -0.24123856";
+                const wchar_t *MOON_ELEMENTS = L"384400.0 0.0554 318.15 135.27 5.16 125.08 13.176358 27.322 5.997 18.600";
+
+                gsgl::string fname(L"test_ephemeris.scn");
+
+                {
+                    io::ft_stream f(fname, io::FILE_OPEN_WRITE);
+                    f << L"<scenery name=\"Test\">\n"
+                      << L"  <description>Test scenery.</description>\n"
+                      << L"  <periapsis::space::solar_system name=\"Sol System\" scale=\"1AU\">\n"
+                      << L"    <periapsis::space::star name=\"Sol\"/>\n"
+                      << L"    <periapsis::space::planet_system name=\"Earth Barysystem\" propagator=\"periapsis::space::keplerian_element_propagator\"\n"
+                      << L"        keplerian_elements=\"" << BARY_ELEMENTS << L"\" keplerian_rates=\"" << BARY_RATES << L"\">\n"
+                      << L"      <periapsis::space::large_rocky_body name=\"Moon\" propagator=\"periapsis::space::satellite_element_propagator\"\n"
+                      << L"          satellite_elements=\"" << MOON_ELEMENTS << L"\"/>\n"
+                      << L"    </periapsis::space::planet_system>\n"
+                      << L"  </periapsis::space::solar_system>\n"
+                      << L"</scenery>\n";
+                }
+
+                scenery_ephemeris eph(fname);
+
+                gsgl::index_t moon = eph.find_body(L"Moon");
+                TEST_ASSERT(moon != -1);
+
+                config_record bary_config, moon_config;
+                bary_config[L"keplerian_elements"] = BARY_ELEMENTS;
+                bary_config[L"keplerian_rates"] = BARY_RATES;
+                moon_config[L"satellite_elements"] = MOON_ELEMENTS;
+
+                keplerian_element_propagator bary_prop(bary_config);
+                satellite_element_propagator moon_prop(moon_config);
+
+                const int NUM_TIMES = 4;
+                const double jdns[NUM_TIMES] = { 2451545.0, 2451545.0 + 7.3, 2455000.25, 2440000.5 };
+                dvector positions[NUM_TIMES];
+
+                eph.set_num_threads(2);
+                eph.get_positions(1, &moon, NUM_TIMES, jdns, positions);
+
+                for (int i = 0; i < NUM_TIMES; ++i)
+                {
+                    dvector bary_pos, moon_pos;
+                    vector velocity;
+
+                    bary_prop.update(jdns[i], bary_pos, velocity);
+                    moon_prop.update(jdns[i], moon_pos, velocity);
+
+                    dvector expected = bary_pos * units::parse(L"1AU") + moon_pos;
+
+                    // a meter, out of an AU
+                    TEST_ASSERT((positions[i] - expected).mag() < 1.0);
+                }
+            } // test_nested_positions()
+
+        }; // class scenery
+
+    } // namespace ephemeris
+
+} // namespace test
+
+#endif
@@ -0,0 +1,188 @@
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "data/string.hpp"
+#include "data/fstream.hpp"
+#include "data/array.hpp"
+#include "data/config.hpp"
+#include "physics/rigid_body.hpp"
+#include "physics/rigid_body_system.hpp"
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+using namespace gsgl;
+using namespace gsgl::io;
+using namespace gsgl::math;
+using namespace gsgl::physics;
+
+// Compares integrating rigid bodies one at a time with integrating them together in a rigid_body_system, using the same integrator for both.
+
+static double get_seconds()
+{
+#ifdef WIN32
+    LARGE_INTEGER count, freq;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    return static_cast<double>(count.QuadPart) / static_cast<double>(freq.QuadPart);
+#else
+    struct timeval tv;
+    ::gettimeofday(&tv, 0);
+    return tv.tv_sec + tv.tv_usec * 1.0e-6;
+#endif
+} // get_seconds()
+
+//
+
+/// A box under a constant thrust and torque.
+class bench_body
+    : public rigid_body
+{
+public:
+    bench_body(const string & name)
+        : rigid_body(name, 0)
+    {
+        get_linear_velocity() = vector(1, 0, 0);
+        get_angular_velocity() = vector(0, 0.1f, 0);
+    }
+
+    virtual transform calculate_inertia_tensor(vector & center_of_mass)
+    {
+        center_of_mass = vector::ZERO;
+        get_total_mass() = 1000;
+
+        transform j = transform::IDENTITY;
+        j.item(0, 0) = 1000;
+        j.item(1, 1) = 2000;
+        j.item(2, 2) = 3000;
+        return j;
+    }
+
+    virtual void calculate_force_and_torque(const double & t, vector & force, vector & torque)
+    {
+        force = vector(0, 0, 100);
+        torque = vector(1, 0, 0);
+    }
+}; // class bench_body
+
+//
+
+static const int NUM_SIZES = 3;
+static const gsgl::index_t SIZES[NUM_SIZES] = { 1, 100, 10000 };
+
+static const gsgl::index_t BODY_STEPS = 1000000; ///< The number of body-steps to time at each size.
+static const double STEP = 1.0 / 60.0;
+
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        ft_stream::out << "Usage: bodybench\n";
+        return 1;
+    }
+
+    try
+    {
+        // the system always uses sub-stepped RK4, so give the separate bodies the same solver and step for a fair comparison
+        {
+            const string system_max_step = data::global_config::get_config().get_child(L"physics/rigid_body_system/max_step").get_text();
+
+            data::config_record solver_config;
+            solver_config.get_child(L"physics/rigid_body/solver").get_text() = L"rk4";
+            solver_config.get_child(L"physics/rigid_body/max_step").get_text() = system_max_step;
+            data::global_config::override_with(solver_config);
+        }
+
+        scenegraph::simulation_context c;
+        c.cur_time = 0;
+        c.delta_time = STEP;
+
+        ft_stream::out << "bodies\tseparate (bodies/ms)\tsystem (bodies/ms)\n";
+
+        for (int s = 0; s < NUM_SIZES; ++s)
+        {
+            gsgl::index_t num_bodies = SIZES[s];
+            gsgl::index_t num_steps = BODY_STEPS / num_bodies;
+
+            data::simple_array<bench_body *> bodies;
+            for (gsgl::index_t i = 0; i < num_bodies; ++i)
+            {
+                bench_body *b = new bench_body(string::format(L"body %d", i));
+                b->init(&c);
+                bodies.append(b);
+            }
+
+            // each body with its own solver
+            double start = get_seconds();
+            for (gsgl::index_t step = 0; step < num_steps; ++step)
+            {
+                c.cur_time = step * STEP;
+
+                for (gsgl::index_t i = 0; i < num_bodies; ++i)
+                    bodies[i]->update(&c);
+            }
+            double separate = get_seconds() - start;
+
+            // all the bodies at once
+            double system_time;
+            {
+                rigid_body_system system;
+                for (gsgl::index_t i = 0; i < num_bodies; ++i)
+                    system.add(bodies[i]);
+
+                start = get_seconds();
+                for (gsgl::index_t step = 0; step < num_steps; ++step)
+                    system.step(step * STEP, STEP);
+                system_time = get_seconds() - start;
+            }
+
+            double total = static_cast<double>(num_bodies) * num_steps;
+            ft_stream::out << num_bodies << "\t" << total / (separate * 1000.0) << "\t" << total / (system_time * 1000.0) << "\n";
+
+            for (gsgl::index_t i = 0; i < num_bodies; ++i)
+                delete bodies[i];
+        }
+    }
+    catch (exception & e)
+    {
+        ft_stream::out << "Error: " << e.get_message() << "\n";
+        return 1;
+    }
+
+    return 0;
+} // main()
@@ -0,0 +1,362 @@
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "data/string.hpp"
+#include "data/fstream.hpp"
+#include "data/array.hpp"
+#include "data/list.hpp"
+#include "data/config.hpp"
+#include "data/broker.hpp"
+#include "space/ephemeris_table.hpp"
+
+#include <cmath>
+#include <cstring>
+
+using namespace gsgl;
+using namespace gsgl::data;
+using namespace gsgl::io;
+using namespace gsgl::math;
+using namespace periapsis::space;
+
+// Fits Chebyshev polynomials to the propagators and rotators in a scenery file, and writes them out as an ephemeris table.
+// The layout is described in Periapsis/src/space/ephemeris_table.hpp.
+
+static const double PI = 3.14159265358979323846;
+
+static const double DEFAULT_POSITION_DAYS = 8.0;
+static const double DEFAULT_ORIENTATION_DAYS = 1.0;
+
+static const unsigned int POSITION_COEFFICIENTS = 14;
+static const unsigned int ORIENTATION_COEFFICIENTS = 10;
+
+static const int NUM_COMPONENTS = ephemeris_table::NUM_COMPONENTS;
+
+//
+
+/// A series to fit: either a propagator or a rotator, taken from the scenery.
+struct fit_source
+{
+    string name;
+    ephemeris_table::series_kind kind;
+
+    propagator *prop;
+    body_rotator *rotator;
+
+    double segment_days;
+    unsigned int num_coefficients;
+    unsigned int num_segments;
+    simple_array<double> coefficients;
+
+    bool operator== (const fit_source & fs) const { return name == fs.name && kind == fs.kind; }
+}; // struct fit_source
+
+
+static void sample(fit_source & src, const double jdn, double *values)
+{
+    if (src.prop)
+    {
+        dvector position;
+        vector velocity;
+        src.prop->update(jdn, position, velocity);
+
+        values[0] = position.get_x();
+        values[1] = position.get_y();
+        values[2] = position.get_z();
+    }
+    else
+    {
+        transform orientation;
+        vector angular_velocity;
+        src.rotator->calc_orientation(jdn, orientation, angular_velocity);
+        src.rotator->get_last_angles(values[0], values[1], values[2]);
+    }
+} // sample()
+
+
+/// Interpolates each segment at the Chebyshev nodes, which is nearly as good as the best polynomial of that degree.
+static void fit(fit_source & src, const double start_jdn, const double end_jdn)
+{
+    const unsigned int n = src.num_coefficients;
+    src.num_segments = static_cast<unsigned int>(::ceil((end_jdn - start_jdn) / src.segment_days));
+
+    simple_array<double> samples, coefficients;
+    samples[NUM_COMPONENTS * n - 1] = 0;
+    coefficients[n - 1] = 0;
+
+    for (unsigned int segment = 0; segment < src.num_segments; ++segment)
+    {
+        double segment_start = start_jdn + segment * src.segment_days;
+
+        for (unsigned int k = 0; k < n; ++k)
+        {
+            double x = ephemeris_table::chebyshev_node(k, n);
+            double values[NUM_COMPONENTS];
+            sample(src, segment_start + 0.5 * (x + 1.0) * src.segment_days, values);
+
+            for (int c = 0; c < NUM_COMPONENTS; ++c)
+                samples[c*n + k] = values[c];
+        }
+
+        for (int c = 0; c < NUM_COMPONENTS; ++c)
+        {
+            ephemeris_table::chebyshev_fit(n, samples.ptr() + c*n, coefficients.ptr());
+
+            for (unsigned int j = 0; j < n; ++j)
+                src.coefficients.append(coefficients[j]);
+        }
+    }
+} // fit()
+
+
+static void find_sources(const config_record & rec, list<fit_source> & sources, const double position_days, const double orientation_days)
+{
+    for (list<config_record>::const_iterator i = rec.get_children().iter(); i.is_valid(); ++i)
+    {
+        const string & name = (*i)[L"name"];
+
+        if (!(*i)[L"propagator"].is_empty() || !(*i)[L"rotator"].is_empty())
+        {
+            if (name.is_empty() || name.size() >= static_cast<gsgl::index_t>(sizeof(ephemeris_series_record().name)))
+                throw runtime_exception(L"%ls: bodies in an ephemeris must have names shorter than 64 characters.", rec.get_file().get_full_path().w_string());
+        }
+
+        if (!(*i)[L"propagator"].is_empty())
+        {
+            fit_source src;
+            src.name = name;
+            src.kind = ephemeris_table::POSITION;
+            brokered_object *obj = broker::global_instance()->create_object((*i)[L"propagator"], *i);
+            src.prop = dynamic_cast<propagator *>(obj);
+            src.rotator = 0;
+            src.segment_days = position_days;
+            src.num_coefficients = POSITION_COEFFICIENTS;
+
+            if (!src.prop)
+            {
+                delete obj;
+                throw runtime_exception(L"Unable to create propagator %ls", (*i)[L"propagator"].w_string());
+            }
+
+            sources.append(src);
+        }
+
+        if (!(*i)[L"rotator"].is_empty())
+        {
+            fit_source src;
+            src.name = name;
+            src.kind = ephemeris_table::ORIENTATION;
+            src.prop = 0;
+            brokered_object *obj = broker::global_instance()->create_object((*i)[L"rotator"], *i);
+            src.rotator = dynamic_cast<body_rotator *>(obj);
+            src.segment_days = orientation_days;
+            src.num_coefficients = ORIENTATION_COEFFICIENTS;
+
+            if (!src.rotator)
+            {
+                delete obj;
+                throw runtime_exception(L"Unable to create rotator %ls", (*i)[L"rotator"].w_string());
+            }
+
+            sources.append(src);
+        }
+
+        find_sources(*i, sources, position_days, orientation_days);
+    }
+} // find_sources()
+
+
+static void free_sources(list<fit_source> & sources)
+{
+    for (list<fit_source>::iterator i = sources.iter(); i.is_valid(); ++i)
+    {
+        delete i->prop;
+        delete i->rotator;
+    }
+
+    sources.clear();
+} // free_sources()
+
+
+static void write_padding(fd_stream & f, unsigned int num)
+{
+    static const unsigned char zeros[8] = { 0 };
+
+    if (num && static_cast<unsigned int>(f.write(zeros, num)) != num)
+        throw io_exception(L"error writing padding");
+} // write_padding()
+
+
+static void write_table(const string & fname, list<fit_source> & sources, const double start_jdn, const double end_jdn)
+{
+    ephemeris_file_header header;
+    ::memset(&header, 0, sizeof(header));
+    ::strncpy(header.cookie, ephemeris_table::COOKIE, sizeof(header.cookie));
+    header.byte_order = ephemeris_table::FILE_BYTE_ORDER;
+    header.num_series = sources.size();
+    header.series_offset = sizeof(header);
+    header.start_jdn = start_jdn;
+    header.end_jdn = end_jdn;
+
+    // the coefficients start on an 8-byte boundary after the series records
+    unsigned int data_offset = (header.series_offset + header.num_series * sizeof(ephemeris_series_record) + 7) & ~7u;
+    unsigned int series_end = header.series_offset + header.num_series * sizeof(ephemeris_series_record);
+
+    fd_stream f(fname, FILE_OPEN_WRITE);
+
+    if (f.write(reinterpret_cast<const unsigned char *>(&header), sizeof(header)) != sizeof(header))
+        throw io_exception(L"error writing header to %ls", fname.w_string());
+
+    unsigned int offset = data_offset;
+    for (list<fit_source>::iterator i = sources.iter(); i.is_valid(); ++i)
+    {
+        ephemeris_series_record rec;
+        ::memset(&rec, 0, sizeof(rec));
+        ::strncpy(rec.name, i->name.c_string(), sizeof(rec.name) - 1);
+        rec.kind = i->kind;
+        rec.num_components = NUM_COMPONENTS;
+        rec.num_coefficients = i->num_coefficients;
+        rec.num_segments = i->num_segments;
+        rec.data_offset = offset;
+        rec.start_jdn = start_jdn;
+        rec.segment_days = i->segment_days;
+
+        if (f.write(reinterpret_cast<const unsigned char *>(&rec), sizeof(rec)) != sizeof(rec))
+            throw io_exception(L"error writing series records to %ls", fname.w_string());
+
+        offset += i->coefficients.size() * sizeof(double);
+    }
+
+    write_padding(f, data_offset - series_end);
+
+    for (list<fit_source>::iterator i = sources.iter(); i.is_valid(); ++i)
+    {
+        gsgl::index_t num_bytes = i->coefficients.size() * sizeof(double);
+
+        if (f.write(reinterpret_cast<const unsigned char *>(i->coefficients.ptr()), num_bytes) != num_bytes)
+            throw io_exception(L"error writing coefficients to %ls", fname.w_string());
+    }
+
+    ft_stream::out << "wrote " << static_cast<int>(header.num_series) << " series, " << static_cast<int>(offset) << " bytes\n";
+} // write_table()
+
+
+/// Compares the table with the models halfway between the fitted points, where the error is largest.
+static void check_table(const string & fname, list<fit_source> & sources)
+{
+    ephemeris_table table(fname);
+
+    for (list<fit_source>::iterator i = sources.iter(); i.is_valid(); ++i)
+    {
+        gsgl::index_t series_index = table.find_series(i->name, i->kind);
+        double max_error = 0;
+
+        if (series_index < 0)
+            throw io_exception(L"%ls is missing from %ls", i->name.w_string(), fname.w_string());
+
+        for (unsigned int segment = 0; segment < i->num_segments; ++segment)
+        {
+            for (unsigned int k = 0; k < i->num_coefficients; ++k)
+            {
+                double x = ::cos(PI * k / i->num_coefficients);
+                double jdn = table.get_start_jdn() + (segment + 0.5 * (x + 1.0)) * i->segment_days;
+                double expected[NUM_COMPONENTS], values[NUM_COMPONENTS], rates[NUM_COMPONENTS];
+
+                if (jdn > table.get_end_jdn())
+                    continue;
+
+                sample(*i, jdn, expected);
+                table.evaluate(series_index, jdn, values, rates);
+
+                for (int c = 0; c < NUM_COMPONENTS; ++c)
+                {
+                    double error = ::fabs(values[c] - expected[c]);
+                    if (error > max_error)
+                        max_error = error;
+                }
+            }
+        }
+
+        ft_stream::out << i->name << (i->kind == ephemeris_table::POSITION ? " position" : " orientation") << ": max error " << max_error 
+                       << (i->kind == ephemeris_table::POSITION ? " (parent units)\n" : " degrees\n");
+    }
+} // check_table()
+
+//
+
+int main(int argc, char **argv)
+{
+    if (argc < 5 || argc > 7)
+    {
+        ft_stream::out << "Usage: ephemgen scenery.scn start_jdn end_jdn output.eph [position_days [orientation_days]]\n";
+        return 1;
+    }
+
+    string scenery_fname(argv[1]);
+    double start_jdn = string(argv[2]).to_double();
+    double end_jdn = string(argv[3]).to_double();
+    string output_fname(argv[4]);
+    double position_days = argc > 5 ? string(argv[5]).to_double() : DEFAULT_POSITION_DAYS;
+    double orientation_days = argc > 6 ? string(argv[6]).to_double() : DEFAULT_ORIENTATION_DAYS;
+
+    if (end_jdn <= start_jdn || position_days <= 0 || orientation_days <= 0)
+    {
+        ft_stream::out << "The date range and segment lengths must be positive.\n";
+        return 1;
+    }
+
+    list<fit_source> sources;
+
+    try
+    {
+        config_record scenery(scenery_fname);
+        find_sources(scenery, sources, position_days, orientation_days);
+
+        for (list<fit_source>::iterator i = sources.iter(); i.is_valid(); ++i)
+        {
+            ft_stream::out << "fitting " << i->name << "\n";
+            fit(*i, start_jdn, end_jdn);
+        }
+
+        write_table(output_fname, sources, start_jdn, end_jdn);
+        check_table(output_fname, sources);
+    }
+    catch (exception & e)
+    {
+        ft_stream::out << "Error: " << e.get_message() << "\n";
+        free_sources(sources);
+        return 1;
+    }
+
+    free_sources(sources);
+    return 0;
+} // main()
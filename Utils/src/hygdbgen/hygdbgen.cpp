@@ -35,6 +35,11 @@
 #include "data/string.hpp"
 #include "data/fstream.hpp"
 #include "data/dictionary.hpp"
+#include "data/array.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <cfloat>
 
 using namespace gsgl;
 using namespace gsgl::data;
@@ -211,50 +216,165 @@ static void load_star_database(const string & fname, data::list<star_rec> & db,
 
 //
 
-static const string star_db_cookie = L"Periapsis Stellar Database 2.0";
+// The binary catalog layout; this must match stellar_db::load_db() in Periapsis/src/space/stellardb.cpp.
+// All values are in the byte order of the machine that generated the file.
 
-static void write_star_database(const string & fname, const list<star_rec> & star_db, dictionary<string, int> & star_names)
+static const char STAR_DB_COOKIE[] = "Periapsis Stellar Database 3.0";
+static const unsigned int STAR_DB_BYTE_ORDER = 0x01020304;
+static const unsigned int STAR_DB_PAGE_SIZE = 4096;
+
+struct star_db_header
 {
-    fd_stream f(fname, FILE_OPEN_WRITE);
+    char cookie[32];
+    unsigned int byte_order;
+
+    unsigned int num_stars;
+    unsigned int vertex_offset;  ///< Page-aligned offset of the vertex data.
+    unsigned int vertex_stride;  ///< Bytes per vertex.
 
-    // write file cookie
-    f << star_db_cookie;
+    unsigned int num_names;
+    unsigned int names_offset;   ///< Offset of the name records.
+    unsigned int names_size;     ///< Size of all the name records, in bytes.
 
-    // write number of star records
-    int num = star_db.size();
-    f << num;
+    float nearest_distance, farthest_distance;
+}; // struct star_db_header
+
+/// One vertex in GL_C4UB_V3F layout, ready to be uploaded as-is.
+struct star_db_vertex
+{
+    unsigned char color[4];      ///< The alpha channel holds the star's relative brightness.
+    float position[3];           ///< Galactic coordinates, in parsecs.
+}; // struct star_db_vertex
+
+// Name records follow the vertices: the vertex index and the name's length (both unsigned ints), 
+// then the name in 8-bit characters with a terminating 0, padded out to a multiple of 4 bytes.
+
+
+/// The orientation of the equatorial frame wrt. the galactic, from the Hipparcos data paper (the same as EQUATORIAL_WRT_GALACTIC in Periapsis/src/space/astronomy.cpp).
+static const double EQUATORIAL_WRT_GALACTIC[3][3] =
+{
+    { -0.0548755604, -0.8734370902, -0.4838350155 },
+    {  0.4941094279, -0.4448296300,  0.7469822445 },
+    { -0.8676661490, -0.1980763734,  0.4559837762 }
+};
+
+static const double DEG2RAD = 3.14159265358979323846 / 180.0;
+
+
+static void write_padding(fd_stream & f, unsigned int num)
+{
+    static const unsigned char zeros[STAR_DB_PAGE_SIZE] = { 0 };
+
+    if (num && static_cast<unsigned int>(f.write(zeros, num)) != num)
+        throw io_exception(L"error writing padding");
+} // write_padding()
+
+
+static void write_star_database(const string & fname, const list<star_rec> & star_db, dictionary<string, int> & star_names)
+{
+    // build vertices
+    simple_array<star_db_vertex> vertices(star_db.size());
+    dictionary<unsigned int, int> index_of_id;
+
+    float nearest_distance = FLT_MAX, farthest_distance = 0.0f;
+    float min_magnitude = 0.0f, max_magnitude = 0.0f;
 
-    // write star records
     for (list<star_rec>::const_iterator i = star_db.iter(); i.is_valid(); ++i)
     {
-        f << i->hyg_id;
-        f << i->right_ascension;
-        f << i->declination;
-        f << i->distance;
-        f << i->abs_magnitude;
-
-        f << i->color[0];
-        f << i->color[1];
-        f << i->color[2];
-        f << i->color[3];
+        double theta = i->right_ascension * (360.0 / 24.0) * DEG2RAD;
+        double phi = i->declination * DEG2RAD;
+
+        double eq[3] = 
+        {
+            i->distance * ::cos(theta) * ::cos(phi),
+            i->distance * ::sin(theta) * ::cos(phi),
+            i->distance * ::sin(phi)
+        };
+
+        star_db_vertex v;
+        for (int j = 0; j < 3; ++j)
+            v.position[j] = static_cast<float>(EQUATORIAL_WRT_GALACTIC[j][0]*eq[0] + EQUATORIAL_WRT_GALACTIC[j][1]*eq[1] + EQUATORIAL_WRT_GALACTIC[j][2]*eq[2]);
+
+        v.color[0] = i->color[0];
+        v.color[1] = i->color[1];
+        v.color[2] = i->color[2];
+        v.color[3] = 255;
+
+        index_of_id[i->hyg_id] = vertices.size();
+        vertices.append(v);
+
+        if (i->distance < nearest_distance)
+            nearest_distance = i->distance;
+        if (i->distance > farthest_distance)
+            farthest_distance = i->distance;
+
+        if (i->abs_magnitude < min_magnitude)
+            min_magnitude = i->abs_magnitude;
+        if (i->abs_magnitude > max_magnitude)
+            max_magnitude = i->abs_magnitude;
     }
 
-    ft_stream::out << "wrote " << num << " stars, ";
+    // store relative brightness in the alpha channel
+    {
+        int index = 0;
+        for (list<star_rec>::const_iterator i = star_db.iter(); i.is_valid(); ++i, ++index)
+        {
+            float mag_diff = gsgl::min_val(gsgl::max_val(i->abs_magnitude - min_magnitude, 0.0f), 5.0f);
+            float mag_pct = 1.0f - (mag_diff / 5.0f);
+
+            vertices[index].color[3] = static_cast<unsigned char>(mag_pct * 255.0f);
+        }
+    }
 
-    // write number of star names
-    num = star_names.size();
-    f << num;
+    // build name records
+    simple_array<unsigned char> names;
+    int num_names = 0;
 
     for (dictionary<string, int>::iterator i = star_names.iter(); i.is_valid(); ++i)
     {
-        f << i.get_index();
-        f << *i;
+        if (!index_of_id.contains_index(i.get_index()))
+            continue;
+
+        const char *name = i->c_string();
+        unsigned int header[2] = { index_of_id[i.get_index()], static_cast<unsigned int>(::strlen(name)) };
+        unsigned int padded_len = (header[1] + 1 + 3) & ~3u;
+
+        const unsigned char *header_ptr = reinterpret_cast<const unsigned char *>(header);
+        for (unsigned int j = 0; j < sizeof(header); ++j)
+            names.append(header_ptr[j]);
+        for (unsigned int j = 0; j < padded_len; ++j)
+            names.append(j < header[1] ? static_cast<unsigned char>(name[j]) : 0);
 
-        //f << i->second;
-        //f << i->first;
+        ++num_names;
     }
 
-    ft_stream::out << num << " names\n";
+    // write file
+    star_db_header header;
+    ::memset(&header, 0, sizeof(header));
+    ::strncpy(header.cookie, STAR_DB_COOKIE, sizeof(header.cookie));
+    header.byte_order = STAR_DB_BYTE_ORDER;
+    header.num_stars = vertices.size();
+    header.vertex_offset = STAR_DB_PAGE_SIZE;
+    header.vertex_stride = sizeof(star_db_vertex);
+    header.num_names = num_names;
+    header.names_offset = header.vertex_offset + header.num_stars * header.vertex_stride;
+    header.names_size = names.size();
+    header.nearest_distance = nearest_distance;
+    header.farthest_distance = farthest_distance;
+
+    fd_stream f(fname, FILE_OPEN_WRITE);
+
+    if (f.write(reinterpret_cast<const unsigned char *>(&header), sizeof(header)) != sizeof(header))
+        throw io_exception(L"error writing header to %ls", fname.w_string());
+    write_padding(f, header.vertex_offset - sizeof(header));
+
+    if (vertices.size() && f.write(reinterpret_cast<const unsigned char *>(vertices.ptr()), vertices.size() * sizeof(star_db_vertex)) != static_cast<gsgl::index_t>(vertices.size() * sizeof(star_db_vertex)))
+        throw io_exception(L"error writing star records to %ls", fname.w_string());
+
+    if (names.size() && f.write(names.ptr(), names.size()) != names.size())
+        throw io_exception(L"error writing star names to %ls", fname.w_string());
+
+    ft_stream::out << "wrote " << static_cast<int>(header.num_stars) << " stars, " << num_names << " names\n";
 } // write_star_database()
 
 //
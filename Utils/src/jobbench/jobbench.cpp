@@ -0,0 +1,208 @@
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "data/string.hpp"
+#include "data/fstream.hpp"
+#include "platform/job_scheduler.hpp"
+
+#include <cmath>
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+using namespace gsgl;
+using namespace gsgl::io;
+using namespace gsgl::platform;
+
+// Measures how the job scheduler scales with the number of worker threads.
+
+static double get_seconds()
+{
+#ifdef WIN32
+    LARGE_INTEGER count, freq;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    return static_cast<double>(count.QuadPart) / static_cast<double>(freq.QuadPart);
+#else
+    struct timeval tv;
+    ::gettimeofday(&tv, 0);
+    return tv.tv_sec + tv.tv_usec * 1.0e-6;
+#endif
+} // get_seconds()
+
+//
+
+/// Solves Kepler's equation for a range of mean anomalies; a stand-in for propagator work.
+struct kepler_body
+{
+    double *results;
+    int num_iterations;
+
+    void operator() (gsgl::index_t begin, gsgl::index_t end) const
+    {
+        for (gsgl::index_t i = begin; i < end; ++i)
+        {
+            double mean_anomaly = i * 0.001;
+            double ecc = 0.3;
+            double ea = mean_anomaly;
+
+            for (int j = 0; j < num_iterations; ++j)
+                ea = ea - (ea - ecc * ::sin(ea) - mean_anomaly) / (1.0 - ecc * ::cos(ea));
+
+            results[i] = ea;
+        }
+    }
+}; // struct kepler_body
+
+
+/// Almost no work, to measure the cost of scheduling itself.
+struct tiny_job
+    : public job
+{
+    double value;
+
+    virtual void execute() { value = ::sqrt(value); }
+}; // struct tiny_job
+
+//
+
+static const gsgl::index_t NUM_ELEMENTS = 1 << 20;
+static const int NUM_TINY_JOBS = 1 << 16;
+static const int NUM_REPEATS = 5;
+
+
+static double time_parallel_for(job_scheduler & scheduler, double *results)
+{
+    kepler_body body;
+    body.results = results;
+    body.num_iterations = 8;
+
+    double best = 1.0e30;
+
+    for (int i = 0; i < NUM_REPEATS; ++i)
+    {
+        double start = get_seconds();
+        parallel_for(scheduler, 0, NUM_ELEMENTS, body);
+        double elapsed = get_seconds() - start;
+
+        if (elapsed < best)
+            best = elapsed;
+    }
+
+    return best;
+} // time_parallel_for()
+
+
+static double time_tiny_jobs(job_scheduler & scheduler, tiny_job *jobs)
+{
+    double best = 1.0e30;
+
+    for (int i = 0; i < NUM_REPEATS; ++i)
+    {
+        double start = get_seconds();
+        {
+            job_group group(scheduler);
+
+            for (int j = 0; j < NUM_TINY_JOBS; ++j)
+            {
+                jobs[j].value = j;
+                group.run(&jobs[j]);
+            }
+
+            group.wait();
+        }
+        double elapsed = get_seconds() - start;
+
+        if (elapsed < best)
+            best = elapsed;
+    }
+
+    return best;
+} // time_tiny_jobs()
+
+
+int main(int argc, char **argv)
+{
+    int max_workers = thread::get_num_processors();
+
+    if (argc == 2)
+        max_workers = string(argv[1]).to_int();
+
+    if (argc > 2 || max_workers < 1)
+    {
+        ft_stream::out << "Usage: jobbench [max_workers]\n";
+        return 1;
+    }
+
+    try
+    {
+        data::smart_pointer<double, true> results(new double[NUM_ELEMENTS]);
+        data::smart_pointer<tiny_job, true> jobs(new tiny_job[NUM_TINY_JOBS]);
+
+        double base_time = 0;
+
+        ft_stream::out << "workers\tparallel_for (ms)\tspeedup\tus per tiny job\n";
+
+        // 1, 2, 4, ... workers, finishing with max_workers
+        int num_workers = 1;
+
+        while (num_workers <= max_workers)
+        {
+            job_scheduler scheduler(num_workers);
+
+            double pf_time = time_parallel_for(scheduler, results);
+            double tiny_time = time_tiny_jobs(scheduler, jobs);
+
+            if (num_workers == 1)
+                base_time = pf_time;
+
+            ft_stream::out << num_workers << "\t" << pf_time * 1000.0 << "\t" << base_time / pf_time << "\t" << tiny_time * 1.0e6 / NUM_TINY_JOBS << "\n";
+
+            if (num_workers == max_workers)
+                break;
+
+            num_workers = gsgl::min_val(num_workers * 2, max_workers);
+        }
+    }
+    catch (exception & e)
+    {
+        ft_stream::out << "Error: " << e.get_message() << "\n";
+        return 1;
+    }
+
+    return 0;
+} // main()
@@ -0,0 +1,173 @@
+//
+// $Id$
+//
+// Copyright (c) 2008, The Periapsis Project. All rights reserved. 
+// 
+// Redistribution and use in source and binary forms, with or without 
+// modification, are permitted provided that the following conditions are 
+// met: 
+// 
+// * Redistributions of source code must retain the above copyright notice, 
+//   this list of conditions and the following disclaimer. 
+// 
+// * Redistributions in binary form must reproduce the above copyright 
+//   notice, this list of conditions and the following disclaimer in the 
+//   documentation and/or other materials provided with the distribution. 
+// 
+// * Neither the name of the The Periapsis Project nor the names of its 
+//   contributors may be used to endorse or promote products derived from 
+//   this software without specific prior written permission. 
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS 
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED 
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A 
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER 
+// OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING 
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS 
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "data/string.hpp"
+#include "data/fstream.hpp"
+#include "data/array.hpp"
+#include "data/config.hpp"
+#include "platform/job_scheduler.hpp"
+#include "space/keplerian_element_propagator.hpp"
+#include "space/keplerian_element_batch.hpp"
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+using namespace gsgl;
+using namespace gsgl::io;
+using namespace gsgl::math;
+using namespace gsgl::platform;
+using namespace periapsis::space;
+
+// Compares propagating Keplerian orbits one at a time with evaluating them together in a keplerian_element_batch.
+
+static double get_seconds()
+{
+#ifdef WIN32
+    LARGE_INTEGER count, freq;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    return static_cast<double>(count.QuadPart) / static_cast<double>(freq.QuadPart);
+#else
+    struct timeval tv;
+    ::gettimeofday(&tv, 0);
+    return tv.tv_sec + tv.tv_usec * 1.0e-6;
+#endif
+} // get_seconds()
+
+//
+
+/// Makes an orbit somewhere in the main belt, with eccentricities up to 0.9.
+static keplerian_element_propagator *make_orbit(gsgl::index_t i)
+{
+    double f = static_cast<double>((i * 7919) % 10007) / 10007.0;
+
+    data::config_record obj_config;
+    obj_config[L"keplerian_elements"] = string::format(L"%f %f %f %f %f %f", 2.0 + f, 0.9 * f, 30.0 * f, 360.0 * f, 180.0 * f, 90.0 * f);
+    obj_config[L"keplerian_rates"] = string::format(L"%f %f %f %f %f %f", 0.0, 0.0, 0.0, 12000.0 + 24000.0 * f, 0.1, -0.1);
+
+    return new keplerian_element_propagator(obj_config);
+} // make_orbit()
+
+//
+
+static const int NUM_SIZES = 3;
+static const gsgl::index_t SIZES[NUM_SIZES] = { 10, 10000, 1000000 };
+
+static const gsgl::index_t ORBIT_STEPS = 4000000; ///< The number of orbit-evaluations to time at each size.
+static const double START_JDN = 2451545.0;
+static const double STEP_DAYS = 1.0;
+
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        ft_stream::out << "Usage: keplerbench\n";
+        return 1;
+    }
+
+    try
+    {
+        job_scheduler scheduler;
+
+        ft_stream::out << "orbits\tseparate (orbits/ms)\tbatch (orbits/ms)\tparallel batch (orbits/ms)\n";
+
+        for (int s = 0; s < NUM_SIZES; ++s)
+        {
+            gsgl::index_t num_orbits = SIZES[s];
+            gsgl::index_t num_steps = ORBIT_STEPS / num_orbits;
+
+            data::simple_array<keplerian_element_propagator *> orbits;
+            keplerian_element_batch batch;
+
+            for (gsgl::index_t i = 0; i < num_orbits; ++i)
+            {
+                keplerian_element_propagator *orbit = make_orbit(i);
+                orbits.append(orbit);
+                batch.add(orbit);
+            }
+
+            // each orbit through its own propagator
+            dvector position;
+            vector velocity;
+
+            double start = get_seconds();
+            for (gsgl::index_t step = 0; step < num_steps; ++step)
+            {
+                for (gsgl::index_t i = 0; i < num_orbits; ++i)
+                    orbits[i]->update(START_JDN + step * STEP_DAYS, position, velocity);
+            }
+            double separate = get_seconds() - start;
+
+            // all the orbits at once
+            data::simple_array<double> results;
+            results[6 * num_orbits - 1] = 0;
+
+            double *r = results.ptr();
+            keplerian_element_range range = { &batch, START_JDN, r, r + num_orbits, r + 2*num_orbits, r + 3*num_orbits, r + 4*num_orbits, r + 5*num_orbits };
+
+            start = get_seconds();
+            for (gsgl::index_t step = 0; step < num_steps; ++step)
+            {
+                range.jdn = START_JDN + step * STEP_DAYS;
+                range(0, num_orbits);
+            }
+            double batch_time = get_seconds() - start;
+
+            start = get_seconds();
+            for (gsgl::index_t step = 0; step < num_steps; ++step)
+            {
+                range.jdn = START_JDN + step * STEP_DAYS;
+                parallel_for(scheduler, 0, num_orbits, range);
+            }
+            double parallel_time = get_seconds() - start;
+
+            double total = static_cast<double>(num_orbits) * num_steps;
+            ft_stream::out << num_orbits << "\t" << total / (separate * 1000.0) << "\t" << total / (batch_time * 1000.0) << "\t" << total / (parallel_time * 1000.0) << "\n";
+
+            for (gsgl::index_t i = 0; i < num_orbits; ++i)
+                delete orbits[i];
+        }
+    }
+    catch (exception & e)
+    {
+        ft_stream::out << "Error: " << e.get_message() << "\n";
+        return 1;
+    }
+
+    return 0;
+} // main()